@@ -0,0 +1,78 @@
+// ============================================================================
+// TIMESTAMP CLOCK BENCHMARK
+// ============================================================================
+// Cost and resolution of each FastClock source against the standard clocks.
+// For each clock: mean ns per call over a tight loop, the smallest non-zero
+// step between consecutive reads (resolution), and how far it is from
+// CLOCK_REALTIME at the end of the run. The Tsc source is what the publisher
+// stamps messages with and what shm_consumer measures latency with.
+//
+// Usage: clock_bench [calls]   (default 10000000)
+
+#include "common/fast_clock.hpp"
+#include <fmt/core.h>
+#include <chrono>
+#include <cstdlib>
+
+namespace {
+
+int64_t steady_now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+template<typename Clock>
+void bench_clock(const char* name, Clock&& read, size_t calls, bool wall_clock) {
+    int64_t previous = read();
+    int64_t resolution = INT64_MAX;
+    const int64_t start = steady_now_ns();
+    for (size_t i = 0; i < calls; ++i) {
+        const int64_t now = read();
+        if (now > previous && now - previous < resolution) {
+            resolution = now - previous;
+        }
+        previous = now;
+    }
+    const int64_t elapsed = steady_now_ns() - start;
+
+    const double per_call = static_cast<double>(elapsed) / static_cast<double>(calls);
+    if (resolution == INT64_MAX) {
+        fmt::print("  {:<14} {:>10.2f} {:>14} ", name, per_call, "-");
+    } else {
+        fmt::print("  {:<14} {:>10.2f} {:>14} ", name, per_call, resolution);
+    }
+    if (wall_clock) {
+        fmt::print("{:>14.3f}\n", static_cast<double>(read() - hft::realtime_ns()) / 1000.0);
+    } else {
+        fmt::print("{:>14}\n", "-");
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t calls = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+
+    hft::FastClock cached(hft::ClockSource::Cached);
+    hft::FastClock tsc(hft::ClockSource::Tsc);
+    hft::FastClock system(hft::ClockSource::System);
+
+    fmt::print("===========================================\n");
+    fmt::print("   Timestamp Clock Benchmark\n");
+    fmt::print("===========================================\n");
+    fmt::print("Calls: {} | Invariant TSC: {} | TSC source: {}", calls,
+              hft::tsc_is_invariant() ? "yes" : "no", hft::clock_source_name(tsc.source()));
+    if (tsc.source() == hft::ClockSource::Tsc) {
+        fmt::print(" ({:.6f} GHz)", tsc.tsc_frequency_hz() / 1e9);
+    }
+    fmt::print("\n\n");
+
+    fmt::print("  {:<14} {:>10} {:>14} {:>14}\n", "clock", "ns/call", "resolution ns", "vs wall us");
+    bench_clock("fast cached", [&]() { return cached.now(); }, calls, true);
+    bench_clock("fast tsc", [&]() { return tsc.now(); }, calls, true);
+    bench_clock("fast system", [&]() { return system.now(); }, calls, true);
+    bench_clock("steady_clock", []() { return steady_now_ns(); }, calls, false);
+    bench_clock("raw counter", []() { return static_cast<int64_t>(hft::read_tsc()); }, calls, false);
+
+    return 0;
+}
@@ -0,0 +1,370 @@
+// ============================================================================
+// RING BUFFER MICROBENCHMARKS
+// ============================================================================
+// Cross-thread throughput of the SPSC ring on the same MarketData payload the
+// publisher -> shm_consumer path carries. Producer and consumer run on their
+// own threads (pinned to separate cores when more than one is available), so
+// index and slot cache lines really travel between cores as they do between
+// the two processes. The last sections run the broadcast ring the publisher
+// uses, comparing copy-in/copy-out against in-place claim/peek, and commit
+// with and without a doorbell while every reader spins.
+// Where the CPU exposes hardware counters, each run also reports the
+// producer's and consumer's cycles, instructions, cache and branch misses per
+// message (including the time spent spinning on a full or empty ring).
+//
+// Usage: ring_buffer_bench [messages]   (default 10,000,000)
+
+#include "common/market_data.hpp"
+#include "common/ring_buffer.hpp"
+#include "common/broadcast_ring.hpp"
+#include "common/performance_utils.hpp"
+#include <fmt/core.h>
+#include <fmt/format.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using BenchRing = hft::SpscRingBuffer<hft::MarketData, 4096>;
+using BenchBroadcastRing = hft::BroadcastRing<hft::MarketData, 4096>;
+
+// ----------------------------------------------------------------------------
+// Reference ring without cached indices
+// ----------------------------------------------------------------------------
+// Same layout and algorithm as SpscRingBuffer before the producer/consumer
+// kept private copies of the opposite index: every try_write loads read_idx
+// and every try_read loads write_idx. Kept here as the "before" side of the
+// cached-index comparison.
+template<typename T, size_t Capacity>
+class alignas(64) UncachedSpscRing {
+    static constexpr size_t MASK = Capacity - 1;
+    alignas(64) std::atomic<size_t> write_idx{0};
+    alignas(64) std::atomic<size_t> read_idx{0};
+    alignas(64) T buffer[Capacity];
+
+public:
+    bool try_write(const T& data) noexcept {
+        const size_t current_write = write_idx.load(std::memory_order_relaxed);
+        const size_t next_write = (current_write + 1) & MASK;
+        if (next_write == read_idx.load(std::memory_order_acquire)) {
+            return false;
+        }
+        buffer[current_write] = data;
+        write_idx.store(next_write, std::memory_order_release);
+        return true;
+    }
+    
+    bool try_read(T& data) noexcept {
+        const size_t current_read = read_idx.load(std::memory_order_relaxed);
+        if (current_read == write_idx.load(std::memory_order_acquire)) {
+            return false;
+        }
+        data = buffer[current_read];
+        read_idx.store((current_read + 1) & MASK, std::memory_order_release);
+        return true;
+    }
+};
+
+using UncachedBenchRing = UncachedSpscRing<hft::MarketData, 4096>;
+
+struct BenchResult {
+    double seconds;
+    size_t messages;
+    uint64_t checksum;
+    hft::PerfStats producer_perf;
+    hft::PerfStats consumer_perf;
+};
+
+// Pin the calling thread when the machine has a core to spare for it
+void pin_to(int cpu_id) {
+    if (hft::CpuAffinity::get_cpu_count() > cpu_id) {
+        hft::CpuAffinity::set_thread_affinity(cpu_id);
+    }
+}
+
+// Spinning on a full/empty ring only makes progress if the other side runs
+// on another core; on a single-core machine hand the CPU over instead
+void spin_pause() {
+    static const bool single_core = hft::CpuAffinity::get_cpu_count() < 2;
+    if (single_core) {
+        std::this_thread::yield();
+    }
+}
+
+// Run producer and consumer bodies on two threads and time the transfer
+template<typename Producer, typename Consumer>
+BenchResult run_pair(size_t messages, Producer&& producer, Consumer&& consumer) {
+    std::atomic<bool> start{false};
+    uint64_t checksum = 0;
+    hft::PerfStats producer_perf;
+    hft::PerfStats consumer_perf;
+    
+    // Counters are per thread, so each side opens its own and counts its
+    // whole run as one region of 'messages' messages
+    std::thread consumer_thread([&]() {
+        pin_to(1);
+        hft::PerfCounters counters;
+        while (!start.load(std::memory_order_acquire)) { spin_pause(); }
+        const hft::PerfReading perf_start = counters.read();
+        checksum = consumer(messages);
+        if (counters.available()) {
+            consumer_perf.add(counters.read() - perf_start, messages);
+        }
+    });
+    
+    pin_to(0);
+    hft::PerfCounters counters;
+    auto begin = std::chrono::steady_clock::now();
+    start.store(true, std::memory_order_release);
+    const hft::PerfReading perf_start = counters.read();
+    producer(messages);
+    if (counters.available()) {
+        producer_perf.add(counters.read() - perf_start, messages);
+    }
+    consumer_thread.join();
+    auto end = std::chrono::steady_clock::now();
+    
+    return BenchResult{std::chrono::duration<double>(end - begin).count(), messages, checksum,
+                       producer_perf, consumer_perf};
+}
+
+// Hardware counters per message, when the CPU exposes them
+void report_perf(const char* side, const hft::PerfStats& perf) {
+    if (perf.regions() == 0) {
+        return;
+    }
+    fmt::print("    {:<8} per msg: {:7.1f} cycles | {:7.1f} instructions (IPC {:.2f}) | {:5.2f} L1d misses | {:5.3f} LLC misses | {:5.3f} branch misses | {:.2f} user cycles/ns\n",
+              side, perf.per_region(hft::PerfEvent::Cycles), perf.per_region(hft::PerfEvent::Instructions),
+              perf.ipc(), perf.per_region(hft::PerfEvent::L1dMisses), perf.per_region(hft::PerfEvent::LlcMisses),
+              perf.per_region(hft::PerfEvent::BranchMisses), perf.user_cycles_per_ns());
+}
+
+void report(const char* name, const BenchResult& result, double baseline_seconds) {
+    double mps = result.messages / result.seconds / 1e6;
+    double ns_per_msg = result.seconds * 1e9 / result.messages;
+    fmt::print("  {:<34} {:8.2f} M msg/s  {:7.2f} ns/msg  speedup x{:.2f}\n",
+              name, mps, ns_per_msg, baseline_seconds / result.seconds);
+    report_perf("producer", result.producer_perf);
+    report_perf("consumer", result.consumer_perf);
+}
+
+hft::MarketData make_message(size_t i) {
+    return hft::MarketData("BENCH", 100.0 + static_cast<double>(i & 1023), 100.5, static_cast<int64_t>(i));
+}
+
+// ----------------------------------------------------------------------------
+// Single-message path: one index publish per message on each side
+// ----------------------------------------------------------------------------
+template<typename Ring>
+BenchResult bench_single(Ring& ring, size_t messages) {
+    return run_pair(messages,
+        [&](size_t n) {
+            for (size_t i = 0; i < n; ++i) {
+                hft::MarketData msg = make_message(i);
+                while (!ring.try_write(msg)) { spin_pause(); }
+            }
+        },
+        [&](size_t n) {
+            uint64_t sum = 0;
+            hft::MarketData msg;
+            for (size_t received = 0; received < n;) {
+                if (ring.try_read(msg)) {
+                    sum += static_cast<uint64_t>(msg.timestamp_ns);
+                    ++received;
+                } else {
+                    spin_pause();
+                }
+            }
+            return sum;
+        });
+}
+
+// ----------------------------------------------------------------------------
+// Batched path: try_write_n on the producer, consume_all on the consumer
+// ----------------------------------------------------------------------------
+BenchResult bench_batched(BenchRing& ring, size_t messages, size_t batch) {
+    return run_pair(messages,
+        [&](size_t n) {
+            std::vector<hft::MarketData> staging(batch);
+            for (size_t i = 0; i < n;) {
+                size_t count = std::min(batch, n - i);
+                for (size_t j = 0; j < count; ++j) {
+                    staging[j] = make_message(i + j);
+                }
+                size_t sent = 0;
+                while (sent < count) {
+                    size_t written = ring.try_write_n(staging.data() + sent, count - sent);
+                    if (written == 0) {
+                        spin_pause();
+                    }
+                    sent += written;
+                }
+                i += count;
+            }
+        },
+        [&](size_t n) {
+            uint64_t sum = 0;
+            for (size_t received = 0; received < n;) {
+                size_t drained = ring.consume_all([&](const hft::MarketData& msg) {
+                    sum += static_cast<uint64_t>(msg.timestamp_ns);
+                });
+                if (drained == 0) {
+                    spin_pause();
+                }
+                received += drained;
+            }
+            return sum;
+        });
+}
+
+// ----------------------------------------------------------------------------
+// Broadcast ring, copying path: build on the stack, try_publish copies it in,
+// try_read copies it out (two 64-byte copies per message)
+// ----------------------------------------------------------------------------
+BenchResult bench_broadcast_copy(BenchBroadcastRing& ring, size_t messages) {
+    // Register before the writer starts so the reader gates it from message 0
+    BenchBroadcastRing::Reader reader(ring);
+    return run_pair(messages,
+        [&](size_t n) {
+            for (size_t i = 0; i < n; ++i) {
+                hft::MarketData msg = make_message(i);
+                while (!ring.try_publish(msg)) { spin_pause(); }
+            }
+        },
+        [&](size_t n) {
+            uint64_t sum = 0;
+            hft::MarketData msg;
+            for (size_t received = 0; received < n;) {
+                if (reader.try_read(msg)) {
+                    sum += static_cast<uint64_t>(msg.timestamp_ns);
+                    ++received;
+                } else {
+                    spin_pause();
+                }
+            }
+            return sum;
+        });
+}
+
+// ----------------------------------------------------------------------------
+// Broadcast ring, zero-copy path: construct in the claimed slot, read the
+// fields through peek() (no intermediate copies)
+// ----------------------------------------------------------------------------
+BenchResult bench_broadcast_in_place(BenchBroadcastRing& ring, size_t messages) {
+    BenchBroadcastRing::Reader reader(ring);
+    return run_pair(messages,
+        [&](size_t n) {
+            for (size_t i = 0; i < n; ++i) {
+                hft::MarketData* slot;
+                while ((slot = ring.claim()) == nullptr) { spin_pause(); }
+                new(slot) hft::MarketData("BENCH", 100.0 + static_cast<double>(i & 1023), 100.5,
+                                          static_cast<int64_t>(i));
+                ring.commit();
+            }
+        },
+        [&](size_t n) {
+            uint64_t sum = 0;
+            for (size_t received = 0; received < n;) {
+                const hft::MarketData* msg = reader.peek();
+                if (msg == nullptr) {
+                    spin_pause();
+                    continue;
+                }
+                const int64_t timestamp = msg->timestamp_ns;
+                if (reader.release()) {
+                    sum += static_cast<uint64_t>(timestamp);
+                    ++received;
+                }
+            }
+            return sum;
+        });
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t messages = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+    
+    fmt::print("===========================================\n");
+    fmt::print("   Ring Buffer Microbenchmarks\n");
+    fmt::print("===========================================\n");
+    fmt::print("Messages per run: {} | Ring slots: {} | CPU cores: {}\n",
+              messages, BenchRing::buffer_size(), hft::CpuAffinity::get_cpu_count());
+    {
+        const hft::PerfCounters probe;
+        fmt::print("Hardware counters: {}\n\n", probe.available() ? "on" : "unavailable (" + probe.status() + ")");
+    }
+    
+    auto ring = std::make_unique<BenchRing>();
+    auto uncached_ring = std::make_unique<UncachedBenchRing>();
+    
+    // ========================================================================
+    // Cached vs uncached opposite index (single-message path)
+    // ========================================================================
+    fmt::print("Opposite-index caching, try_write / try_read:\n");
+    BenchResult uncached = bench_single(*uncached_ring, messages);
+    report("before: load other index per msg", uncached, uncached.seconds);
+    BenchResult cached = bench_single(*ring, messages);
+    report("after: cached other index", cached, uncached.seconds);
+    if (cached.checksum != uncached.checksum) {
+        fmt::print("ERROR: cached-index checksum mismatch\n");
+        return 1;
+    }
+    fmt::print("\n");
+    
+    // ========================================================================
+    // Single-message vs batched transfer
+    // ========================================================================
+    fmt::print("Single-message vs batched SPSC transfer:\n");
+    BenchResult single = bench_single(*ring, messages);
+    report("try_write / try_read", single, single.seconds);
+    
+    for (size_t batch : {8, 64, 512}) {
+        BenchResult batched = bench_batched(*ring, messages, batch);
+        if (batched.checksum != single.checksum) {
+            fmt::print("ERROR: batched checksum mismatch\n");
+            return 1;
+        }
+        report(fmt::format("try_write_n({}) / consume_all", batch).c_str(), batched, single.seconds);
+    }
+    fmt::print("\n");
+    
+    // ========================================================================
+    // Copying vs zero-copy broadcast (publisher -> shm_consumer path)
+    // ========================================================================
+    fmt::print("Broadcast ring, copy vs in place ({}-byte messages):\n", sizeof(hft::MarketData));
+    auto broadcast_ring = std::make_unique<BenchBroadcastRing>();
+    BenchResult copied = bench_broadcast_copy(*broadcast_ring, messages);
+    report("try_publish / try_read (2 copies)", copied, copied.seconds);
+    BenchResult in_place = bench_broadcast_in_place(*broadcast_ring, messages);
+    report("claim+commit / peek+release", in_place, copied.seconds);
+    if (in_place.checksum != copied.checksum) {
+        fmt::print("ERROR: zero-copy checksum mismatch\n");
+        return 1;
+    }
+    fmt::print("\n");
+    
+    // ========================================================================
+    // Doorbell cost on the writer (`publisher doorbell`), nobody asleep
+    // ========================================================================
+    // The reader only spins, so this is the price spinning setups pay for
+    // the fence and sleeper check in every commit
+    fmt::print("Broadcast ring commit, without vs with doorbell (no reader asleep):\n");
+    auto doorbell_ring = std::make_unique<BenchBroadcastRing>(hft::OverflowPolicy::Gate, true);
+    BenchResult plain_commit = bench_broadcast_in_place(*broadcast_ring, messages);
+    report("commit", plain_commit, plain_commit.seconds);
+    BenchResult doorbell_commit = bench_broadcast_in_place(*doorbell_ring, messages);
+    report("commit + doorbell ring()", doorbell_commit, plain_commit.seconds);
+    if (doorbell_commit.checksum != plain_commit.checksum) {
+        fmt::print("ERROR: doorbell checksum mismatch\n");
+        return 1;
+    }
+    
+    return 0;
+}
@@ -0,0 +1,153 @@
+// ============================================================================
+// SHARED MEMORY PAGE SIZE BENCHMARK
+// ============================================================================
+// Consumer-side cost of the TLB misses a large shared memory segment takes
+// with normal 4K pages, against the same segment backed by huge pages
+// (ShmOptions::huge_pages). Two access patterns, each run on segments created
+// the way the publisher creates its channel segments:
+//   - drain: a reader consumes a full broadcast ring (65536 ticks, 8MB) in
+//     place, as shm_consumer does after a burst; one new page every 64 ticks
+//   - lookup: random reads from a latest-value table of MarketData entries
+//     (64MB by default); nearly every read lands on a different 4K page
+// Pages are touched before timing, so page faults are not part of the result.
+// Huge pages must be reserved for the second run to differ, e.g.
+//   echo 64 > /proc/sys/vm/nr_hugepages
+// The backing each run actually got is printed next to its numbers.
+//
+// Usage: shm_page_bench [table_entries] [rounds]   (default 1048576, 20)
+
+#include "common/market_data.hpp"
+#include "common/broadcast_ring.hpp"
+#include "common/shared_memory.hpp"
+#include <fmt/core.h>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <vector>
+
+namespace {
+
+int64_t steady_now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Touch every page of the segment once so timing excludes first-touch faults
+void pretouch(void* addr, size_t bytes) {
+    volatile char* p = static_cast<volatile char*>(addr);
+    for (size_t offset = 0; offset < bytes; offset += 4096) {
+        p[offset] = p[offset];
+    }
+}
+
+// Publish a full ring, then time one reader draining it in place
+double bench_drain(const hft::ShmOptions& options, hft::ShmBacking& backing, size_t rounds) {
+    constexpr hft::RingGeometry geometry = hft::ShmBroadcastRing::expected_geometry();
+    hft::SharedMemoryManager shm = hft::SharedMemoryManager::create_segment(
+        "hft_page_bench_ring",
+        hft::ShmLayout{geometry.element_size, geometry.slot_count, geometry.total_bytes}, options);
+    backing = shm.backing();
+    pretouch(shm.get_address(), shm.get_size());
+
+    auto* ring = new(shm.payload()) hft::ShmBroadcastRing(hft::OverflowPolicy::Overwrite);
+    hft::ShmBroadcastRing::Reader reader(*ring);
+
+    int64_t total_ns = 0;
+    size_t total_messages = 0;
+    double checksum = 0.0;
+    uint64_t sequence = 0;
+    for (size_t round = 0; round < rounds; ++round) {
+        for (size_t i = 0; i < ring->capacity(); ++i) {
+            hft::MarketData* slot = ring->claim();
+            new(slot) hft::MarketData("PAGE", 100.0, 100.5, 0, sequence++);
+            ring->commit();
+        }
+
+        const int64_t start = steady_now_ns();
+        const hft::MarketData* msg;
+        while ((msg = reader.peek()) != nullptr) {
+            checksum += msg->bid;
+            reader.release();
+            ++total_messages;
+        }
+        total_ns += steady_now_ns() - start;
+    }
+
+    if (checksum < 0.0) {
+        fmt::print("(checksum {})\n", checksum);
+    }
+    return static_cast<double>(total_ns) / static_cast<double>(total_messages);
+}
+
+// Random reads from a latest-value table in its own segment
+double bench_lookup(const hft::ShmOptions& options, hft::ShmBacking& backing,
+                    size_t entries, size_t rounds) {
+    hft::SharedMemoryManager shm = hft::SharedMemoryManager::create_segment(
+        "hft_page_bench_table",
+        hft::ShmLayout{sizeof(hft::MarketData), entries, entries * sizeof(hft::MarketData)}, options);
+    backing = shm.backing();
+    pretouch(shm.get_address(), shm.get_size());
+
+    auto* table = static_cast<hft::MarketData*>(shm.payload());
+    for (size_t i = 0; i < entries; ++i) {
+        new(&table[i]) hft::MarketData("PAGE", static_cast<double>(i), static_cast<double>(i) + 0.5, 0, i);
+    }
+
+    // Indices drawn up front so the timed loop is only the lookups
+    std::mt19937_64 gen(42);
+    std::uniform_int_distribution<size_t> pick(0, entries - 1);
+    std::vector<size_t> indices(1 << 20);
+    for (size_t& index : indices) {
+        index = pick(gen);
+    }
+
+    double checksum = 0.0;
+    const int64_t start = steady_now_ns();
+    for (size_t round = 0; round < rounds; ++round) {
+        for (size_t index : indices) {
+            checksum += table[index].bid;
+        }
+    }
+    const int64_t elapsed = steady_now_ns() - start;
+
+    if (checksum < 0.0) {
+        fmt::print("(checksum {})\n", checksum);
+    }
+    return static_cast<double>(elapsed) / static_cast<double>(rounds * indices.size());
+}
+
+void run(const char* label, bool huge_pages, size_t entries, size_t rounds) {
+    hft::ShmOptions options;
+    options.huge_pages = huge_pages;
+
+    hft::ShmBacking drain_backing{};
+    hft::ShmBacking lookup_backing{};
+    const double drain_ns = bench_drain(options, drain_backing, rounds);
+    const double lookup_ns = bench_lookup(options, lookup_backing, entries, rounds);
+
+    fmt::print("  {:<10} {:>10.2f} ns/msg ({:<12}) {:>10.2f} ns/read ({})\n", label,
+              drain_ns, hft::shm_backing_name(drain_backing),
+              lookup_ns, hft::shm_backing_name(lookup_backing));
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t entries = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : (1 << 20);
+    size_t rounds = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 20;
+
+    fmt::print("===========================================\n");
+    fmt::print("   Shared Memory Page Size Benchmark\n");
+    fmt::print("===========================================\n");
+    fmt::print("Ring: {} slots ({} MB) | Table: {} entries ({} MB) | Rounds: {}\n\n",
+              hft::ShmBroadcastRing::expected_geometry().slot_count,
+              sizeof(hft::ShmBroadcastRing) >> 20,
+              entries, (entries * sizeof(hft::MarketData)) >> 20, rounds);
+
+    fmt::print("  {:<10} {:>31} {:>30}\n", "requested", "ring drain", "table lookup");
+    run("normal", false, entries, rounds);
+    run("huge", true, entries, rounds);
+
+    return 0;
+}
@@ -0,0 +1,143 @@
+// ============================================================================
+// CONSUMER WAIT STRATEGY BENCHMARK
+// ============================================================================
+// Wake-up latency and idle CPU cost of each wait strategy in
+// wait_strategy.hpp. A producer thread publishes timestamped messages into a
+// broadcast ring at a fixed interval (a sparse feed, so the consumer spends
+// most of its time idle); the consumer polls the ring with the strategy under
+// test and records publish-to-receive latency. Consumer CPU usage is its
+// thread CPU time over wall time. The blocking strategy runs twice: parking
+// on a timer, and parking on the ring's doorbell.
+//
+// Usage: wait_strategy_bench [messages] [interval_us]   (default 20000, 50)
+
+#include "common/market_data.hpp"
+#include "common/broadcast_ring.hpp"
+#include "common/wait_strategy.hpp"
+#include "common/performance_utils.hpp"
+#include <fmt/core.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <time.h>
+
+namespace {
+
+using BenchRing = hft::BroadcastRing<hft::MarketData, 4096>;
+
+struct WaitResult {
+    std::vector<int64_t> latencies_ns;
+    double cpu_percent;
+};
+
+int64_t steady_now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int64_t thread_cpu_ns() {
+    timespec ts{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+// Pin the calling thread when the machine has a core to spare for it
+void pin_to(int cpu_id) {
+    if (hft::CpuAffinity::get_cpu_count() > cpu_id) {
+        hft::CpuAffinity::set_thread_affinity(cpu_id);
+    }
+}
+
+template<typename WaitStrategy>
+WaitResult bench_wait(BenchRing& ring, WaitStrategy wait, size_t messages,
+                      std::chrono::microseconds interval) {
+    WaitResult result{{}, 0.0};
+    result.latencies_ns.reserve(messages);
+
+    // Register before the producer starts so no message is missed
+    BenchRing::Reader reader(ring);
+    std::atomic<bool> ready{false};
+
+    std::thread consumer([&]() {
+        pin_to(1);
+        ready.store(true, std::memory_order_release);
+        const int64_t wall_start = steady_now_ns();
+        const int64_t cpu_start = thread_cpu_ns();
+
+        while (result.latencies_ns.size() < messages) {
+            reader.poll([&](const hft::MarketData& msg) {
+                result.latencies_ns.push_back(steady_now_ns() - msg.timestamp_ns);
+            }, wait);
+        }
+
+        const int64_t cpu_used = thread_cpu_ns() - cpu_start;
+        const int64_t wall_used = steady_now_ns() - wall_start;
+        result.cpu_percent = 100.0 * static_cast<double>(cpu_used) / static_cast<double>(wall_used);
+    });
+
+    pin_to(0);
+    while (!ready.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
+    }
+
+    // Sparse feed: one message per interval
+    auto next = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < messages; ++i) {
+        next += interval;
+        std::this_thread::sleep_until(next);
+        hft::MarketData msg("WAIT", 100.0, 100.5, steady_now_ns());
+        while (!ring.try_publish(msg)) {
+            std::this_thread::yield();
+        }
+    }
+    consumer.join();
+
+    return result;
+}
+
+int64_t percentile(const std::vector<int64_t>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    size_t index = static_cast<size_t>(p / 100.0 * static_cast<double>(sorted.size() - 1));
+    return sorted[index];
+}
+
+void report(const char* name, WaitResult result) {
+    std::sort(result.latencies_ns.begin(), result.latencies_ns.end());
+    fmt::print("  {:<12} {:9.2f} {:9.2f} {:9.2f} {:9.2f}   {:6.1f}%\n", name,
+              percentile(result.latencies_ns, 50) / 1000.0,
+              percentile(result.latencies_ns, 99) / 1000.0,
+              percentile(result.latencies_ns, 99.9) / 1000.0,
+              result.latencies_ns.empty() ? 0.0 : result.latencies_ns.back() / 1000.0,
+              result.cpu_percent);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t messages = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 20000;
+    std::chrono::microseconds interval(argc > 2 ? std::strtoll(argv[2], nullptr, 10) : 50);
+
+    fmt::print("===========================================\n");
+    fmt::print("   Consumer Wait Strategy Benchmark\n");
+    fmt::print("===========================================\n");
+    fmt::print("Messages: {} | Interval: {}us | CPU cores: {}\n\n",
+              messages, interval.count(), hft::CpuAffinity::get_cpu_count());
+
+    auto ring = std::make_unique<BenchRing>();
+    auto doorbell_ring = std::make_unique<BenchRing>(hft::OverflowPolicy::Gate, true);
+
+    fmt::print("  {:<12} {:>9} {:>9} {:>9} {:>9}   {:>7}\n",
+              "strategy", "p50 us", "p99 us", "p99.9 us", "max us", "cpu");
+    report(hft::BusySpinWait::name(), bench_wait(*ring, hft::BusySpinWait{}, messages, interval));
+    report(hft::SpinYieldWait::name(), bench_wait(*ring, hft::SpinYieldWait{}, messages, interval));
+    report(hft::BlockingWait::name(), bench_wait(*ring, hft::BlockingWait{}, messages, interval));
+    report("doorbell", bench_wait(*doorbell_ring, hft::BlockingWait{}, messages, interval));
+
+    return 0;
+}
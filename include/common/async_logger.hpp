@@ -0,0 +1,380 @@
+#pragma once
+
+// ============================================================================
+// ASYNCHRONOUS LOGGER
+// ============================================================================
+// This header implements a logger that keeps formatting and I/O off the
+// latency-critical thread. A log call only copies its arguments, in binary,
+// into an SPSC queue owned by the calling thread, together with the address
+// of the format string (its ID) and of the function that formats them. A
+// background thread drains every queue, formats the records with fmt and
+// writes them out in one write per batch.
+//
+// The hot path is a few stores into memory the thread already owns: no
+// formatting, no syscall, no lock. When a queue is full the record is
+// dropped and counted, never waited for; the drop count is reported in the
+// output.
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <fmt/core.h>
+#include <fmt/format.h>
+#include "byte_ring.hpp"
+#include "latency_histogram.hpp"
+#include "wait_strategy.hpp"
+
+namespace hft {
+
+// ============================================================================
+// CONSTANTS
+// ============================================================================
+
+// Queue per logging thread: 1024 one-cache-line records (up to 32 bytes of
+// arguments each), fewer when records are longer
+constexpr size_t LOG_QUEUE_BYTES = 64 * 1024;
+
+// Threads one logger accepts records from
+constexpr size_t MAX_LOG_THREADS = 16;
+
+// How long the background thread sleeps when every queue is empty
+constexpr std::chrono::milliseconds LOG_IDLE_PARK{1};
+
+constexpr uint16_t LOG_FRAME_TYPE = 1;
+
+namespace log_detail {
+
+// ============================================================================
+// ARGUMENT ENCODING
+// ============================================================================
+// How one argument travels through the queue. Values are copied as they are;
+// strings are copied by value (length + bytes), so the caller may reuse its
+// buffer as soon as log() returns. Arguments are packed without alignment
+// and always accessed with memcpy.
+
+template<typename T>
+struct LogArg {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "Log arguments are copied in binary and must be trivially copyable (or strings)");
+    using Decoded = T;
+
+    static size_t size(const T&) noexcept { return sizeof(T); }
+
+    static std::byte* encode(std::byte* out, const T& value) noexcept {
+        std::memcpy(out, &value, sizeof(T));
+        return out + sizeof(T);
+    }
+
+    static Decoded decode(const std::byte*& in) noexcept {
+        T value;
+        std::memcpy(&value, in, sizeof(T));
+        in += sizeof(T);
+        return value;
+    }
+};
+
+struct StringArg {
+    using Decoded = std::string_view;
+
+    static size_t size(std::string_view value) noexcept {
+        return sizeof(uint32_t) + value.size();
+    }
+
+    static std::byte* encode(std::byte* out, std::string_view value) noexcept {
+        const uint32_t length = static_cast<uint32_t>(value.size());
+        std::memcpy(out, &length, sizeof(length));
+        std::memcpy(out + sizeof(length), value.data(), length);
+        return out + sizeof(length) + length;
+    }
+
+    // Points into the queue: valid until the record is released
+    static Decoded decode(const std::byte*& in) noexcept {
+        uint32_t length;
+        std::memcpy(&length, in, sizeof(length));
+        const char* data = reinterpret_cast<const char*>(in + sizeof(length));
+        in += sizeof(length) + length;
+        return std::string_view(data, length);
+    }
+};
+
+template<> struct LogArg<const char*> : StringArg {};
+template<> struct LogArg<char*> : StringArg {};
+template<> struct LogArg<std::string_view> : StringArg {};
+template<> struct LogArg<std::string> : StringArg {};
+
+// Formats one record's arguments; instantiated per argument type list
+using FormatFn = void (*)(fmt::memory_buffer& out, fmt::string_view format, const std::byte* args);
+
+// Written at the start of every record, followed by the encoded arguments
+struct RecordHeader {
+    FormatFn format;
+    const char* format_data;
+    size_t format_size;
+};
+
+template<typename... Args>
+void format_record(fmt::memory_buffer& out, fmt::string_view format, [[maybe_unused]] const std::byte* in) {
+    // Braced initialisation decodes the arguments left to right
+    const std::tuple<typename LogArg<Args>::Decoded...> values{LogArg<Args>::decode(in)...};
+    std::apply([&](const auto&... value) {
+        fmt::vformat_to(std::back_inserter(out), format, fmt::make_format_args(value...));
+    }, values);
+}
+
+} // namespace log_detail
+
+// ============================================================================
+// AsyncLogger
+// ============================================================================
+//
+// THREADS:
+//   - Each thread that logs gets its own queue (a ByteRing) on its first
+//     log() call, under a mutex; call attach() from a thread before its hot
+//     loop to take that cost up front. Later calls find the queue through a
+//     thread_local cache
+//   - The background thread is the single consumer of every queue
+//   - Records from one thread are written in order; records from different
+//     threads are interleaved per batch, not by time
+//
+// FORMAT STRINGS:
+//   - Only the address of the format string is queued, so it must outlive
+//     the logger: pass string literals
+//   - Format errors surface on the background thread, which writes a note
+//     in place of the record
+//
+class AsyncLogger {
+private:
+    struct ThreadQueue {
+        ByteRing<LOG_QUEUE_BYTES> ring;
+        std::thread::id owner;
+        RelaxedCounter pushed{0};       // Written by the owner thread only
+        RelaxedCounter dropped{0};      // Written by the owner thread only
+        uint64_t reported_drops{0};     // Background thread only
+    };
+
+    std::FILE* out_;
+    const uint64_t id_;                 // Tells loggers apart in thread_local caches
+
+    std::mutex attach_mutex_;
+    std::array<std::unique_ptr<ThreadQueue>, MAX_LOG_THREADS> queues_;
+    std::atomic<size_t> queue_count_{0};
+
+    // Records from threads beyond MAX_LOG_THREADS
+    std::atomic<uint64_t> unattached_drops_{0};
+    uint64_t reported_unattached_drops_{0};
+
+    std::atomic<uint64_t> written_{0};
+    std::atomic<bool> running_{true};
+    std::thread backend_;
+
+    static uint64_t next_id() noexcept {
+        static std::atomic<uint64_t> ids{0};
+        return ids.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    // Calling thread's queue, or nullptr if MAX_LOG_THREADS are attached
+    ThreadQueue* thread_queue() {
+        struct Cache {
+            uint64_t logger = 0;
+            ThreadQueue* queue = nullptr;
+        };
+        thread_local Cache cache;
+        if (cache.logger != id_) {
+            cache.queue = attach_queue();
+            cache.logger = cache.queue != nullptr ? id_ : 0;
+        }
+        return cache.queue;
+    }
+
+    ThreadQueue* attach_queue() {
+        std::lock_guard<std::mutex> lock(attach_mutex_);
+        const std::thread::id self = std::this_thread::get_id();
+        const size_t count = queue_count_.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < count; ++i) {
+            if (queues_[i]->owner == self) {
+                return queues_[i].get();
+            }
+        }
+        if (count == MAX_LOG_THREADS) {
+            return nullptr;
+        }
+        queues_[count] = std::make_unique<ThreadQueue>();
+        queues_[count]->owner = self;
+        queue_count_.store(count + 1, std::memory_order_release);
+        return queues_[count].get();
+    }
+
+    // Format and write everything queued; returns the records written
+    size_t drain(fmt::memory_buffer& buffer) {
+        size_t records = 0;
+        const size_t count = queue_count_.load(std::memory_order_acquire);
+        for (size_t i = 0; i < count; ++i) {
+            ThreadQueue& queue = *queues_[i];
+            records += queue.ring.consume_all([&](const Frame& frame) {
+                log_detail::RecordHeader header;
+                std::memcpy(&header, frame.data, sizeof(header));
+                const fmt::string_view format(header.format_data, header.format_size);
+                try {
+                    header.format(buffer, format, frame.data + sizeof(header));
+                } catch (const fmt::format_error& e) {
+                    fmt::format_to(std::back_inserter(buffer), "[async logger: cannot format '{}': {}]\n",
+                                   format, e.what());
+                }
+            });
+            const uint64_t dropped = queue.dropped;
+            if (dropped != queue.reported_drops) {
+                fmt::format_to(std::back_inserter(buffer), "[async logger: {} records dropped, queue full]\n",
+                               dropped - queue.reported_drops);
+                queue.reported_drops = dropped;
+            }
+        }
+        const uint64_t unattached = unattached_drops_.load(std::memory_order_relaxed);
+        if (unattached != reported_unattached_drops_) {
+            fmt::format_to(std::back_inserter(buffer), "[async logger: {} records dropped, too many threads]\n",
+                           unattached - reported_unattached_drops_);
+            reported_unattached_drops_ = unattached;
+        }
+
+        if (buffer.size() > 0) {
+            std::fwrite(buffer.data(), 1, buffer.size(), out_);
+            std::fflush(out_);
+            buffer.clear();
+        }
+        if (records > 0) {
+            written_.fetch_add(records, std::memory_order_release);
+        }
+        return records;
+    }
+
+    void run() {
+        fmt::memory_buffer buffer;
+        BlockingWait wait(0, 0, LOG_IDLE_PARK);
+        while (true) {
+            // Read before draining, so the last drain sees every record
+            // logged before stop()
+            const bool stopping = !running_.load(std::memory_order_acquire);
+            if (drain(buffer) > 0) {
+                wait.reset();
+            } else if (stopping) {
+                break;
+            } else {
+                wait.idle();
+            }
+        }
+    }
+
+public:
+    // ========================================================================
+    // CONSTRUCTOR / DESTRUCTOR
+    // ========================================================================
+    // Starts the background thread, writing to out (stdout by default)
+    explicit AsyncLogger(std::FILE* out = stdout)
+        : out_(out), id_(next_id()), backend_([this] { run(); }) {}
+
+    // Writes out everything still queued
+    ~AsyncLogger() {
+        stop();
+    }
+
+    AsyncLogger(const AsyncLogger&) = delete;
+    AsyncLogger& operator=(const AsyncLogger&) = delete;
+    AsyncLogger(AsyncLogger&&) = delete;
+    AsyncLogger& operator=(AsyncLogger&&) = delete;
+
+    // ========================================================================
+    // HOT PATH
+    // ========================================================================
+
+    // Queue a record for formatting with fmt on the background thread
+    // Returns false (and counts a drop) if the calling thread's queue is
+    // full, the record exceeds the largest frame, or too many threads log
+    template<typename... Args>
+    bool log(fmt::format_string<const Args&...> format, const Args&... args) {
+        ThreadQueue* queue = thread_queue();
+        if (queue == nullptr) {
+            unattached_drops_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        const size_t length = sizeof(log_detail::RecordHeader) +
+                              (size_t{0} + ... + log_detail::LogArg<std::decay_t<Args>>::size(args));
+        std::byte* out = length <= ByteRing<LOG_QUEUE_BYTES>::max_payload()
+                       ? queue->ring.claim(LOG_FRAME_TYPE, static_cast<uint32_t>(length))
+                       : nullptr;
+        if (out == nullptr) {
+            queue->dropped += 1;
+            return false;
+        }
+
+        const fmt::string_view format_view = format;
+        const log_detail::RecordHeader header{&log_detail::format_record<std::decay_t<Args>...>,
+                                              format_view.data(), format_view.size()};
+        std::memcpy(out, &header, sizeof(header));
+        out += sizeof(header);
+        ((out = log_detail::LogArg<std::decay_t<Args>>::encode(out, args)), ...);
+        queue->ring.commit();
+        queue->pushed += 1;
+        return true;
+    }
+
+    // ========================================================================
+    // CONTROL (off the hot path)
+    // ========================================================================
+
+    // Create the calling thread's queue now rather than on its first log()
+    // Returns false if MAX_LOG_THREADS threads are already attached
+    bool attach() {
+        return thread_queue() != nullptr;
+    }
+
+    // Block until every record queued so far is written, e.g. before
+    // printing directly to the same stream
+    void flush() {
+        uint64_t pushed = 0;
+        const size_t count = queue_count_.load(std::memory_order_acquire);
+        for (size_t i = 0; i < count; ++i) {
+            pushed += queues_[i]->pushed;
+        }
+        while (backend_.joinable() && written_.load(std::memory_order_acquire) < pushed) {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+
+    // Write out everything queued and stop the background thread; records
+    // logged afterwards stay queued
+    void stop() {
+        if (backend_.joinable()) {
+            running_.store(false, std::memory_order_release);
+            backend_.join();
+        }
+    }
+
+    // Records dropped so far, queue full or too many threads
+    [[nodiscard]] uint64_t dropped() const noexcept {
+        uint64_t total = unattached_drops_.load(std::memory_order_relaxed);
+        const size_t count = queue_count_.load(std::memory_order_acquire);
+        for (size_t i = 0; i < count; ++i) {
+            total += queues_[i]->dropped;
+        }
+        return total;
+    }
+
+    // Records written so far
+    [[nodiscard]] uint64_t written() const noexcept {
+        return written_.load(std::memory_order_acquire);
+    }
+};
+
+} // namespace hft
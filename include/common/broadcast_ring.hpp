@@ -0,0 +1,859 @@
+#pragma once
+
+// ============================================================================
+// BROADCAST RING (ONE WRITER, MANY INDEPENDENT READERS)
+// ============================================================================
+// This header implements a Disruptor-style broadcast ring: a single publisher
+// writes each message once and every registered reader sees every message.
+// Unlike the SPSC RingBuffer, readers do not share a read index, so a second
+// consumer attached to the same shared memory segment no longer steals
+// messages from the first.
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <cerrno>
+#include <signal.h>
+#include <unistd.h>
+#include "market_data.hpp"
+#include "ring_buffer.hpp"
+#include "doorbell.hpp"
+#include "wait_strategy.hpp"
+
+namespace hft {
+
+// ============================================================================
+// CONSTANTS
+// ============================================================================
+
+// Maximum number of readers that can be registered on one ring at a time
+// Each reader owns one 64-byte cursor line, so this is cheap to raise
+constexpr size_t BROADCAST_MAX_READERS = 16;
+
+// Longest a reader sleeps on the doorbell before re-checking its ring
+// Only a safety net: the writer wakes sleeping readers on every publish
+constexpr std::chrono::milliseconds BROADCAST_DOORBELL_TIMEOUT{100};
+
+// ============================================================================
+// ReaderStatus
+// ============================================================================
+// Snapshot of one registered reader, as seen by the publisher
+struct ReaderStatus {
+    size_t id;          // Reader slot index
+    uint64_t position;  // Next sequence the reader will consume
+    uint64_t lag;       // Messages published but not yet consumed
+    pid_t pid;          // Process that registered the reader
+};
+
+// ============================================================================
+// BroadcastRing Class Template
+// ============================================================================
+//
+// DESIGN PRINCIPLES:
+//   - Single writer, up to MaxReaders independent readers
+//   - Every message gets a monotonic 64-bit sequence number (0, 1, 2, ...)
+//   - Each slot records the sequence it currently holds (sequence + 1, so 0
+//     means "never written"); a reader at position p waits for its slot to
+//     hold p + 1 and never has to touch the writer's cursor line
+//   - Each reader owns a cursor (its next sequence) on its own cache line
+//
+// GATING:
+//   - The writer may not reuse a slot until every active reader has moved
+//     past it: sequence s is writable iff s < min(reader positions) + Capacity
+//   - Like the SPSC ring, the writer caches that limit and only rescans the
+//     reader cursors when it reaches it, once per lap in steady state
+//   - try_publish() returns false when the slowest reader is a full ring
+//     behind; slowest_reader() tells the publisher who that is
+//
+// LETTING SLOW READERS LAP:
+//   - Instead of dropping new messages for everybody, the publisher can
+//     evict_reader() the laggard. The writer stops gating on it, and the
+//     reader notices once it is lapped, skips to the live cursor and counts
+//     the messages it lost in lost_messages()
+//
+// OVERWRITE MODE (OverflowPolicy::Overwrite):
+//   - The writer never looks at reader cursors: every publish succeeds and
+//     the newest data always replaces the oldest, so a slow consumer can
+//     never back-pressure the feed
+//   - Readers detect being lapped from the slot sequences and report the
+//     gap in lost_messages(), exactly as an evicted reader does
+//
+// PER-SLOT SEQLOCK:
+//   - Before overwriting a slot the writer stores the new sequence with
+//     SLOT_WRITING set, then the data, then the plain new sequence
+//   - A reader copies the slot only if it holds the expected sequence, and
+//     re-reads the sequence after the copy; any change means the writer was
+//     overwriting the slot during the copy, so the copy is discarded as
+//     torn and the reader resynchronises instead of returning garbage
+//
+// ZERO-COPY ACCESS:
+//   - claim() returns the next slot (already marked SLOT_WRITING) so the
+//     publisher builds the message in shared memory; commit() publishes it.
+//     try_publish() is simply claim + copy + commit
+//   - Reader::peek() returns the next published slot so the message can be
+//     processed where it lies; Reader::release() moves past it
+//   - While a reader gates the writer the slot cannot change under it. When
+//     it can (overwrite mode, or after eviction) release() performs the
+//     seqlock re-check and returns false if the slot was overwritten, in
+//     which case whatever was derived from the peeked message must be
+//     discarded
+//
+// DOORBELL (optional, chosen at construction):
+//   - A futex-based Doorbell (doorbell.hpp) on its own cache line lets idle
+//     readers sleep in the kernel: Reader::park() waits on it, and commit()
+//     rings it after every publish
+//   - Ringing costs the writer a seq_cst fence and a load on every commit,
+//     whether or not a reader sleeps, plus a wake syscall while one does;
+//     readers that spin never touch the doorbell line. Without a doorbell,
+//     park() is a timed sleep
+//
+// SPLIT CURSOR TABLE (optional):
+//   - Reader cursors and the doorbell are the only parts of the ring readers
+//     write. They live in a BroadcastCursorTable, which is embedded in the
+//     ring by default but can be placed in a segment of its own
+//   - The publisher then drives the ring through a Writer handle bound to the
+//     external table, and readers attach with Reader(ring, table). Readers
+//     can map the data segment read-only: they cannot corrupt market data,
+//     and their cursor stores never touch the pages the writer streams into
+//
+// ATTACH / DETACH:
+//   - A slot's pid is its owner: readers claim a free slot (pid 0) by CASing
+//     in their own pid, and only then move it to RESERVED and ACTIVE. They
+//     start at the live cursor, and free the slot in their destructor (state
+//     first, then pid); the publisher keeps running
+//   - Slots left behind by a crashed reader, in whatever state it got to
+//     (RESERVED included), are reclaimed by the next attach once the owning
+//     pid no longer exists, by CASing that dead pid to its own
+//
+// LIVENESS:
+//   - A reader bumps the heartbeat counter on its cursor line whenever it
+//     finds nothing to read and before it parks; consuming advances its
+//     position instead. A reader whose position and heartbeat both stand
+//     still is stuck, whether or not it is behind yet (see watchdog.hpp)
+//   - The writer's sign of life is the segment header heartbeat
+//
+// WRITER RESTART:
+//   - Everything the writer needs lives in the ring, so a restarted
+//     publisher can take over a ring it left in shared memory with
+//     recover() instead of constructing a new one. Readers keep their
+//     cursors and carry on from the next sequence
+//
+// MEMORY ORDERING:
+//   - Slot data is published by a release store of the slot sequence and
+//     read after an acquire load of it
+//   - Reader positions are published with release stores and read with
+//     acquire loads by the writer during a gating rescan
+//   - Attach and gating rescans pair seq_cst fences (Dekker style): either
+//     the writer's rescan sees the new reader, or the new reader sees every
+//     sequence the writer could publish without seeing it, and starts there
+//
+
+// ============================================================================
+// BroadcastCursorTable
+// ============================================================================
+// The reader-writable part of a broadcast ring: one cursor line per reader
+// and the doorbell they sleep on. Trivially constructible in place in shared
+// memory, like the ring itself.
+template<size_t MaxReaders = BROADCAST_MAX_READERS>
+struct alignas(64) BroadcastCursorTable {
+    // Reader cursor slot states
+    enum : uint32_t {
+        READER_FREE = 0,      // Unused (pid 0 once the last owner is gone)
+        READER_RESERVED = 1,  // Being set up by an attaching reader (pid set)
+        READER_ACTIVE = 2,    // Registered, gates the writer
+        READER_EVICTED = 3    // Lapped by the writer, no longer gates it
+    };
+
+    // One reader's cursor, alone on its cache line
+    struct alignas(64) ReaderCursor {
+        std::atomic<uint32_t> state{READER_FREE};
+        std::atomic<int32_t> pid{0};
+        std::atomic<uint64_t> position{0};
+        std::atomic<uint64_t> heartbeat{0};  // Bumped by the reader on every empty poll
+    };
+
+    // Layout description, first member like every ring in this codebase
+    alignas(64) RingGeometry geometry{sizeof(ReaderCursor), MaxReaders, sizeof(BroadcastCursorTable)};
+
+    // Wake-up signal for sleeping readers (own line)
+    Doorbell doorbell;
+
+    // Reader cursors
+    ReaderCursor readers[MaxReaders];
+
+    // Minimum position over active readers, or next_sequence if there are none
+    uint64_t scan_min_position(uint64_t next_sequence) const noexcept {
+        // Pairs with the fence in Reader::activate(): a reader we do not see here has
+        // not yet read the cursor, and will start at or after next_sequence
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        uint64_t min_position = next_sequence;
+        for (size_t i = 0; i < MaxReaders; ++i) {
+            if (readers[i].state.load(std::memory_order_acquire) == READER_ACTIVE) {
+                const uint64_t position = readers[i].position.load(std::memory_order_acquire);
+                if (position < min_position) {
+                    min_position = position;
+                }
+            }
+        }
+        return min_position;
+    }
+
+    // Number of readers currently gating the writer
+    [[nodiscard]] size_t active_readers() const noexcept {
+        size_t count = 0;
+        for (size_t i = 0; i < MaxReaders; ++i) {
+            if (readers[i].state.load(std::memory_order_acquire) == READER_ACTIVE) {
+                ++count;
+            }
+        }
+        return count;
+    }
+
+    [[nodiscard]] static constexpr RingGeometry expected_geometry() noexcept {
+        return RingGeometry{sizeof(ReaderCursor), MaxReaders, sizeof(BroadcastCursorTable)};
+    }
+
+    [[nodiscard]] static bool geometry_matches(const RingGeometry& recorded) noexcept {
+        return recorded == expected_geometry();
+    }
+};
+
+// ============================================================================
+// OverflowPolicy
+// ============================================================================
+// What the writer does when the slowest reader is a full ring behind
+enum class OverflowPolicy : uint32_t {
+    Gate = 0,      // try_publish() fails until the slowest reader catches up
+    Overwrite = 1  // Publishing always succeeds; lagging readers are lapped
+};
+
+template<typename T, size_t Capacity, size_t MaxReaders = BROADCAST_MAX_READERS>
+class alignas(64) BroadcastRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                  "BroadcastRing capacity must be a power of 2");
+    static_assert(MaxReaders >= 1, "BroadcastRing needs room for at least one reader");
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "BroadcastRing elements are copied across processes and must be trivially copyable");
+
+public:
+    using CursorTable = BroadcastCursorTable<MaxReaders>;
+
+private:
+    static constexpr size_t MASK = Capacity - 1;
+
+    // Set in a slot sequence while the writer is overwriting that slot
+    static constexpr uint64_t SLOT_WRITING = uint64_t{1} << 63;
+
+    using ReaderCursor = typename CursorTable::ReaderCursor;
+    static constexpr uint32_t READER_FREE = CursorTable::READER_FREE;
+    static constexpr uint32_t READER_RESERVED = CursorTable::READER_RESERVED;
+    static constexpr uint32_t READER_ACTIVE = CursorTable::READER_ACTIVE;
+    static constexpr uint32_t READER_EVICTED = CursorTable::READER_EVICTED;
+
+    // One message slot: the sequence it holds plus the message itself
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> sequence{0};
+        T value;
+    };
+
+    // Layout description, first member like every ring in this codebase
+    alignas(64) RingGeometry geometry{sizeof(T), Capacity, sizeof(BroadcastRing)};
+
+    // Writer line: published cursor plus writer-private gating state
+    alignas(64) std::atomic<uint64_t> cursor{0};  // Number of messages published
+    uint64_t gate_limit{Capacity};                // First sequence that needs a rescan
+    OverflowPolicy policy{OverflowPolicy::Gate};  // Fixed at construction
+    bool use_doorbell{false};                     // Fixed at construction
+    bool external_cursors{false};                 // Set once a Writer binds a separate table
+
+    // Embedded reader cursors and doorbell (unused when external_cursors)
+    CursorTable cursors;
+
+    // Message slots
+    Slot slots[Capacity];
+
+    // ------------------------------------------------------------------------
+    // Writer operations against a given cursor table (embedded or external)
+    // ------------------------------------------------------------------------
+
+    T* claim_in(CursorTable& table) noexcept {
+        const uint64_t sequence = cursor.load(std::memory_order_relaxed);
+
+        // Only rescan reader cursors when the cached limit is reached
+        if (sequence >= gate_limit && policy == OverflowPolicy::Gate) {
+            gate_limit = table.scan_min_position(sequence) + Capacity;
+            if (sequence >= gate_limit) {
+                return nullptr; // Slowest reader has not freed this slot yet
+            }
+        }
+
+        Slot& slot = slots[sequence & MASK];
+
+        // Seqlock: mark the slot as being overwritten before touching data
+        slot.sequence.store((sequence + 1) | SLOT_WRITING, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        return &slot.value;
+    }
+
+    void commit_in(CursorTable& table) noexcept {
+        const uint64_t sequence = cursor.load(std::memory_order_relaxed);
+        Slot& slot = slots[sequence & MASK];
+
+        // Release: readers that see sequence + 1 also see the data written
+        slot.sequence.store(sequence + 1, std::memory_order_release);
+        cursor.store(sequence + 1, std::memory_order_release);
+
+        if (use_doorbell) {
+            table.doorbell.ring();
+        }
+    }
+
+    bool try_publish_in(CursorTable& table, const T& data) noexcept {
+        T* slot = claim_in(table);
+        if (slot == nullptr) {
+            return false;
+        }
+        *slot = data;
+        commit_in(table);
+        return true;
+    }
+
+    std::optional<ReaderStatus> reader_status_in(const CursorTable& table, size_t id) const noexcept {
+        if (id >= MaxReaders ||
+            table.readers[id].state.load(std::memory_order_acquire) != READER_ACTIVE) {
+            return std::nullopt;
+        }
+        const uint64_t published = cursor.load(std::memory_order_acquire);
+        const uint64_t position = table.readers[id].position.load(std::memory_order_acquire);
+        return ReaderStatus{id, position, published > position ? published - position : 0,
+                            static_cast<pid_t>(table.readers[id].pid.load(std::memory_order_relaxed))};
+    }
+
+    std::optional<ReaderStatus> slowest_reader_in(const CursorTable& table) const noexcept {
+        std::optional<ReaderStatus> slowest;
+        for (size_t i = 0; i < MaxReaders; ++i) {
+            std::optional<ReaderStatus> status = reader_status_in(table, i);
+            if (status && (!slowest || status->lag > slowest->lag)) {
+                slowest = status;
+            }
+        }
+        return slowest;
+    }
+
+    bool evict_reader_in(CursorTable& table, size_t id) noexcept {
+        if (id >= MaxReaders) {
+            return false;
+        }
+        uint32_t expected = READER_ACTIVE;
+        if (!table.readers[id].state.compare_exchange_strong(expected, READER_EVICTED,
+                                                             std::memory_order_seq_cst)) {
+            return false;
+        }
+        gate_limit = table.scan_min_position(cursor.load(std::memory_order_relaxed)) + Capacity;
+        return true;
+    }
+
+    uint64_t recover_in(CursorTable& table) noexcept {
+        for (size_t i = 0; i < MaxReaders; ++i) {
+            uint32_t expected = READER_ACTIVE;
+            if (!pid_alive(table.readers[i].pid.load(std::memory_order_relaxed))) {
+                table.readers[i].state.compare_exchange_strong(expected, READER_EVICTED,
+                                                               std::memory_order_seq_cst);
+            }
+        }
+        const uint64_t sequence = cursor.load(std::memory_order_relaxed);
+        gate_limit = sequence; // Rescan the remaining readers on the next claim
+        return sequence;
+    }
+
+    static bool pid_alive(int32_t pid) noexcept {
+        return pid <= 0 || kill(pid, 0) == 0 || errno != ESRCH;
+    }
+
+public:
+    using value_type = T;
+
+    // ========================================================================
+    // CONSTRUCTOR
+    // ========================================================================
+    explicit BroadcastRing(OverflowPolicy overflow_policy = OverflowPolicy::Gate,
+                           bool enable_doorbell = false) noexcept
+        : policy(overflow_policy), use_doorbell(enable_doorbell) {}
+
+    // ========================================================================
+    // COPY/MOVE SEMANTICS
+    // ========================================================================
+    // BroadcastRing is not copyable or movable due to atomic members
+    BroadcastRing(const BroadcastRing&) = delete;
+    BroadcastRing& operator=(const BroadcastRing&) = delete;
+    BroadcastRing(BroadcastRing&&) = delete;
+    BroadcastRing& operator=(BroadcastRing&&) = delete;
+
+    // ========================================================================
+    // WRITER INTERFACE (Single Writer)
+    // ========================================================================
+
+    // Try to publish a message to every reader
+    // Gate: returns false if the slowest active reader is a full ring behind
+    // Overwrite: always succeeds, lagging readers are lapped
+    [[nodiscard]] bool try_publish(const T& data) noexcept {
+        return try_publish_in(cursors, data);
+    }
+
+    // Claim the next slot so the message can be constructed in place
+    // Returns nullptr under the same conditions as try_publish(); otherwise
+    // the slot belongs to the writer until commit() publishes it
+    [[nodiscard]] T* claim() noexcept {
+        return claim_in(cursors);
+    }
+
+    // Publish the slot returned by the last successful claim()
+    void commit() noexcept {
+        commit_in(cursors);
+    }
+
+    // Status of the reader furthest behind, if any reader is active
+    [[nodiscard]] std::optional<ReaderStatus> slowest_reader() const noexcept {
+        return slowest_reader_in(cursors);
+    }
+
+    // Status of reader id, or nothing if that slot has no active reader
+    [[nodiscard]] std::optional<ReaderStatus> reader_status(size_t id) const noexcept {
+        return reader_status_in(cursors, id);
+    }
+
+    // Number of readers currently gating the writer
+    [[nodiscard]] size_t active_readers() const noexcept {
+        return cursors.active_readers();
+    }
+
+    // Stop gating on reader id and let the writer lap it
+    // The reader detects the eviction on its next read and resynchronises
+    // Returns false if the reader was not active
+    bool evict_reader(size_t id) noexcept {
+        return evict_reader_in(cursors, id);
+    }
+
+    // Take over the ring from a writer that exited or crashed (warm restart)
+    // Evicts readers whose process died meanwhile and drops cached gating
+    // state; a slot the old writer claimed but never committed is simply
+    // claimed again by the next publish. Policy and doorbell stay as the ring
+    // was constructed. Returns the next sequence number (= published())
+    uint64_t recover() noexcept {
+        return recover_in(cursors);
+    }
+
+    // Address of the slot the next publish will write (for prefetching)
+    [[nodiscard]] const void* next_slot_address() const noexcept {
+        return &slots[cursor.load(std::memory_order_relaxed) & MASK];
+    }
+
+    // ========================================================================
+    // UTILITY FUNCTIONS
+    // ========================================================================
+
+    [[nodiscard]] OverflowPolicy overflow_policy() const noexcept {
+        return policy;
+    }
+
+    [[nodiscard]] bool doorbell_enabled() const noexcept {
+        return use_doorbell;
+    }
+
+    // Readers currently asleep on the doorbell
+    [[nodiscard]] uint32_t sleeping_readers() const noexcept {
+        return cursors.doorbell.sleeping();
+    }
+
+    // True once a Writer has bound an external cursor table
+    [[nodiscard]] bool has_external_cursors() const noexcept {
+        return external_cursors;
+    }
+
+    // Number of messages published so far (= next sequence number)
+    [[nodiscard]] uint64_t published() const noexcept {
+        return cursor.load(std::memory_order_acquire);
+    }
+
+    // Maximum lag a gating reader can build up
+    [[nodiscard]] static constexpr size_t capacity() noexcept {
+        return Capacity;
+    }
+
+    [[nodiscard]] static constexpr size_t max_readers() noexcept {
+        return MaxReaders;
+    }
+
+    [[nodiscard]] static constexpr RingGeometry expected_geometry() noexcept {
+        return RingGeometry{sizeof(T), Capacity, sizeof(BroadcastRing)};
+    }
+
+    [[nodiscard]] static bool geometry_matches(const RingGeometry& recorded) noexcept {
+        return recorded == expected_geometry();
+    }
+
+    [[nodiscard]] const RingGeometry& get_geometry() const noexcept {
+        return geometry;
+    }
+
+    // ========================================================================
+    // WRITER HANDLE (split cursor table)
+    // ========================================================================
+    //
+    // Writer interface of a ring whose cursor table lives outside it (e.g. in
+    // a separate writable segment). Binding a Writer marks the ring, so a
+    // reader that tries to register in the unused embedded table is refused.
+    //
+    class Writer {
+    private:
+        BroadcastRing* ring_;
+        CursorTable* table_;
+
+    public:
+        Writer(BroadcastRing& ring, CursorTable& table) noexcept
+            : ring_(&ring), table_(&table) {
+            ring.external_cursors = true;
+        }
+
+        // Same semantics as the BroadcastRing members of the same name
+        [[nodiscard]] bool try_publish(const T& data) noexcept {
+            return ring_->try_publish_in(*table_, data);
+        }
+
+        [[nodiscard]] T* claim() noexcept {
+            return ring_->claim_in(*table_);
+        }
+
+        void commit() noexcept {
+            ring_->commit_in(*table_);
+        }
+
+        [[nodiscard]] std::optional<ReaderStatus> slowest_reader() const noexcept {
+            return ring_->slowest_reader_in(*table_);
+        }
+
+        [[nodiscard]] std::optional<ReaderStatus> reader_status(size_t id) const noexcept {
+            return ring_->reader_status_in(*table_, id);
+        }
+
+        [[nodiscard]] size_t active_readers() const noexcept {
+            return table_->active_readers();
+        }
+
+        bool evict_reader(size_t id) noexcept {
+            return ring_->evict_reader_in(*table_, id);
+        }
+
+        uint64_t recover() noexcept {
+            return ring_->recover_in(*table_);
+        }
+
+        [[nodiscard]] uint32_t sleeping_readers() const noexcept {
+            return table_->doorbell.sleeping();
+        }
+
+        // Data-side queries (published(), capacity(), ...) go to the ring
+        [[nodiscard]] BroadcastRing& ring() const noexcept {
+            return *ring_;
+        }
+    };
+
+    // ========================================================================
+    // READER HANDLE
+    // ========================================================================
+    //
+    // RAII registration of one reader. Owns a cursor slot for its lifetime;
+    // all reads go through it. A Reader must only be used by one thread.
+    //
+    class Reader {
+    private:
+        const BroadcastRing* ring_;
+        CursorTable* table_;
+        size_t id_;
+        uint64_t position_;   // Private copy of our published cursor
+        uint64_t lost_;       // Messages skipped after being lapped
+        uint64_t laps_;       // Times we were lapped
+        uint64_t beats_;      // Private copy of our heartbeat counter
+
+        ReaderCursor& cursor_slot() const noexcept {
+            return table_->readers[id_];
+        }
+
+        // Show the watchdog we are alive while there is nothing to consume
+        void beat() noexcept {
+            cursor_slot().heartbeat.store(++beats_, std::memory_order_relaxed);
+        }
+
+        // Claim a free cursor slot in table_ and start at the live cursor
+        void attach() {
+            const int32_t self_pid = static_cast<int32_t>(getpid());
+            for (size_t i = 0; i < MaxReaders && id_ == MaxReaders; ++i) {
+                ReaderCursor& slot = table_->readers[i];
+                int32_t owner = slot.pid.load(std::memory_order_acquire);
+                const uint32_t state = slot.state.load(std::memory_order_acquire);
+
+                // Free slots, or slots whose owner died without detaching,
+                // even half way through attaching (left RESERVED)
+                const bool reclaimable = owner == 0 ? state == READER_FREE : !pid_alive(owner);
+
+                // Taking the pid makes the slot ours: a slot whose pid we did
+                // not see change cannot have been claimed by anyone else
+                if (reclaimable && slot.pid.compare_exchange_strong(owner, self_pid,
+                                                                    std::memory_order_acq_rel)) {
+                    slot.state.store(READER_RESERVED, std::memory_order_release);
+                    beats_ = slot.heartbeat.load(std::memory_order_relaxed);
+                    id_ = i;
+                }
+            }
+            if (id_ == MaxReaders) {
+                throw std::runtime_error("No free reader slot in broadcast ring");
+            }
+            activate();
+        }
+
+        // Publish our position as the live cursor (slot must be RESERVED)
+        void activate() noexcept {
+            ReaderCursor& self = cursor_slot();
+            self.position.store(ring_->cursor.load(std::memory_order_acquire), std::memory_order_relaxed);
+            self.state.store(READER_ACTIVE, std::memory_order_release);
+
+            // Pairs with the fence in scan_min_position(): any sequence the
+            // writer allowed itself without seeing us is at most this cursor
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            position_ = ring_->cursor.load(std::memory_order_relaxed);
+            self.position.store(position_, std::memory_order_release);
+        }
+
+        // We were lapped: jump to the live cursor, counting what we missed
+        // An evicted reader also re-registers so the writer gates on it again
+        void resync() noexcept {
+            ReaderCursor& self = cursor_slot();
+            const uint64_t before = position_;
+            uint32_t expected = READER_EVICTED;
+            if (self.state.compare_exchange_strong(expected, READER_RESERVED,
+                                                   std::memory_order_acq_rel)) {
+                activate();
+            } else {
+                position_ = ring_->cursor.load(std::memory_order_acquire);
+                self.position.store(position_, std::memory_order_release);
+            }
+            lost_ += position_ - before;
+            ++laps_;
+        }
+
+        enum class ReadResult { Ok, Empty, Lapped };
+
+        // Seqlock read of the slot for position_ into data
+        ReadResult read_slot(T& data) noexcept {
+            const Slot& slot = ring_->slots[position_ & MASK];
+            const uint64_t held = slot.sequence.load(std::memory_order_acquire);
+
+            if (held != position_ + 1) {
+                // Older sequence: not published yet. Newer: we were lapped
+                return (held & ~SLOT_WRITING) > position_ + 1 ? ReadResult::Lapped : ReadResult::Empty;
+            }
+
+            data = slot.value;
+
+            // Re-check: if the writer started overwriting the slot during the
+            // copy, the sequence has moved on and the copy may be torn
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) != held) {
+                return ReadResult::Lapped;
+            }
+            return ReadResult::Ok;
+        }
+
+    public:
+        // Register a new reader positioned at the live cursor
+        // Throws std::runtime_error if every reader slot is taken, or if the
+        // ring's writer uses an external cursor table
+        explicit Reader(BroadcastRing& ring)
+            : ring_(&ring), table_(&ring.cursors), id_(MaxReaders), position_(0), lost_(0), laps_(0), beats_(0) {
+            if (ring.has_external_cursors()) {
+                throw std::runtime_error("Broadcast ring uses an external cursor table");
+            }
+            attach();
+        }
+
+        // Register in an external cursor table; the ring itself is only read,
+        // so it may sit in a read-only mapping
+        Reader(const BroadcastRing& ring, CursorTable& table)
+            : ring_(&ring), table_(&table), id_(MaxReaders), position_(0), lost_(0), laps_(0), beats_(0) {
+            attach();
+        }
+
+        // Release the cursor slot so the writer stops gating on us, then
+        // give up ownership so the next attach can claim it
+        ~Reader() {
+            cursor_slot().state.store(READER_FREE, std::memory_order_release);
+            cursor_slot().pid.store(0, std::memory_order_release);
+        }
+
+        Reader(const Reader&) = delete;
+        Reader& operator=(const Reader&) = delete;
+        Reader(Reader&&) = delete;
+        Reader& operator=(Reader&&) = delete;
+
+        // Try to read the next message
+        // Returns false if nothing new is published (or we were just lapped)
+        [[nodiscard]] bool try_read(T& data) noexcept {
+            const ReadResult result = read_slot(data);
+            if (result != ReadResult::Ok) {
+                if (result == ReadResult::Lapped) {
+                    resync();
+                }
+                beat();
+                return false;
+            }
+
+            ++position_;
+            cursor_slot().position.store(position_, std::memory_order_release);
+            return true;
+        }
+
+        // Read everything currently published (at most max_items), calling
+        // callback(const T&) on a validated copy of each message
+        // Our cursor is published once for the whole batch
+        // Returns the number of messages consumed
+        template<typename Callback>
+        size_t consume_all(Callback&& callback, size_t max_items = Capacity) {
+            size_t consumed = 0;
+            T data;
+            while (consumed < max_items) {
+                const ReadResult result = read_slot(data);
+                if (result != ReadResult::Ok) {
+                    if (result == ReadResult::Lapped) {
+                        resync();
+                    }
+                    break;
+                }
+                callback(static_cast<const T&>(data));
+                ++position_;
+                ++consumed;
+            }
+            if (consumed > 0) {
+                cursor_slot().position.store(position_, std::memory_order_release);
+            } else {
+                beat();
+            }
+            return consumed;
+        }
+
+        // Drain like consume_all(); if nothing was published, idle once using
+        // the wait strategy (see wait_strategy.hpp) instead of spinning raw
+        // Intended to be called in the consumer's polling loop
+        template<typename WaitStrategy, typename Callback>
+        size_t poll(Callback&& callback, WaitStrategy& wait, size_t max_items = Capacity) {
+            const size_t consumed = consume_all(std::forward<Callback>(callback), max_items);
+            if (consumed > 0) {
+                wait.reset();
+            } else {
+                wait.idle([this](std::chrono::nanoseconds park_time) { park(park_time); });
+            }
+            return consumed;
+        }
+
+        // Sleep until something new is published
+        // With a doorbell the writer wakes us on its next publish (bounded by
+        // BROADCAST_DOORBELL_TIMEOUT); without one this sleeps for park_time
+        void park(std::chrono::nanoseconds park_time) noexcept {
+            beat();
+            if (!ring_->use_doorbell) {
+                park_for(park_time);
+                return;
+            }
+            table_->doorbell.wait([this]() {
+                return ring_->cursor.load(std::memory_order_relaxed) > position_;
+            }, BROADCAST_DOORBELL_TIMEOUT);
+        }
+
+        // Look at the next message in place, or nullptr if nothing new is
+        // published (or we were just lapped)
+        // Call release() once done with it; the pointer is not valid after that
+        [[nodiscard]] const T* peek() noexcept {
+            const Slot& slot = ring_->slots[position_ & MASK];
+            const uint64_t held = slot.sequence.load(std::memory_order_acquire);
+
+            if (held != position_ + 1) {
+                if ((held & ~SLOT_WRITING) > position_ + 1) {
+                    resync();
+                }
+                beat();
+                return nullptr;
+            }
+            return &slot.value;
+        }
+
+        // Move past the message returned by the last successful peek()
+        // Returns false if the writer overwrote the slot while we were using
+        // it: anything read through the pointer may be torn and must be
+        // discarded. The reader has then already skipped to the live cursor
+        bool release() noexcept {
+            const Slot& slot = ring_->slots[position_ & MASK];
+
+            // Seqlock re-check, as after the copy in read_slot()
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) != position_ + 1) {
+                resync();
+                return false;
+            }
+
+            ++position_;
+            cursor_slot().position.store(position_, std::memory_order_release);
+            return true;
+        }
+
+        // Reader slot index in the ring
+        [[nodiscard]] size_t id() const noexcept {
+            return id_;
+        }
+
+        // Next sequence this reader will consume
+        [[nodiscard]] uint64_t position() const noexcept {
+            return position_;
+        }
+
+        // Messages published but not yet consumed by this reader
+        [[nodiscard]] uint64_t lag() const noexcept {
+            return ring_->published() - position_;
+        }
+
+        // Messages skipped because the writer lapped this reader
+        [[nodiscard]] uint64_t lost_messages() const noexcept {
+            return lost_;
+        }
+
+        // Number of times the writer lapped this reader
+        [[nodiscard]] uint64_t times_lapped() const noexcept {
+            return laps_;
+        }
+
+        // Heartbeats published so far (empty polls and parks)
+        [[nodiscard]] uint64_t heartbeats() const noexcept {
+            return beats_;
+        }
+    };
+};
+
+// ============================================================================
+// TYPE ALIASES
+// ============================================================================
+
+// Ring constructed by the publisher in each channel's "hft_<channel>" segment
+using ShmBroadcastRing = BroadcastRing<MarketData, SHM_RING_BUFFER_SIZE>;
+
+// ============================================================================
+// COMPILE-TIME CHECKS
+// ============================================================================
+
+static_assert(alignof(ShmBroadcastRing) == 64,
+              "BroadcastRing should be aligned to 64-byte boundaries");
+
+} // namespace hft
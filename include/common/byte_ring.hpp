@@ -0,0 +1,350 @@
+#pragma once
+
+// ============================================================================
+// VARIABLE-LENGTH FRAME RING (SPSC)
+// ============================================================================
+// This header implements a Single Producer Single Consumer ring of bytes that
+// carries length-prefixed frames. Unlike SpscRingBuffer, which stores one
+// fixed-size element per slot, a single ByteRing channel can carry
+// heterogeneous messages (order-book depth updates, trade prints, status
+// messages) of different sizes, each taking only the cache lines it needs.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include "ring_buffer.hpp"
+
+namespace hft {
+
+// ============================================================================
+// CONSTANTS
+// ============================================================================
+
+// Every frame starts on a cache line boundary
+constexpr size_t FRAME_ALIGNMENT = 64;
+
+// Frame type reserved for the padding record written at wrap-around
+// Application frame types must be non-zero
+constexpr uint16_t FRAME_TYPE_PADDING = 0;
+
+// ============================================================================
+// FrameHeader
+// ============================================================================
+// Written at the start of every frame, directly followed by the payload
+struct FrameHeader {
+    uint32_t length;    // Payload length in bytes (excluding this header)
+    uint16_t type;      // Application message type, FRAME_TYPE_PADDING for padding
+    uint16_t reserved;  // Zero; keeps the payload 8-byte aligned
+};
+
+static_assert(sizeof(FrameHeader) == 8, "FrameHeader must stay 8 bytes");
+
+// ============================================================================
+// Frame
+// ============================================================================
+// A frame as seen by the consumer; data points into the ring
+struct Frame {
+    uint16_t type;
+    uint32_t length;
+    const std::byte* data;
+};
+
+// ============================================================================
+// ByteRing Class Template
+// ============================================================================
+//
+// DESIGN PRINCIPLES:
+//   - Same producer/consumer protocol as SpscRingBuffer: one release store of
+//     the producer's position publishes a frame, one release store of the
+//     consumer's position frees it, and each side caches the other's position
+//   - Positions are monotonic 64-bit byte counts; the offset in the data
+//     array is position & MASK. Because they never wrap, read == write means
+//     empty and write - read == CapacityBytes means full, so no byte has to
+//     be left unused
+//
+// FRAME LAYOUT:
+//   - [FrameHeader][payload][pad to 64 bytes]
+//   - A frame occupies round_up(8 + length, 64) bytes, so every frame header
+//     starts on a cache line and a 20-byte status message costs one line
+//     instead of a whole fixed-size slot
+//
+// WRAP-AROUND:
+//   - Frames are never split across the end of the array. If a frame does
+//     not fit in the bytes left before the end, the producer fills them with
+//     a padding frame (type FRAME_TYPE_PADDING) and writes the frame at
+//     offset 0. The consumer skips padding frames transparently
+//   - A frame may therefore need up to twice its size in free space, which
+//     is why frames are limited to max_frame_size() = CapacityBytes / 2
+//
+// ZERO-COPY ACCESS:
+//   - claim(type, length) returns the payload area of the next frame so the
+//     message can be built in place; commit() publishes it
+//   - peek() returns the next frame in place; release() frees it.
+//     consume_all() drains many frames with a single release store
+//
+
+template<size_t CapacityBytes>
+class alignas(64) ByteRing {
+    static_assert(CapacityBytes >= 2 * FRAME_ALIGNMENT && (CapacityBytes & (CapacityBytes - 1)) == 0,
+                  "ByteRing capacity must be a power of 2 of at least two cache lines");
+
+private:
+    static constexpr uint64_t MASK = CapacityBytes - 1;
+
+    // Bytes occupied by a frame with the given payload length
+    static constexpr uint64_t frame_bytes(uint64_t length) noexcept {
+        return (sizeof(FrameHeader) + length + FRAME_ALIGNMENT - 1) & ~uint64_t{FRAME_ALIGNMENT - 1};
+    }
+
+    // Layout description, first member like every ring in this codebase
+    // A ByteRing records 1-byte elements and CapacityBytes slots
+    alignas(64) RingGeometry geometry{1, CapacityBytes, sizeof(ByteRing)};
+
+    // Producer line: published position plus producer-private state
+    alignas(64) std::atomic<uint64_t> write_pos{0};
+    uint64_t cached_read_pos{0};   // Last read_pos observed
+    uint64_t pending_end{0};       // End of the frame claimed but not yet committed
+
+    // Consumer line: published position plus consumer-private state
+    alignas(64) std::atomic<uint64_t> read_pos{0};
+    uint64_t cached_write_pos{0};  // Last write_pos observed
+    uint64_t peeked_end{0};        // End of the frame returned by peek()
+
+    // Frame storage, starting on its own cache line
+    alignas(64) std::byte data[CapacityBytes];
+
+    FrameHeader* header_at(uint64_t position) noexcept {
+        return reinterpret_cast<FrameHeader*>(&data[position & MASK]);
+    }
+
+    const FrameHeader* header_at(uint64_t position) const noexcept {
+        return reinterpret_cast<const FrameHeader*>(&data[position & MASK]);
+    }
+
+    // Position of the next non-padding frame at or after position, which
+    // must be below the producer position 'end'; returns end if only padding
+    uint64_t skip_padding(uint64_t position, uint64_t end) const noexcept {
+        while (position != end && header_at(position)->type == FRAME_TYPE_PADDING) {
+            position += header_at(position)->length + sizeof(FrameHeader);
+        }
+        return position;
+    }
+
+public:
+    // ========================================================================
+    // CONSTRUCTOR
+    // ========================================================================
+    ByteRing() = default;
+
+    // ========================================================================
+    // COPY/MOVE SEMANTICS
+    // ========================================================================
+    // ByteRing is not copyable or movable due to atomic members
+    ByteRing(const ByteRing&) = delete;
+    ByteRing& operator=(const ByteRing&) = delete;
+    ByteRing(ByteRing&&) = delete;
+    ByteRing& operator=(ByteRing&&) = delete;
+
+    // ========================================================================
+    // PRODUCER INTERFACE (Single Producer)
+    // ========================================================================
+
+    // Claim space for a frame with a payload of length bytes
+    // Returns the payload area (8-byte aligned) to fill in, or nullptr if the
+    // ring does not have room or the frame exceeds max_frame_size()
+    // The frame is invisible to the consumer until commit()
+    [[nodiscard]] std::byte* claim(uint16_t type, uint32_t length) noexcept {
+        const uint64_t size = frame_bytes(length);
+        if (type == FRAME_TYPE_PADDING || size > max_frame_size()) {
+            return nullptr;
+        }
+
+        uint64_t position = write_pos.load(std::memory_order_relaxed);
+        const uint64_t to_end = CapacityBytes - (position & MASK);
+        const uint64_t needed = size <= to_end ? size : to_end + size;
+
+        // Only go to the consumer's cache line when our cached copy says full
+        if (position + needed - cached_read_pos > CapacityBytes) {
+            cached_read_pos = read_pos.load(std::memory_order_acquire);
+            if (position + needed - cached_read_pos > CapacityBytes) {
+                return nullptr; // Not enough free space
+            }
+        }
+
+        // Frame does not fit before the end: pad out the tail and wrap
+        if (size > to_end) {
+            FrameHeader* padding = header_at(position);
+            padding->length = static_cast<uint32_t>(to_end - sizeof(FrameHeader));
+            padding->type = FRAME_TYPE_PADDING;
+            padding->reserved = 0;
+            position += to_end;
+        }
+
+        FrameHeader* header = header_at(position);
+        header->length = length;
+        header->type = type;
+        header->reserved = 0;
+        pending_end = position + size;
+
+        return reinterpret_cast<std::byte*>(header + 1);
+    }
+
+    // Publish the frame returned by the last successful claim()
+    // (and the padding frame in front of it, if one was written)
+    void commit() noexcept {
+        write_pos.store(pending_end, std::memory_order_release);
+    }
+
+    // Copy a payload of length bytes into a new frame
+    // Returns false if there is no room (or the frame is too large)
+    [[nodiscard]] bool try_write(uint16_t type, const void* payload, uint32_t length) noexcept {
+        std::byte* destination = claim(type, length);
+        if (destination == nullptr) {
+            return false;
+        }
+        std::memcpy(destination, payload, length);
+        commit();
+        return true;
+    }
+
+    // Write a trivially copyable message as one frame
+    template<typename Message>
+    [[nodiscard]] bool try_write(uint16_t type, const Message& message) noexcept {
+        static_assert(std::is_trivially_copyable_v<Message>,
+                      "ByteRing messages are copied across processes and must be trivially copyable");
+        return try_write(type, &message, static_cast<uint32_t>(sizeof(Message)));
+    }
+
+    // Free bytes from the producer's perspective (not all of it may be usable
+    // by one frame, see WRAP-AROUND)
+    [[nodiscard]] size_t available_for_write() const noexcept {
+        const uint64_t position = write_pos.load(std::memory_order_relaxed);
+        return CapacityBytes - (position - read_pos.load(std::memory_order_acquire));
+    }
+
+    // ========================================================================
+    // CONSUMER INTERFACE (Single Consumer)
+    // ========================================================================
+
+    // Look at the next frame in place without copying it out
+    // Returns false if no frame is available; otherwise frame.data stays valid
+    // (the producer cannot reuse it) until release() is called
+    [[nodiscard]] bool peek(Frame& frame) noexcept {
+        const uint64_t position = read_pos.load(std::memory_order_relaxed);
+
+        // Only go to the producer's cache line when our cached copy says empty
+        uint64_t start = skip_padding(position, cached_write_pos);
+        if (start == cached_write_pos) {
+            cached_write_pos = write_pos.load(std::memory_order_acquire);
+            start = skip_padding(start, cached_write_pos);
+            if (start == cached_write_pos) {
+                return false; // Ring is empty
+            }
+        }
+
+        const FrameHeader* header = header_at(start);
+        frame = Frame{header->type, header->length, reinterpret_cast<const std::byte*>(header + 1)};
+        peeked_end = start + frame_bytes(header->length);
+        return true;
+    }
+
+    // Free the frame returned by the last successful peek()
+    void release() noexcept {
+        read_pos.store(peeked_end, std::memory_order_release);
+    }
+
+    // Drain every available frame (at most max_frames), calling
+    // callback(const Frame&) on each frame in place
+    // read_pos is published once for the whole batch
+    // Returns the number of frames consumed
+    template<typename Callback>
+    size_t consume_all(Callback&& callback, size_t max_frames = CapacityBytes / FRAME_ALIGNMENT) {
+        uint64_t position = read_pos.load(std::memory_order_relaxed);
+        if (position == cached_write_pos) {
+            cached_write_pos = write_pos.load(std::memory_order_acquire);
+        }
+        const uint64_t end = cached_write_pos;
+
+        size_t consumed = 0;
+        while (consumed < max_frames) {
+            position = skip_padding(position, end);
+            if (position == end) {
+                break;
+            }
+            const FrameHeader* header = header_at(position);
+            const Frame frame{header->type, header->length, reinterpret_cast<const std::byte*>(header + 1)};
+            callback(frame);
+            position += frame_bytes(header->length);
+            ++consumed;
+        }
+
+        if (position != read_pos.load(std::memory_order_relaxed)) {
+            read_pos.store(position, std::memory_order_release);
+        }
+        return consumed;
+    }
+
+    // Check if the ring holds no frames (from consumer's perspective)
+    // A ring holding only a padding frame is reported as non-empty until the
+    // next peek() or consume_all() skips it
+    [[nodiscard]] bool is_empty() const noexcept {
+        const uint64_t position = read_pos.load(std::memory_order_relaxed);
+        return position == write_pos.load(std::memory_order_acquire);
+    }
+
+    // ========================================================================
+    // UTILITY FUNCTIONS
+    // ========================================================================
+
+    // Total bytes of frame storage
+    [[nodiscard]] static constexpr size_t capacity() noexcept {
+        return CapacityBytes;
+    }
+
+    // Largest frame (header + payload + alignment) the ring accepts
+    [[nodiscard]] static constexpr size_t max_frame_size() noexcept {
+        return CapacityBytes / 2;
+    }
+
+    // Largest payload the ring accepts
+    [[nodiscard]] static constexpr size_t max_payload() noexcept {
+        return max_frame_size() - sizeof(FrameHeader);
+    }
+
+    // Bytes a frame with the given payload length occupies in the ring
+    [[nodiscard]] static constexpr size_t frame_size(size_t length) noexcept {
+        return frame_bytes(length);
+    }
+
+    [[nodiscard]] static constexpr RingGeometry expected_geometry() noexcept {
+        return RingGeometry{1, CapacityBytes, sizeof(ByteRing)};
+    }
+
+    [[nodiscard]] static bool geometry_matches(const RingGeometry& recorded) noexcept {
+        return recorded == expected_geometry();
+    }
+
+    [[nodiscard]] const RingGeometry& get_geometry() const noexcept {
+        return geometry;
+    }
+
+    // Bytes written / freed so far (for debugging/monitoring)
+    [[nodiscard]] uint64_t get_write_position() const noexcept {
+        return write_pos.load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] uint64_t get_read_position() const noexcept {
+        return read_pos.load(std::memory_order_relaxed);
+    }
+};
+
+// ============================================================================
+// COMPILE-TIME CHECKS
+// ============================================================================
+
+static_assert(alignof(ByteRing<4096>) == 64,
+              "ByteRing should be aligned to 64-byte boundaries");
+
+} // namespace hft
@@ -0,0 +1,571 @@
+#pragma once
+
+// ============================================================================
+// SHARED MEMORY CHANNEL REGISTRY
+// ============================================================================
+// This header lets one publisher serve many named shared memory streams.
+// Each channel is a broadcast ring in two segments: data, which readers map
+// read-only, and the reader cursor table. A small directory segment lists every
+// channel with its ring geometry, message schema and owner, so consumers can
+// discover channels and attach to only the ones they need instead of filtering
+// one firehose.
+//
+//   hft_channels                 directory (ChannelDirectory)
+//   hft_<channel>                data segment  (BroadcastRing)
+//   hft_<channel>_cursors        cursor segment (BroadcastCursorTable)
+//
+// A publisher that keeps its segments on exit (ShmOptions::persist) can be
+// restarted without disturbing its consumers: the new process resumes the
+// directory and every channel in place, and the rings carry on from the next
+// sequence number.
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unistd.h>
+#include "broadcast_ring.hpp"
+#include "ring_buffer.hpp"
+#include "shared_memory.hpp"
+#include "wait_strategy.hpp"
+
+namespace hft {
+
+// ============================================================================
+// CONSTANTS
+// ============================================================================
+
+// Longest channel name, including the terminating null
+constexpr size_t CHANNEL_NAME_LEN = 32;
+
+// Longest message schema name, including the terminating null
+constexpr size_t CHANNEL_SCHEMA_LEN = 24;
+
+// Number of channels one directory can list
+constexpr size_t MAX_CHANNELS = 64;
+
+// Shared memory segment holding the directory
+inline constexpr const char* CHANNEL_DIRECTORY_SEGMENT = "hft_channels";
+
+// Segment names of a channel's ring and of its reader cursor table
+inline std::string channel_data_segment(std::string_view channel) {
+    return "hft_" + std::string(channel);
+}
+
+inline std::string channel_cursor_segment(std::string_view channel) {
+    return channel_data_segment(channel) + "_cursors";
+}
+
+// Remove a channel's segments, e.g. ones a persistent publisher left behind
+inline void remove_channel_segments(std::string_view channel, const ShmOptions& options = ShmOptions{}) {
+    SharedMemoryManager::remove(channel_data_segment(channel), options);
+    SharedMemoryManager::remove(channel_cursor_segment(channel), options);
+}
+
+// Segment layout of a ring (or cursor table) with the given geometry
+inline ShmLayout ring_shm_layout(const RingGeometry& geometry) noexcept {
+    return ShmLayout{geometry.element_size, geometry.slot_count, geometry.total_bytes};
+}
+
+// ============================================================================
+// ChannelDescriptor
+// ============================================================================
+// One directory entry: everything a consumer needs to decide whether it wants
+// a channel and whether it can read it
+struct ChannelDescriptor {
+    char name[CHANNEL_NAME_LEN];      // Null-terminated channel name
+    char schema[CHANNEL_SCHEMA_LEN];  // Message type carried, e.g. "MarketData"
+    uint32_t schema_version;          // Version of that message layout
+    int32_t owner_pid;                // Publishing process
+    uint64_t element_size;            // Ring geometry, as in RingGeometry
+    uint64_t capacity;
+    uint64_t payload_bytes;
+    int64_t created_ns;               // Registration time, ns since the Unix epoch
+
+    // Describe a channel carried by a ring of type Ring, owned by this process
+    // Throws std::runtime_error if a name does not fit
+    template<typename Ring>
+    static ChannelDescriptor for_ring(std::string_view name, std::string_view schema,
+                                      uint32_t schema_version) {
+        if (name.empty() || name.size() >= CHANNEL_NAME_LEN) {
+            throw std::runtime_error("Invalid channel name: '" + std::string(name) + "'");
+        }
+        if (schema.size() >= CHANNEL_SCHEMA_LEN) {
+            throw std::runtime_error("Channel schema name too long: '" + std::string(schema) + "'");
+        }
+
+        constexpr RingGeometry geometry = Ring::expected_geometry();
+        ChannelDescriptor descriptor{};
+        std::memcpy(descriptor.name, name.data(), name.size());
+        std::memcpy(descriptor.schema, schema.data(), schema.size());
+        descriptor.schema_version = schema_version;
+        descriptor.owner_pid = static_cast<int32_t>(getpid());
+        descriptor.element_size = geometry.element_size;
+        descriptor.capacity = geometry.slot_count;
+        descriptor.payload_bytes = geometry.total_bytes;
+        descriptor.created_ns = shm_clock_ns();
+        return descriptor;
+    }
+
+    // True if a ring of type Ring can read this channel
+    template<typename Ring>
+    [[nodiscard]] bool readable_as() const noexcept {
+        constexpr RingGeometry geometry = Ring::expected_geometry();
+        return element_size == geometry.element_size && capacity == geometry.slot_count &&
+               payload_bytes == geometry.total_bytes;
+    }
+};
+
+// ============================================================================
+// ChannelDirectory
+// ============================================================================
+//
+// DESIGN:
+//   - Fixed array of entries, constructed in place in its own segment
+//   - Each entry is guarded by a seqlock counter that doubles as a writer
+//     lock: a publisher adding or removing a channel CASes it from even to
+//     odd, updates the entry, and stores the next even value with release
+//   - Lookups copy an entry and retry if the counter moved, so a consumer
+//     never sees a half-written descriptor
+//   - Channels change rarely (at publisher start and stop), so every
+//     operation is a linear scan
+//
+template<size_t MaxChannels = MAX_CHANNELS>
+struct alignas(64) ChannelDirectory {
+    struct alignas(64) Entry {
+        std::atomic<uint32_t> sequence{0};  // Odd while the entry is being changed
+        uint32_t live{0};                   // Entry describes a channel
+        ChannelDescriptor channel{};
+    };
+
+    // Layout description, first member like every ring in this codebase
+    alignas(64) RingGeometry geometry{sizeof(Entry), MaxChannels, sizeof(ChannelDirectory)};
+
+    Entry entries[MaxChannels];
+
+    // List a channel; false if the name is taken or the directory is full
+    bool add(const ChannelDescriptor& channel) noexcept {
+        if (find(channel.name)) {
+            return false;
+        }
+        for (Entry& entry : entries) {
+            uint32_t sequence = entry.sequence.load(std::memory_order_acquire);
+            if ((sequence & 1) != 0 || entry.live != 0 ||
+                !entry.sequence.compare_exchange_strong(sequence, sequence + 1,
+                                                        std::memory_order_acquire)) {
+                continue;
+            }
+            // Locked: re-check now that nobody else can change the entry
+            const bool taken = entry.live != 0;
+            if (!taken) {
+                entry.channel = channel;
+                entry.live = 1;
+            }
+            entry.sequence.store(sequence + 2, std::memory_order_release);
+            if (!taken) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Replace the descriptor of the listed channel with the same name (e.g.
+    // to record a restarted owner); false if no such channel is listed
+    bool update(const ChannelDescriptor& channel) noexcept {
+        const std::string_view name = channel.name;
+        for (Entry& entry : entries) {
+            uint32_t sequence = entry.sequence.load(std::memory_order_acquire);
+            if ((sequence & 1) != 0 || entry.live == 0 || name != entry.channel.name ||
+                !entry.sequence.compare_exchange_strong(sequence, sequence + 1,
+                                                        std::memory_order_acquire)) {
+                continue;
+            }
+            const bool match = entry.live != 0 && name == entry.channel.name;
+            if (match) {
+                entry.channel = channel;
+            }
+            entry.sequence.store(sequence + 2, std::memory_order_release);
+            if (match) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Unlist a channel; false if no such channel is listed
+    bool remove(std::string_view name) noexcept {
+        for (Entry& entry : entries) {
+            uint32_t sequence = entry.sequence.load(std::memory_order_acquire);
+            if ((sequence & 1) != 0 || entry.live == 0 || name != entry.channel.name ||
+                !entry.sequence.compare_exchange_strong(sequence, sequence + 1,
+                                                        std::memory_order_acquire)) {
+                continue;
+            }
+            const bool match = entry.live != 0 && name == entry.channel.name;
+            if (match) {
+                entry.live = 0;
+            }
+            entry.sequence.store(sequence + 2, std::memory_order_release);
+            if (match) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Snapshot of the channel called name, if it is listed
+    [[nodiscard]] std::optional<ChannelDescriptor> find(std::string_view name) const noexcept {
+        std::optional<ChannelDescriptor> found;
+        for_each([&](const ChannelDescriptor& channel) {
+            if (!found && name == channel.name) {
+                found = channel;
+            }
+        });
+        return found;
+    }
+
+    // Call fn(const ChannelDescriptor&) on a consistent snapshot of every
+    // listed channel; returns the number of channels visited
+    template<typename Fn>
+    size_t for_each(Fn&& fn) const {
+        size_t visited = 0;
+        for (const Entry& entry : entries) {
+            uint32_t live;
+            ChannelDescriptor snapshot;
+            while (true) {
+                const uint32_t before = entry.sequence.load(std::memory_order_acquire);
+                if ((before & 1) != 0) {
+                    cpu_relax();
+                    continue;
+                }
+                live = entry.live;
+                snapshot = entry.channel;
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (entry.sequence.load(std::memory_order_relaxed) == before) {
+                    break;
+                }
+            }
+            if (live != 0) {
+                fn(static_cast<const ChannelDescriptor&>(snapshot));
+                ++visited;
+            }
+        }
+        return visited;
+    }
+
+    [[nodiscard]] static constexpr RingGeometry expected_geometry() noexcept {
+        return RingGeometry{sizeof(Entry), MaxChannels, sizeof(ChannelDirectory)};
+    }
+
+    [[nodiscard]] static constexpr size_t capacity() noexcept {
+        return MaxChannels;
+    }
+};
+
+// ============================================================================
+// ChannelRegistry
+// ============================================================================
+// Owns a mapping of the directory segment. The publisher create()s it (and
+// removes it again on exit); consumers open() it to discover channels.
+class ChannelRegistry {
+public:
+    using Directory = ChannelDirectory<MAX_CHANNELS>;
+
+private:
+    SharedMemoryManager shm_;
+    Directory* directory_;
+
+    ChannelRegistry(SharedMemoryManager&& shm, Directory* directory) noexcept
+        : shm_(std::move(shm)), directory_(directory) {}
+
+public:
+    // Create an empty directory (replacing one left behind by a crashed owner)
+    static ChannelRegistry create(const std::string& segment = CHANNEL_DIRECTORY_SEGMENT,
+                                  const ShmOptions& options = ShmOptions{}) {
+        SharedMemoryManager shm = SharedMemoryManager::create_segment(
+            segment, ring_shm_layout(Directory::expected_geometry()), options);
+        Directory* directory = new(shm.payload()) Directory();
+        shm.mark_ready();
+        return ChannelRegistry(std::move(shm), directory);
+    }
+
+    // Publisher restart: take over the directory a previous owner left
+    // behind, channels and all, or create an empty one if there is none
+    // Throws std::runtime_error if its owner is still running
+    static ChannelRegistry resume(const std::string& segment = CHANNEL_DIRECTORY_SEGMENT,
+                                  const ShmOptions& options = ShmOptions{}) {
+        std::optional<SharedMemoryManager> shm = SharedMemoryManager::resume_segment(
+            segment, ring_shm_layout(Directory::expected_geometry()), options);
+        if (!shm || !geometry_matches(shm->payload())) {
+            return create(segment, options);
+        }
+        Directory* directory = static_cast<Directory*>(shm->payload());
+        return ChannelRegistry(std::move(*shm), directory);
+    }
+
+    // Attach to the directory; writable to add or remove channels
+    // Throws std::runtime_error if there is none, or it has another layout
+    static ChannelRegistry open(const std::string& segment = CHANNEL_DIRECTORY_SEGMENT,
+                                bool writable = false) {
+        SharedMemoryManager shm = SharedMemoryManager::attach_segment(
+            segment, ring_shm_layout(Directory::expected_geometry()), writable);
+        if (!geometry_matches(shm.payload())) {
+            throw std::runtime_error("Channel directory " + segment + " has a different layout");
+        }
+        Directory* directory = static_cast<Directory*>(shm.payload());
+        return ChannelRegistry(std::move(shm), directory);
+    }
+
+    // List a channel, or take over its entry if the process that listed it
+    // has exited (a restarted publisher); throws std::runtime_error if the
+    // name is taken by a running process or the directory is full
+    void add_channel(const ChannelDescriptor& channel) {
+        if (directory_->add(channel)) {
+            return;
+        }
+        const std::optional<ChannelDescriptor> listed = directory_->find(channel.name);
+        if (listed && !process_alive(listed->owner_pid) && directory_->update(channel)) {
+            return;
+        }
+        throw std::runtime_error("Cannot register channel '" + std::string(channel.name) +
+                                 "' (name taken or directory full)");
+    }
+
+    bool remove_channel(std::string_view name) noexcept {
+        return directory_->remove(name);
+    }
+
+    [[nodiscard]] std::optional<ChannelDescriptor> find(std::string_view name) const noexcept {
+        return directory_->find(name);
+    }
+
+    // Snapshot of every listed channel
+    [[nodiscard]] std::vector<ChannelDescriptor> channels() const {
+        std::vector<ChannelDescriptor> result;
+        directory_->for_each([&](const ChannelDescriptor& channel) { result.push_back(channel); });
+        return result;
+    }
+
+    [[nodiscard]] const SharedMemoryManager& segment() const noexcept {
+        return shm_;
+    }
+
+private:
+    static bool geometry_matches(const void* payload) noexcept {
+        return read_ring_geometry(payload) == Directory::expected_geometry();
+    }
+};
+
+// ============================================================================
+// BroadcastChannelWriter
+// ============================================================================
+// Publisher end of one channel: creates both segments, constructs the ring
+// and its cursor table in place and binds a Writer to them. Not movable: the
+// Writer points into the mappings.
+template<typename Ring>
+class BroadcastChannelWriter {
+private:
+    // Both segments of a channel, freshly created or taken over together
+    struct Segments {
+        SharedMemoryManager data;
+        SharedMemoryManager cursors;
+        bool resumed;
+    };
+
+    std::string name_;
+    SharedMemoryManager data_shm_;
+    SharedMemoryManager cursor_shm_;
+    bool resumed_;
+    Ring* ring_;
+    typename Ring::CursorTable* table_;
+    typename Ring::Writer writer_;
+
+    // Resume both segments if a previous publisher left valid ones behind,
+    // otherwise create both afresh
+    static Segments open_segments(std::string_view name, const ShmOptions& data_options,
+                                  const ShmOptions& cursor_options, bool resume) {
+        const ShmLayout data_layout = ring_shm_layout(Ring::expected_geometry());
+        const ShmLayout cursor_layout = ring_shm_layout(Ring::CursorTable::expected_geometry());
+        if (resume) {
+            std::optional<SharedMemoryManager> data =
+                SharedMemoryManager::resume_segment(channel_data_segment(name), data_layout, data_options);
+            std::optional<SharedMemoryManager> cursors =
+                SharedMemoryManager::resume_segment(channel_cursor_segment(name), cursor_layout, cursor_options);
+            if (data && cursors &&
+                Ring::geometry_matches(read_ring_geometry(data->payload())) &&
+                Ring::CursorTable::geometry_matches(read_ring_geometry(cursors->payload()))) {
+                return Segments{std::move(*data), std::move(*cursors), true};
+            }
+        }
+        return Segments{
+            SharedMemoryManager::create_segment(channel_data_segment(name), data_layout, data_options),
+            SharedMemoryManager::create_segment(channel_cursor_segment(name), cursor_layout, cursor_options),
+            false};
+    }
+
+    BroadcastChannelWriter(std::string_view name, OverflowPolicy policy, bool enable_doorbell,
+                           Segments&& segments)
+        : name_(name),
+          data_shm_(std::move(segments.data)),
+          cursor_shm_(std::move(segments.cursors)),
+          resumed_(segments.resumed),
+          ring_(resumed_ ? static_cast<Ring*>(data_shm_.payload())
+                         : new(data_shm_.payload()) Ring(policy, enable_doorbell)),
+          table_(resumed_ ? static_cast<typename Ring::CursorTable*>(cursor_shm_.payload())
+                          : new(cursor_shm_.payload()) typename Ring::CursorTable()),
+          writer_(*ring_, *table_) {
+        if (resumed_) {
+            writer_.recover();
+        }
+        cursor_shm_.mark_ready();
+        data_shm_.mark_ready();
+    }
+
+public:
+    // Readers can attach as soon as this returns
+    // With resume, take over the channel's segments if a previous publisher
+    // left valid ones behind (see ShmOptions::persist): attached readers keep
+    // their cursors, and the ring keeps the policy and doorbell it was built
+    // with. Throws std::runtime_error if that publisher is still running
+    BroadcastChannelWriter(std::string_view name, OverflowPolicy policy, bool enable_doorbell,
+                           const ShmOptions& data_options = ShmOptions{},
+                           const ShmOptions& cursor_options = ShmOptions{},
+                           bool resume = false)
+        : BroadcastChannelWriter(name, policy, enable_doorbell,
+                                 open_segments(name, data_options, cursor_options, resume)) {}
+
+    BroadcastChannelWriter(const BroadcastChannelWriter&) = delete;
+    BroadcastChannelWriter& operator=(const BroadcastChannelWriter&) = delete;
+
+    [[nodiscard]] typename Ring::Writer& writer() noexcept {
+        return writer_;
+    }
+
+    [[nodiscard]] Ring& ring() noexcept {
+        return *ring_;
+    }
+
+    [[nodiscard]] typename Ring::CursorTable& cursor_table() noexcept {
+        return *table_;
+    }
+
+    [[nodiscard]] SharedMemoryManager& data_segment() noexcept {
+        return data_shm_;
+    }
+
+    // True if the segments were taken over from a previous publisher
+    [[nodiscard]] bool resumed() const noexcept {
+        return resumed_;
+    }
+
+    [[nodiscard]] SharedMemoryManager& cursor_segment() noexcept {
+        return cursor_shm_;
+    }
+
+    [[nodiscard]] const std::string& name() const noexcept {
+        return name_;
+    }
+};
+
+// ============================================================================
+// BroadcastChannelReader
+// ============================================================================
+// Consumer end of one channel: attaches to the data segment read-only and to
+// the cursor segment read-write, validates both layouts and registers a
+// Reader. Not movable: the Reader points into the mappings.
+template<typename Ring>
+class BroadcastChannelReader {
+private:
+    std::string name_;
+    SharedMemoryManager data_shm_;
+    SharedMemoryManager cursor_shm_;
+    typename Ring::Reader reader_;
+    uint32_t generation_;  // Publisher incarnation last seen
+
+    // The ring's own geometry record must agree with the segment header
+    static const Ring& ring_in(const SharedMemoryManager& shm) {
+        if (!Ring::geometry_matches(read_ring_geometry(shm.payload()))) {
+            throw std::runtime_error("Ring layout mismatch in " + shm.get_name());
+        }
+        return *static_cast<const Ring*>(shm.payload());
+    }
+
+    static typename Ring::CursorTable& table_in(const SharedMemoryManager& shm) {
+        if (!Ring::CursorTable::geometry_matches(read_ring_geometry(shm.payload()))) {
+            throw std::runtime_error("Cursor table layout mismatch in " + shm.get_name());
+        }
+        return *static_cast<typename Ring::CursorTable*>(shm.payload());
+    }
+
+public:
+    // Throws std::runtime_error if the channel's segments are missing, not
+    // ready, or were built with a different layout
+    BroadcastChannelReader(std::string_view name,
+                           const ShmOptions& data_options = ShmOptions{},
+                           const ShmOptions& cursor_options = ShmOptions{})
+        : name_(name),
+          data_shm_(SharedMemoryManager::attach_segment(
+              channel_data_segment(name), ring_shm_layout(Ring::expected_geometry()), false, data_options)),
+          cursor_shm_(SharedMemoryManager::attach_segment(
+              channel_cursor_segment(name), ring_shm_layout(Ring::CursorTable::expected_geometry()), true,
+              cursor_options)),
+          reader_(ring_in(data_shm_), table_in(cursor_shm_)),
+          generation_(data_shm_.generation()) {}
+
+    BroadcastChannelReader(const BroadcastChannelReader&) = delete;
+    BroadcastChannelReader& operator=(const BroadcastChannelReader&) = delete;
+
+    [[nodiscard]] typename Ring::Reader& reader() noexcept {
+        return reader_;
+    }
+
+    [[nodiscard]] const typename Ring::Reader& reader() const noexcept {
+        return reader_;
+    }
+
+    [[nodiscard]] const Ring& ring() const noexcept {
+        return *static_cast<const Ring*>(data_shm_.payload());
+    }
+
+    [[nodiscard]] typename Ring::CursorTable& cursor_table() const noexcept {
+        return *static_cast<typename Ring::CursorTable*>(cursor_shm_.payload());
+    }
+
+    [[nodiscard]] const SharedMemoryManager& data_segment() const noexcept {
+        return data_shm_;
+    }
+
+    [[nodiscard]] const SharedMemoryManager& cursor_segment() const noexcept {
+        return cursor_shm_;
+    }
+
+    [[nodiscard]] const std::string& name() const noexcept {
+        return name_;
+    }
+
+    // True once per warm restart of the publisher: it took the channel over
+    // since the last call. Nothing to redo, the reader carries on from its
+    // cursor and sequence numbers continue where they left off
+    [[nodiscard]] bool publisher_restarted() noexcept {
+        const uint32_t generation = data_shm_.generation();
+        if (generation == generation_) {
+            return false;
+        }
+        generation_ = generation;
+        return true;
+    }
+
+    // True if the channel was removed or recreated from scratch (a cold
+    // publisher start): this reader will see no more messages and has to be
+    // replaced by a new one. Makes a system call, so poll it sparingly
+    [[nodiscard]] bool replaced() const {
+        return data_shm_.unlinked() || cursor_shm_.unlinked();
+    }
+};
+
+} // namespace hft
@@ -0,0 +1,104 @@
+#pragma once
+
+// ============================================================================
+// CROSS-PROCESS DOORBELL
+// ============================================================================
+// This header implements a wake-up signal that lives in shared memory, so a
+// consumer in another process can sleep in the kernel until the publisher has
+// something for it, instead of spinning on the ring.
+//
+// On Linux the doorbell is a futex word. Elsewhere it degrades to timed
+// polling, which is still correct, just slower to wake.
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <time.h>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace hft {
+
+// ============================================================================
+// Doorbell
+// ============================================================================
+//
+// PROTOCOL:
+//   - A reader that wants to sleep increments sleepers, re-checks its ring,
+//     and only then waits on the futex word (with the value it read before
+//     the re-check)
+//   - The writer publishes, then checks sleepers; only if someone is asleep
+//     does it bump the futex word and make the wake syscall
+//   - That check is not free: the seq_cst fence the protocol needs (an
+//     mfence on x86) and one load of a line that stays shared are paid on
+//     every ring(), even when every reader spins. Enable a doorbell only
+//     where some reader actually sleeps on it
+//
+// MEMORY ORDERING:
+//   - Reader: sleepers increment, seq_cst fence, re-check of the ring
+//   - Writer: publish, seq_cst fence, load of sleepers
+//   - Dekker style: either the writer sees the sleeper and wakes it, or the
+//     sleeper's re-check sees the new data and does not sleep. A wake that
+//     lands between the re-check and the futex wait changes the futex word,
+//     so the wait returns immediately instead of missing it
+//
+// Must be trivially constructible in place in a shared memory segment
+// (all zero = nobody asleep).
+//
+struct alignas(64) Doorbell {
+    std::atomic<uint32_t> sequence{0};  // Futex word, bumped on every wake
+    std::atomic<uint32_t> sleepers{0};  // Readers currently waiting
+
+    // Writer side: call after publishing; wakes every sleeping reader
+    void ring() noexcept {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleepers.load(std::memory_order_relaxed) == 0) {
+            return;
+        }
+        sequence.fetch_add(1, std::memory_order_release);
+#ifdef __linux__
+        // Not FUTEX_PRIVATE: waiters are in other processes
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&sequence), FUTEX_WAKE, INT_MAX,
+                nullptr, nullptr, 0);
+#endif
+    }
+
+    // Reader side: sleep until ring() is called or timeout passes, unless
+    // has_data() (evaluated after registering as a sleeper) is already true
+    // Spurious wake-ups are possible; callers re-check their ring anyway
+    template<typename Predicate>
+    void wait(Predicate&& has_data, std::chrono::nanoseconds timeout) noexcept {
+        sleepers.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        const uint32_t seen = sequence.load(std::memory_order_acquire);
+        if (!has_data()) {
+            timespec limit{static_cast<time_t>(timeout.count() / 1000000000),
+                           static_cast<long>(timeout.count() % 1000000000)};
+#ifdef __linux__
+            syscall(SYS_futex, reinterpret_cast<uint32_t*>(&sequence), FUTEX_WAIT, seen,
+                    &limit, nullptr, 0);
+#else
+            (void)seen;
+            nanosleep(&limit, nullptr);
+#endif
+        }
+
+        sleepers.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    // Number of readers currently asleep (for monitoring)
+    [[nodiscard]] uint32_t sleeping() const noexcept {
+        return sleepers.load(std::memory_order_relaxed);
+    }
+};
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+              "Doorbell futex word must be a plain 32-bit integer");
+
+} // namespace hft
@@ -4,15 +4,242 @@
 // FAST CLOCK IMPLEMENTATION
 // ============================================================================
 // This header implements a high-performance timestamp mechanism that avoids
-// syscall overhead in the hot path by using a background thread to periodically
-// update a cached timestamp.
+// syscall overhead in the hot path. It can either serve a cached timestamp
+// that a background thread refreshes periodically, or read the CPU timestamp
+// counter (TSC) directly and convert it to wall-clock nanoseconds.
 
 #include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <thread>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#endif
 
 namespace hft {
 
+// ============================================================================
+// CLOCK SOURCES
+// ============================================================================
+
+enum class ClockSource {
+    Cached,  // Background thread refreshes a cached value every 200ms
+    Tsc,     // CPU timestamp counter, calibrated against CLOCK_REALTIME
+    System   // clock_gettime(CLOCK_REALTIME) on every call (vDSO, no syscall)
+};
+
+inline const char* clock_source_name(ClockSource source) noexcept {
+    switch (source) {
+        case ClockSource::Tsc: return "tsc";
+        case ClockSource::System: return "system";
+        case ClockSource::Cached:
+        default: return "cached";
+    }
+}
+
+// Wall-clock nanoseconds since the Unix epoch, straight from the kernel
+inline int64_t realtime_ns() noexcept {
+    timespec ts{};
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+// Nanoseconds of CLOCK_MONOTONIC_RAW: the hardware clock, never stepped or
+// slewed, so intervals on it stay true when the wall clock is set
+inline int64_t monotonic_raw_ns() noexcept {
+    timespec ts{};
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+// Raw timestamp counter: CPU cycles at a constant rate on x86 (TSC), the
+// generic timer on ARM64. 0 where there is none
+inline uint64_t read_tsc() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    uint64_t ticks;
+    asm volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+    return ticks;
+#else
+    return 0;
+#endif
+}
+
+// True if the counter ticks at a constant rate that is synchronised across
+// cores and keeps running in deep sleep states ("invariant TSC"), so it can
+// stand in for a clock
+inline bool tsc_is_invariant() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned int eax, ebx, ecx, edx;
+    if (__get_cpuid_max(0x80000000, nullptr) < 0x80000007) {
+        return false;
+    }
+    __cpuid(0x80000007, eax, ebx, ecx, edx);
+    return (edx & (1u << 8)) != 0;
+#elif defined(__aarch64__)
+    return true;
+#else
+    return false;
+#endif
+}
+
+// ============================================================================
+// ClockTimebase
+// ============================================================================
+// The parameters that turn counter ticks into wall-clock nanoseconds:
+//   ns = base_ns + ((tsc - base_tsc) * mult >> 32)
+// with mult = ns per tick in 32.32 fixed point. Updated under a seqlock
+// (sequence odd while a write is in progress), so readers never block. Only
+// lock-free atomics: one can live in shared memory, letting every process on
+// the host convert with exactly the parameters of the clock that calibrated it
+// (see shared_timebase.hpp).
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "ClockTimebase must be lock-free to be shared");
+
+struct alignas(64) ClockTimebase {
+    std::atomic<uint32_t> sequence{0};
+    std::atomic<uint32_t> source{static_cast<uint32_t>(ClockSource::Tsc)};  // Tsc, or System without an invariant TSC
+    std::atomic<uint64_t> base_tsc{0};
+    std::atomic<int64_t> base_ns{0};
+    std::atomic<uint64_t> mult{0};  // 0 until calibrated
+
+    // Writer side (one writer at a time)
+    void store(uint64_t tsc, int64_t ns, uint64_t ns_per_tick_fixed) noexcept {
+        const uint32_t current = sequence.load(std::memory_order_relaxed);
+        sequence.store(current + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        base_tsc.store(tsc, std::memory_order_relaxed);
+        base_ns.store(ns, std::memory_order_relaxed);
+        mult.store(ns_per_tick_fixed, std::memory_order_relaxed);
+        sequence.store(current + 2, std::memory_order_release);
+    }
+
+    // Wall-clock nanoseconds at counter value tsc; CLOCK_REALTIME until the
+    // first calibration is stored
+    [[nodiscard]] int64_t to_ns(uint64_t tsc) const noexcept {
+        uint32_t current;
+        uint64_t base;
+        int64_t anchor_ns;
+        uint64_t scale;
+        do {
+            current = sequence.load(std::memory_order_acquire);
+            base = base_tsc.load(std::memory_order_relaxed);
+            anchor_ns = base_ns.load(std::memory_order_relaxed);
+            scale = mult.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+        } while ((current & 1) != 0 || sequence.load(std::memory_order_relaxed) != current);
+        if (scale == 0) {
+            return realtime_ns();
+        }
+        
+        // Counters on other cores may read a few ticks behind our base
+        const int64_t delta = static_cast<int64_t>(tsc - base);
+        const __int128 scaled = static_cast<__int128>(delta) * static_cast<__int128>(scale);
+        return anchor_ns + static_cast<int64_t>(scaled >> 32);
+    }
+
+    [[nodiscard]] ClockSource clock_source() const noexcept {
+        return static_cast<ClockSource>(source.load(std::memory_order_relaxed));
+    }
+
+    // Counter ticks per second as currently calibrated (0 before that)
+    [[nodiscard]] double frequency_hz() const noexcept {
+        const uint64_t scale = mult.load(std::memory_order_relaxed);
+        return scale == 0 ? 0.0 : 4294967296.0e9 / static_cast<double>(scale);
+    }
+
+    // Number of calibrations and drift corrections stored so far
+    [[nodiscard]] uint32_t updates() const noexcept {
+        return sequence.load(std::memory_order_relaxed) / 2;
+    }
+};
+
+// ============================================================================
+// TscDiscipline
+// ============================================================================
+// Keeps the ClockTimebase of a calibrating Tsc clock on the wall clock. The
+// counter rate is measured against CLOCK_MONOTONIC_RAW, which is never
+// stepped; only the offset is taken from CLOCK_REALTIME. A wall clock set by
+// NTP or by hand therefore moves the clock once, and never biases its rate.
+
+// The counter read against both kernel clocks at (about) the same instant
+struct TscSample {
+    uint64_t tsc = 0;
+    int64_t wall_ns = 0;  // CLOCK_REALTIME: what the clock must agree with
+    int64_t raw_ns = 0;   // CLOCK_MONOTONIC_RAW: what the rate is measured on
+
+    // Bracket both clock reads between two counter reads and keep the
+    // tightest of several tries
+    [[nodiscard]] static TscSample take() noexcept {
+        TscSample best;
+        uint64_t best_window = UINT64_MAX;
+        for (int i = 0; i < 16; ++i) {
+            const uint64_t before = read_tsc();
+            const int64_t wall = realtime_ns();
+            const int64_t raw = monotonic_raw_ns();
+            const uint64_t after = read_tsc();
+            if (after - before < best_window) {
+                best_window = after - before;
+                best = TscSample{before + (after - before) / 2, wall, raw};
+            }
+        }
+        return best;
+    }
+};
+
+class TscDiscipline {
+public:
+    // Larger errors against CLOCK_REALTIME are stepped instead of slewed
+    static constexpr int64_t max_step_ns = 1000000;
+
+private:
+    TscSample first_;
+
+    // Nanoseconds per tick in 32.32 fixed point
+    static uint64_t fixed_mult(double ns_per_tick) noexcept {
+        return static_cast<uint64_t>(ns_per_tick * 4294967296.0);
+    }
+
+    // Counter rate over everything since the first sample
+    [[nodiscard]] double ns_per_tick(const TscSample& sample) const noexcept {
+        return static_cast<double>(sample.raw_ns - first_.raw_ns) /
+               static_cast<double>(sample.tsc - first_.tsc);
+    }
+
+public:
+    // Measure the rate between two samples and anchor the timebase at the
+    // second one
+    void calibrate(ClockTimebase& timebase, const TscSample& first, const TscSample& second) noexcept {
+        first_ = first;
+        timebase.store(second.tsc, second.wall_ns, fixed_mult(ns_per_tick(second)));
+    }
+
+    // Re-measure the rate over the whole run and steer the timebase back onto
+    // CLOCK_REALTIME by the end of the next interval_ns. Errors over
+    // max_step_ns (the wall clock was set) are stepped, at the true rate
+    void correct(ClockTimebase& timebase, const TscSample& sample, int64_t interval_ns) noexcept {
+        if (sample.tsc <= first_.tsc || sample.raw_ns <= first_.raw_ns) {
+            return;
+        }
+
+        const double rate = ns_per_tick(sample);
+        const int64_t ours = timebase.to_ns(sample.tsc);
+        const int64_t error = sample.wall_ns - ours;
+        if (error > max_step_ns || error < -max_step_ns) {
+            timebase.store(sample.tsc, sample.wall_ns, fixed_mult(rate));
+            return;
+        }
+
+        // Continue from where the clock is now, running slightly fast or
+        // slow until the error is gone
+        const double interval = static_cast<double>(interval_ns);
+        timebase.store(sample.tsc, ours, fixed_mult(rate * (interval + static_cast<double>(error)) / interval));
+    }
+};
+
 // ============================================================================
 // FastClock Class
 // ============================================================================
@@ -20,10 +247,37 @@ namespace hft {
 // DESIGN RATIONALE:
 //   - In HFT systems, calling gettimeofday() or clock_gettime() in the hot path
 //     is too expensive due to syscall overhead
-//   - This class uses a background thread to periodically update a cached
-//     timestamp every 200ms
-//   - The hot path simply reads an atomic variable (no syscalls!)
-//   - Trade-off: Slightly less precision for much better performance
+//   - Cached (default): a background thread updates a cached timestamp every
+//     200ms and the hot path simply reads an atomic variable (no syscalls!)
+//   - Trade-off: Slightly less precision for much better performance. Too
+//     coarse to time anything shorter than the update interval
+//   - Tsc: now() reads the timestamp counter (~10-20 cycles) and converts it
+//     with a fixed-point multiply; nanosecond resolution, accurate enough to
+//     time a shared memory hop. Falls back to System without an invariant TSC
+//
+// TSC CALIBRATION:
+//   - At construction the counter is sampled against CLOCK_REALTIME and
+//     CLOCK_MONOTONIC_RAW twice, calibration_ms apart; each sample brackets
+//     the clock reads between two counter reads and keeps the tightest of
+//     several tries (TscSample)
+//   - ns = base_ns + ((tsc - base_tsc) * mult >> 32), mult = ns per tick in
+//     32.32 fixed point
+//   - Every 200ms the background thread re-measures the rate over the whole
+//     run so far against CLOCK_MONOTONIC_RAW and compares the clock with
+//     CLOCK_REALTIME (TscDiscipline). Small errors are slewed out over the
+//     next interval, so the clock never jumps backwards; errors over
+//     max_step_ns (e.g. the wall clock was stepped) are stepped. The rate
+//     never sees a step, so one step is followed by no others
+//   - Parameters live in a ClockTimebase, published with a seqlock, so now()
+//     never blocks
+//
+// SHARED TIMEBASE:
+//   - A Tsc clock can calibrate a ClockTimebase it is given instead of its
+//     own, e.g. one in shared memory. Other clocks constructed on that
+//     timebase follow it: they read the counter and convert with exactly the
+//     same parameters, and never calibrate or correct anything themselves
+//   - Timestamps taken in different processes then differ only by the time
+//     that passed between them, not by two calibrations' error
 //
 // MEMORY ORDERING:
 //   - Uses memory_order_relaxed for timestamp reads/writes since we don't need
@@ -37,20 +291,57 @@ namespace hft {
 //
 
 class FastClock {
+public:
+    // Time the counter is measured over at construction (Tsc only)
+    static constexpr int64_t calibration_ms = 10;
+
+    // Larger errors against CLOCK_REALTIME are stepped instead of slewed
+    static constexpr int64_t max_step_ns = TscDiscipline::max_step_ns;
+
 private:
+    // Which source now() reads; fixed at construction
+    ClockSource source_;
+    
     // Cached timestamp in nanoseconds since epoch
     // Using relaxed memory ordering since we only care about the timestamp value
     std::atomic<int64_t> cached_time_ns{0};
     
+    // TSC conversion parameters: our own unless given a shared timebase
+    ClockTimebase own_timebase_;
+    
+    // Timebase this clock calibrates and corrects (null when following one)
+    ClockTimebase* calibrated_{nullptr};
+    
+    // Timebase now() converts with
+    std::atomic<const ClockTimebase*> timebase_{&own_timebase_};
+    
+    // Calibration state, background thread only
+    TscDiscipline discipline_;
+    
     // Background thread that updates the cached timestamp
     std::thread update_thread;
     
     // Flag to control the background thread lifecycle
     std::atomic<bool> running{false};
     
-    // Background thread function that updates cached_time_ns every 200ms
+    // Measure the counter rate and anchor it to the wall clock
+    void calibrate_tsc() noexcept {
+        const TscSample first = TscSample::take();
+        std::this_thread::sleep_for(std::chrono::milliseconds(calibration_ms));
+        discipline_.calibrate(*calibrated_, first, TscSample::take());
+    }
+    
+    // Background thread function: corrects TSC drift (calibrating Tsc
+    // clocks) or refreshes cached_time_ns (everything else) every 200ms
     void update_loop() {
         while (running.load(std::memory_order_relaxed)) {
+            if (calibrated_ != nullptr) {
+                discipline_.correct(*calibrated_, TscSample::take(),
+                                    static_cast<int64_t>(get_update_frequency_ms()) * 1000000);
+                std::this_thread::sleep_for(std::chrono::milliseconds(get_update_frequency_ms()));
+                continue;
+            }
+            
             // Get current time using high_resolution_clock
             auto now_time = std::chrono::high_resolution_clock::now();
             
@@ -71,7 +362,31 @@ public:
     // ========================================================================
     // CONSTRUCTOR
     // ========================================================================
-    FastClock() {
+    // shared: calibrate (and keep correcting) this timebase instead of our
+    // own, e.g. one in shared memory; it must outlive the clock
+    explicit FastClock(ClockSource source = ClockSource::Cached, ClockTimebase* shared = nullptr)
+        : source_(source == ClockSource::Tsc && !tsc_is_invariant() ? ClockSource::System : source) {
+        if (source_ == ClockSource::Tsc) {
+            calibrated_ = shared != nullptr ? shared : &own_timebase_;
+            calibrated_->source.store(static_cast<uint32_t>(ClockSource::Tsc), std::memory_order_relaxed);
+            timebase_.store(calibrated_, std::memory_order_relaxed);
+            calibrate_tsc();
+        } else if (shared != nullptr) {
+            shared->source.store(static_cast<uint32_t>(source_), std::memory_order_relaxed);
+        }
+        start();
+    }
+    
+    // Follow a timebase another clock calibrates: same source, same
+    // conversion, no calibration of our own
+    explicit FastClock(const ClockTimebase& shared)
+        : source_(ClockSource::System) {
+        follow(shared);
+        start();
+    }
+
+private:
+    void start() {
         // Initialize with current time
         auto now_time = std::chrono::high_resolution_clock::now();
         auto ns_since_epoch = now_time.time_since_epoch();
@@ -83,6 +398,8 @@ public:
         update_thread = std::thread(&FastClock::update_loop, this);
     }
 
+public:
+
     // ========================================================================
     // DESTRUCTOR
     // ========================================================================
@@ -110,11 +427,52 @@ public:
     // ========================================================================
     
     // Get current timestamp in nanoseconds since epoch
-    // This is the HOT PATH function - no syscalls, just atomic read!
+    // This is the HOT PATH function - no syscalls: an atomic read (Cached),
+    // a counter read and a multiply (Tsc), or a vDSO call (System)
     [[nodiscard]] int64_t now() const noexcept {
+        if (source_ == ClockSource::Tsc) {
+            return timebase_.load(std::memory_order_relaxed)->to_ns(read_tsc());
+        }
+        if (source_ == ClockSource::System) {
+            return realtime_ns();
+        }
         return cached_time_ns.load(std::memory_order_relaxed);
     }
     
+    // Source now() actually reads (Tsc falls back to System without an
+    // invariant TSC)
+    [[nodiscard]] ClockSource source() const noexcept {
+        return source_;
+    }
+    
+    // Counter ticks per second as currently calibrated (Tsc only, else 0)
+    [[nodiscard]] double tsc_frequency_hz() const noexcept {
+        return source_ == ClockSource::Tsc ? timebase_.load(std::memory_order_relaxed)->frequency_hz() : 0.0;
+    }
+    
+    // Switch a following clock to another timebase, e.g. the one a restarted
+    // publisher created. Call from the thread that reads now(); the old
+    // timebase must stay mapped until this returns. No-op on a clock that
+    // calibrates its own
+    void follow(const ClockTimebase& shared) noexcept {
+        if (calibrated_ != nullptr) {
+            return;
+        }
+        source_ = shared.clock_source() == ClockSource::System || !tsc_is_invariant()
+                      ? ClockSource::System : ClockSource::Tsc;
+        timebase_.store(&shared, std::memory_order_relaxed);
+    }
+    
+    // True if this clock converts with a timebase another clock calibrates
+    [[nodiscard]] bool following() const noexcept {
+        return calibrated_ == nullptr && timebase_.load(std::memory_order_relaxed) != &own_timebase_;
+    }
+    
+    // Conversion parameters now() uses (Tsc)
+    [[nodiscard]] const ClockTimebase& timebase() const noexcept {
+        return *timebase_.load(std::memory_order_relaxed);
+    }
+    
     // Check if the background thread is running
     [[nodiscard]] bool is_running() const noexcept {
         return running.load(std::memory_order_relaxed);
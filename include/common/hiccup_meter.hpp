@@ -0,0 +1,232 @@
+#pragma once
+
+// ============================================================================
+// HICCUP METER (OS JITTER DETECTOR)
+// ============================================================================
+// This header measures the stalls the platform inflicts on a thread that
+// never blocks: interrupts, timer ticks, migrations, THP compaction, SMIs.
+// None of them show up in a profile of our code, but each one holds up
+// whatever runs on that core. The meter thread does nothing but read the
+// clock in a tight loop. Any gap between two consecutive reads longer than
+// the threshold is time the thread did not run, and is recorded:
+//   - into a histogram of gap lengths (the platform's own latency profile)
+//   - as a timestamped Hiccup, so a latency spike seen by a consumer can be
+//     matched against a stall measured at the same time
+//
+// Pin the meter to a core set up like the consumer's (same isolation, same
+// interrupt routing), or to the consumer's hyperthread sibling. A meter on
+// the consumer's own core would simply take turns with it.
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <optional>
+#include <thread>
+#include <utility>
+#include "fast_clock.hpp"
+#include "latency_histogram.hpp"
+#include "performance_utils.hpp"
+#include "ring_buffer.hpp"
+
+namespace hft {
+
+// ============================================================================
+// CONSTANTS
+// ============================================================================
+
+// Gaps up to this long are the loop itself (clock reads, a cache miss);
+// longer ones are hiccups
+constexpr int64_t DEFAULT_HICCUP_THRESHOLD_NS = 5000;
+
+// Hiccups buffered for the consumer between two drains
+constexpr size_t HICCUP_QUEUE_CAPACITY = 4096;
+
+// ============================================================================
+// Hiccup
+// ============================================================================
+// One stall: the meter's thread did not run from start_ns to end_ns()
+// Stamped on the FastClock epoch (CLOCK_REALTIME), like message timestamps
+struct Hiccup {
+    int64_t start_ns;
+    int64_t gap_ns;
+
+    [[nodiscard]] int64_t end_ns() const noexcept { return start_ns + gap_ns; }
+
+    // Stall overlaps the interval [from_ns, to_ns]
+    [[nodiscard]] bool overlaps(int64_t from_ns, int64_t to_ns) const noexcept {
+        return start_ns <= to_ns && end_ns() >= from_ns;
+    }
+};
+
+// ============================================================================
+// HiccupMeter
+// ============================================================================
+//
+// THREADS:
+//   - The constructor starts the meter thread, pins it (cpu >= 0) and spins
+//     until stop() or destruction
+//   - histogram() may be read (merge() into a LatencyHistogram) from any
+//     thread while the meter records
+//   - drain() must be called from one thread only: the hiccup queue is SPSC.
+//     When nobody drains, the queue fills and further hiccups are counted in
+//     dropped() but still recorded in the histogram
+//
+// CLOCK:
+//   - The meter calibrates its own Tsc FastClock rather than sharing the
+//     consumer's, so a consumer switching timebases (publisher restart)
+//     never races the meter. Both are on the CLOCK_REALTIME epoch, so their
+//     stamps agree to within the calibration error, far below a hiccup
+//
+class HiccupMeter {
+private:
+    FastClock clock_{ClockSource::Tsc};
+    const int cpu_;
+    const int64_t threshold_ns_;
+
+    SharedLatencyHistogram histogram_;
+    SpscRingBuffer<Hiccup, HICCUP_QUEUE_CAPACITY> hiccups_;
+    RelaxedCounter dropped_{0};
+    RelaxedCounter samples_{0};
+    std::atomic<bool> pinned_{false};
+    std::atomic<bool> running_{true};
+    std::thread thread_;
+
+    void run() noexcept {
+        if (cpu_ >= 0) {
+            pinned_.store(CpuAffinity::set_thread_affinity(cpu_), std::memory_order_relaxed);
+        }
+        int64_t previous = clock_.now();
+        uint64_t samples = 0;
+        while (running_.load(std::memory_order_relaxed)) {
+            const int64_t now = clock_.now();
+            const int64_t gap = now - previous;
+            if (gap > threshold_ns_) {
+                histogram_.record(gap);
+                if (!hiccups_.try_write(Hiccup{previous, gap})) {
+                    dropped_ += 1;
+                }
+            }
+            previous = now;
+            // Publish the sample count now and then; a store per read would
+            // lengthen the loop we are timing
+            if ((++samples & 0xFFF) == 0) {
+                samples_ = samples;
+            }
+        }
+        samples_ = samples;
+    }
+
+public:
+    // ========================================================================
+    // CONSTRUCTOR / DESTRUCTOR
+    // ========================================================================
+    // Start metering on the given core (-1 = wherever the scheduler puts it)
+    explicit HiccupMeter(int cpu = -1, int64_t threshold_ns = DEFAULT_HICCUP_THRESHOLD_NS)
+        : cpu_(cpu), threshold_ns_(threshold_ns), thread_([this] { run(); }) {}
+
+    ~HiccupMeter() {
+        stop();
+    }
+
+    HiccupMeter(const HiccupMeter&) = delete;
+    HiccupMeter& operator=(const HiccupMeter&) = delete;
+
+    void stop() {
+        if (thread_.joinable()) {
+            running_.store(false, std::memory_order_relaxed);
+            thread_.join();
+        }
+    }
+
+    // ========================================================================
+    // CONFIGURATION FROM THE ENVIRONMENT
+    // ========================================================================
+
+    // Core to meter when asked for with HFT_HICCUP_CPU=<core>
+    [[nodiscard]] static std::optional<int> requested_cpu() noexcept {
+        const char* value = std::getenv("HFT_HICCUP_CPU");
+        if (value == nullptr || *value == '\0') {
+            return std::nullopt;
+        }
+        char* end = nullptr;
+        const long cpu = std::strtol(value, &end, 10);
+        if (*end != '\0' || cpu < -1) {
+            return std::nullopt;
+        }
+        return static_cast<int>(cpu);
+    }
+
+    // Threshold from HFT_HICCUP_US=<microseconds>, else the default
+    [[nodiscard]] static int64_t requested_threshold_ns() noexcept {
+        const char* value = std::getenv("HFT_HICCUP_US");
+        const double us = value != nullptr ? std::strtod(value, nullptr) : 0.0;
+        return us > 0.0 ? static_cast<int64_t>(us * 1000.0) : DEFAULT_HICCUP_THRESHOLD_NS;
+    }
+
+    // ========================================================================
+    // RESULTS
+    // ========================================================================
+
+    // Lengths of every hiccup so far
+    [[nodiscard]] const SharedLatencyHistogram& histogram() const noexcept {
+        return histogram_;
+    }
+
+    // Hand the hiccups recorded since the last drain to callback(const Hiccup&)
+    // Returns how many; single consumer only
+    template<typename Callback>
+    size_t drain(Callback&& callback) {
+        return hiccups_.consume_all(std::forward<Callback>(callback));
+    }
+
+    // Hiccups not queued because nobody drained
+    [[nodiscard]] uint64_t dropped() const noexcept { return dropped_; }
+
+    // Clock reads so far (published every 4096)
+    [[nodiscard]] uint64_t samples() const noexcept { return samples_; }
+
+    [[nodiscard]] int cpu() const noexcept { return cpu_; }
+    [[nodiscard]] bool pinned() const noexcept { return pinned_.load(std::memory_order_relaxed); }
+    [[nodiscard]] int64_t threshold_ns() const noexcept { return threshold_ns_; }
+    [[nodiscard]] const FastClock& clock() const noexcept { return clock_; }
+};
+
+// ============================================================================
+// HiccupLog
+// ============================================================================
+// The last Capacity hiccups drained from a meter, kept by the consumer so a
+// latency spike can be looked up against them after the fact
+template<size_t Capacity = 256>
+class HiccupLog {
+private:
+    std::array<Hiccup, Capacity> recent_{};
+    size_t next_ = 0;
+    size_t size_ = 0;
+
+public:
+    void add(const Hiccup& hiccup) noexcept {
+        recent_[next_] = hiccup;
+        next_ = (next_ + 1) % Capacity;
+        if (size_ < Capacity) {
+            ++size_;
+        }
+    }
+
+    // Longest hiccup overlapping [from_ns, to_ns], if any
+    [[nodiscard]] std::optional<Hiccup> longest_overlapping(int64_t from_ns, int64_t to_ns) const noexcept {
+        std::optional<Hiccup> longest;
+        for (size_t i = 0; i < size_; ++i) {
+            const Hiccup& hiccup = recent_[i];
+            if (hiccup.overlaps(from_ns, to_ns) && (!longest || hiccup.gap_ns > longest->gap_ns)) {
+                longest = hiccup;
+            }
+        }
+        return longest;
+    }
+
+    [[nodiscard]] size_t size() const noexcept { return size_; }
+};
+
+} // namespace hft
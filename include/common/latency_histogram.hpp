@@ -0,0 +1,261 @@
+#pragma once
+
+// ============================================================================
+// LATENCY HISTOGRAM
+// ============================================================================
+// This header implements a fixed-size, allocation-free latency histogram in
+// the style of HdrHistogram. Average, min and max hide the tail; a histogram
+// keeps every sample's bucket, so any percentile can be read back later and
+// histograms from different intervals or processes can be added together.
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace hft {
+
+// ============================================================================
+// RelaxedCounter
+// ============================================================================
+// A 64-bit counter with exactly one writer that other threads or processes
+// may read at any time. Updates are a relaxed load and store, not a locked
+// read-modify-write: nothing but the writer changes it, so nothing is lost,
+// and readers see some recent value. Lock-free, so it can live in shared
+// memory (see metrics.hpp).
+class RelaxedCounter {
+private:
+    std::atomic<uint64_t> value_;
+
+public:
+    constexpr RelaxedCounter(uint64_t value = 0) noexcept : value_(value) {}
+
+    RelaxedCounter& operator+=(uint64_t n) noexcept {
+        value_.store(value_.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+        return *this;
+    }
+
+    RelaxedCounter& operator=(uint64_t value) noexcept {
+        value_.store(value, std::memory_order_relaxed);
+        return *this;
+    }
+
+    operator uint64_t() const noexcept {
+        return value_.load(std::memory_order_relaxed);
+    }
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "RelaxedCounter must be lock-free to be shared");
+
+// ============================================================================
+// LatencyHistogram
+// ============================================================================
+//
+// BUCKETING (log-linear):
+//   - Values below 128 get a bucket each (exact)
+//   - Above that, every power-of-two range [2^k, 2^(k+1)) is split into 64
+//     equal sub-buckets, so a value is known to within 1/64 (~1.6%) of
+//     itself: 1.000us vs 1.015us, 1.00ms vs 1.01ms
+//   - index = 64 * shift + (value >> shift), where shift drops all but the
+//     top 7 significant bits. A count-leading-zeros and a shift; no loops,
+//     no floating point, constant time
+//   - Values up to 2^40 ns (~18 minutes) are bucketed; larger ones are
+//     clamped into the last bucket (max() stays exact)
+//
+// MEMORY:
+//   - 2240 64-bit counters (~17.5KB) inline in the object; nothing is
+//     allocated, ever. Copying the object is a snapshot
+//   - Not thread-safe: record from one thread, and copy or merge() between
+//     reporting intervals
+//   - With Counter = RelaxedCounter (SharedLatencyHistogram) one writer can
+//     record while other processes merge() it into a LatencyHistogram to
+//     read it; such a snapshot may be a few samples out of step
+//
+template<typename Counter>
+class BasicLatencyHistogram {
+    template<typename> friend class BasicLatencyHistogram;
+
+public:
+    // Significant bits kept per value (top bit included)
+    static constexpr unsigned precision_bits = 7;
+
+    // Largest value bucketed without clamping: 2^max_value_bits - 1
+    static constexpr unsigned max_value_bits = 40;
+
+    static constexpr uint64_t sub_bucket_count = uint64_t{1} << precision_bits;  // 128
+    static constexpr uint64_t sub_bucket_half = sub_bucket_count / 2;            // 64
+    static constexpr uint64_t max_trackable = (uint64_t{1} << max_value_bits) - 1;
+    static constexpr size_t bucket_count =
+        sub_bucket_half * (max_value_bits - precision_bits + 1) + sub_bucket_half;  // 2240
+
+private:
+    std::array<Counter, bucket_count> counts_{};
+    Counter total_count_{0};
+    Counter min_{UINT64_MAX};
+    Counter max_{0};
+    // Sum for the mean; 2^64 ns is ~584 years of latency, enough headroom
+    Counter sum_{0};
+
+public:
+    // Bucket a value falls into
+    [[nodiscard]] static constexpr size_t index_of(uint64_t value) noexcept {
+        if (value > max_trackable) {
+            value = max_trackable;
+        }
+        if (value < sub_bucket_count) {
+            return static_cast<size_t>(value);
+        }
+        const unsigned msb = 63u - static_cast<unsigned>(__builtin_clzll(value));
+        const unsigned shift = msb - (precision_bits - 1);
+        return static_cast<size_t>(sub_bucket_half * shift + (value >> shift));
+    }
+
+    // Smallest and largest value that land in a bucket
+    [[nodiscard]] static constexpr uint64_t lowest_in(size_t index) noexcept {
+        if (index < sub_bucket_count) {
+            return index;
+        }
+        const uint64_t shift = index / sub_bucket_half - 1;
+        return (index - sub_bucket_half * shift) << shift;
+    }
+
+    [[nodiscard]] static constexpr uint64_t highest_in(size_t index) noexcept {
+        if (index < sub_bucket_count) {
+            return index;
+        }
+        const uint64_t shift = index / sub_bucket_half - 1;
+        return ((index - sub_bucket_half * shift + 1) << shift) - 1;
+    }
+
+    // Record one latency; negative values (clock skew between the stamps)
+    // count as 0
+    void record(int64_t value_ns) noexcept {
+        record(value_ns, 1);
+    }
+
+    // Record the same latency count times
+    void record(int64_t value_ns, uint64_t count) noexcept {
+        const uint64_t value = value_ns < 0 ? 0 : static_cast<uint64_t>(value_ns);
+        counts_[index_of(value)] += count;
+        total_count_ += count;
+        sum_ += value * count;
+        if (value < static_cast<uint64_t>(min_)) {
+            min_ = value;
+        }
+        if (value > static_cast<uint64_t>(max_)) {
+            max_ = value;
+        }
+    }
+
+    // Add another histogram's samples to this one, e.g. fold an interval
+    // into a running total, combine histograms from several readers, or
+    // snapshot a shared one
+    template<typename OtherCounter>
+    void merge(const BasicLatencyHistogram<OtherCounter>& other) noexcept {
+        const uint64_t other_count = other.total_count_;
+        if (other_count == 0) {
+            return;
+        }
+        for (size_t i = 0; i < bucket_count; ++i) {
+            counts_[i] += static_cast<uint64_t>(other.counts_[i]);
+        }
+        total_count_ += other_count;
+        sum_ += static_cast<uint64_t>(other.sum_);
+        const uint64_t other_min = other.min_;
+        const uint64_t other_max = other.max_;
+        if (other_min < static_cast<uint64_t>(min_)) {
+            min_ = other_min;
+        }
+        if (other_max > static_cast<uint64_t>(max_)) {
+            max_ = other_max;
+        }
+    }
+
+    void reset() noexcept {
+        for (Counter& count : counts_) {
+            count = 0;
+        }
+        total_count_ = 0;
+        min_ = UINT64_MAX;
+        max_ = 0;
+        sum_ = 0;
+    }
+
+    // Value at or below which the given percentage (0-100) of samples fall,
+    // reported as the highest value of its bucket (never above max());
+    // 0 for an empty histogram
+    [[nodiscard]] int64_t value_at_percentile(double percentile) const noexcept {
+        const uint64_t total = total_count_;
+        const uint64_t max = max_;
+        if (total == 0) {
+            return 0;
+        }
+        if (percentile >= 100.0) {
+            return static_cast<int64_t>(max);
+        }
+        const double wanted = percentile <= 0.0 ? 1.0 : percentile / 100.0 * static_cast<double>(total);
+        uint64_t target = static_cast<uint64_t>(wanted);
+        if (static_cast<double>(target) < wanted || target == 0) {
+            ++target;
+        }
+
+        uint64_t seen = 0;
+        for (size_t i = 0; i < bucket_count; ++i) {
+            seen += counts_[i];
+            if (seen >= target) {
+                const uint64_t highest = highest_in(i);
+                return static_cast<int64_t>(highest < max ? highest : max);
+            }
+        }
+        return static_cast<int64_t>(max);
+    }
+
+    [[nodiscard]] uint64_t count() const noexcept { return total_count_; }
+    [[nodiscard]] bool empty() const noexcept { return count() == 0; }
+    [[nodiscard]] int64_t min() const noexcept { return count() == 0 ? 0 : static_cast<int64_t>(static_cast<uint64_t>(min_)); }
+    [[nodiscard]] int64_t max() const noexcept { return static_cast<int64_t>(static_cast<uint64_t>(max_)); }
+
+    [[nodiscard]] double mean() const noexcept {
+        const uint64_t total = total_count_;
+        return total == 0 ? 0.0 : static_cast<double>(static_cast<uint64_t>(sum_)) / static_cast<double>(total);
+    }
+
+    // Samples recorded in one bucket
+    [[nodiscard]] uint64_t count_at_index(size_t index) const noexcept {
+        return index < bucket_count ? static_cast<uint64_t>(counts_[index]) : 0;
+    }
+};
+
+// Single-threaded histogram; copies are snapshots
+using LatencyHistogram = BasicLatencyHistogram<uint64_t>;
+
+// One writer, readers anywhere (e.g. in a shared memory segment)
+using SharedLatencyHistogram = BasicLatencyHistogram<RelaxedCounter>;
+
+// ============================================================================
+// LatencySummary
+// ============================================================================
+// The percentiles both consumers report, read off a histogram in one call
+struct LatencySummary {
+    uint64_t count;
+    double mean_ns;
+    int64_t min_ns;
+    int64_t p50_ns;
+    int64_t p90_ns;
+    int64_t p99_ns;
+    int64_t p999_ns;
+    int64_t p9999_ns;
+    int64_t max_ns;
+
+    static LatencySummary of(const LatencyHistogram& histogram) noexcept {
+        return LatencySummary{histogram.count(), histogram.mean(), histogram.min(),
+                              histogram.value_at_percentile(50.0),
+                              histogram.value_at_percentile(90.0),
+                              histogram.value_at_percentile(99.0),
+                              histogram.value_at_percentile(99.9),
+                              histogram.value_at_percentile(99.99),
+                              histogram.max()};
+    }
+};
+
+} // namespace hft
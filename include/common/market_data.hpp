@@ -7,6 +7,9 @@
 // Every message flowing through our system (TCP and Shared Memory) uses this
 // structure.
 
+#include <algorithm>         // For std::min / std::max
+#include <array>             // For std::array
+#include <cstddef>           // For size_t
 #include <cstdint>           // For int64_t (fixed-size integer types)
 #include <cstring>           // For strncpy (safe string copy)
 #include <nlohmann/json.hpp> // For JSON serialization
@@ -25,6 +28,46 @@ namespace hft {
 //   3. Fixed size = no heap allocation = faster!
 constexpr size_t INSTRUMENT_MAX_LEN = 16;
 
+// Schema name and version under which MarketData streams are registered
+// (see channel_registry.hpp). Bump the version whenever the layout changes
+//   1: instrument, bid, ask, timestamp_ns
+//   2: sequence added
+//   3: stage_offset_ns (pipeline stage stamps) in the padding
+inline constexpr const char* MARKET_DATA_SCHEMA = "MarketData";
+constexpr uint32_t MARKET_DATA_SCHEMA_VERSION = 3;
+
+// ============================================================================
+// PIPELINE STAGES
+// ============================================================================
+// Points along the path from generation to a consumer at which a message can
+// be timestamped, in path order. Generated is timestamp_ns itself; the
+// publisher-side stages up to Written travel inside the message (see
+// MarketData::stamp()), the consumer-side ones are recorded locally
+enum class Stage : uint8_t {
+  Generated,   // Tick created (timestamp_ns)
+  Enqueued,    // Committed to the shared memory ring
+  Serialized,  // JSON built for TCP
+  Written,     // Handed to a TCP socket
+  Dequeued,    // Taken off the ring, or read off the socket, by a consumer
+  Parsed,      // Decoded from JSON by a TCP consumer
+  Count
+};
+
+// Stages stamped by the publisher and carried in MarketData::stage_offset_ns
+constexpr size_t CARRIED_STAGES = 3;
+
+inline const char* stage_name(Stage stage) noexcept {
+  switch (stage) {
+    case Stage::Generated: return "generated";
+    case Stage::Enqueued: return "enqueued";
+    case Stage::Serialized: return "serialized";
+    case Stage::Written: return "written";
+    case Stage::Dequeued: return "dequeued";
+    case Stage::Parsed: return "parsed";
+    default: return "unknown";
+  }
+}
+
 // ============================================================================
 // MarketData Structure
 // ============================================================================
@@ -37,7 +80,9 @@ constexpr size_t INSTRUMENT_MAX_LEN = 16;
 //   16        8       bid             (double)
 //   24        8       ask             (double)
 //   32        8       timestamp_ns    (int64_t)
-//   40        24      padding         (explicit padding to 64 bytes)
+//   40        8       sequence        (uint64_t)
+//   48        12      stage_offset_ns (uint32_t[3])
+//   60        4       padding         (explicit padding to 64 bytes)
 //   ------
 //   Total:    64 bytes (cache-line aligned)
 //
@@ -61,6 +106,22 @@ constexpr size_t INSTRUMENT_MAX_LEN = 16;
 //   - In production, some systems use fixed-point integers for speed
 //     (e.g., price * 10000 stored as int64_t)
 //
+// WHY A SEQUENCE NUMBER?
+//   - The publisher stamps every message with a monotonically increasing
+//     64-bit sequence, the same on TCP and shared memory
+//   - A consumer that sees sequence N followed by N + 5 knows exactly that
+//     4 messages were lost, and can tell a gap from a quiet market
+//   - A reconnecting consumer knows the last sequence it processed
+//
+// WHY STAGE OFFSETS?
+//   - One end-to-end latency cannot say whether a regression is in
+//     generation, transport or parsing. The publisher can stamp the message
+//     as it passes each of its stages (stamp()); the consumer adds its own
+//     and StageBreakdown reports what each stage contributed
+//   - Offsets from timestamp_ns fit 32 bits (up to ~4.3s), so three stages
+//     fit in what used to be padding and the message stays one cache line
+//   - 0 means the stage was not stamped; stamping is optional
+//
 
 struct alignas(64) MarketData {
   // Instrument symbol (e.g., "RELIANCE", "AAPL", "GOOG")
@@ -78,9 +139,16 @@ struct alignas(64) MarketData {
   // We use nanoseconds because in HFT, microseconds aren't precise enough
   int64_t timestamp_ns;
 
+  // Publisher-assigned sequence number (0, 1, 2, ... per publisher run)
+  uint64_t sequence;
+
+  // Nanoseconds from timestamp_ns to the Enqueued, Serialized and Written
+  // stages; 0 = not stamped
+  uint32_t stage_offset_ns[CARRIED_STAGES];
+
   // Explicit padding to ensure 64-byte alignment
-  // 64 - (16 + 8 + 8 + 8) = 24 bytes of padding needed
-  char padding[24];
+  // 64 - (16 + 8 + 8 + 8 + 8 + 12) = 4 bytes of padding needed
+  char padding[4];
 
   // ========================================================================
   // CONSTRUCTORS
@@ -88,25 +156,56 @@ struct alignas(64) MarketData {
 
   // Default constructor - zero-initialize everything
   // This is important! Uninitialized memory can cause undefined behavior
-  MarketData() : bid(0.0), ask(0.0), timestamp_ns(0) {
+  MarketData() : bid(0.0), ask(0.0), timestamp_ns(0), sequence(0) {
     // Fill instrument with zeros (null bytes)
     std::memset(instrument, 0, INSTRUMENT_MAX_LEN);
-    // Initialize padding to zero for consistent memory layout
+    // Initialize stage stamps and padding to zero for consistent memory layout
+    std::memset(stage_offset_ns, 0, sizeof(stage_offset_ns));
     std::memset(padding, 0, sizeof(padding));
   }
 
   // Parameterized constructor for convenience
   // We use const char* instead of std::string to avoid heap allocation
-  MarketData(const char *inst, double b, double a, int64_t ts)
-      : bid(b), ask(a), timestamp_ns(ts) {
+  MarketData(const char *inst, double b, double a, int64_t ts, uint64_t seq = 0)
+      : bid(b), ask(a), timestamp_ns(ts), sequence(seq) {
     // strncpy copies at most N-1 characters and null-terminates
     // This prevents buffer overflow if 'inst' is too long
     std::strncpy(instrument, inst, INSTRUMENT_MAX_LEN - 1);
     instrument[INSTRUMENT_MAX_LEN - 1] = '\0'; // Ensure null termination
-    // Initialize padding to zero for consistent memory layout
+    // Initialize stage stamps and padding to zero for consistent memory layout
+    std::memset(stage_offset_ns, 0, sizeof(stage_offset_ns));
     std::memset(padding, 0, sizeof(padding));
   }
 
+  // ========================================================================
+  // STAGE STAMPS
+  // ========================================================================
+
+  // Record that the message reached a publisher-side stage (Enqueued,
+  // Serialized or Written) at now_ns; other stages are ignored
+  void stamp(Stage stage, int64_t now_ns) noexcept {
+    const size_t index = static_cast<size_t>(stage) - 1;
+    if (index >= CARRIED_STAGES) {
+      return;
+    }
+    const int64_t offset = now_ns - timestamp_ns;
+    stage_offset_ns[index] = offset <= 0 ? 1u
+                           : offset >= int64_t{UINT32_MAX} ? UINT32_MAX
+                           : static_cast<uint32_t>(offset);
+  }
+
+  // When the message reached a stage carried in it, or 0 if not stamped
+  [[nodiscard]] int64_t stage_ns(Stage stage) const noexcept {
+    if (stage == Stage::Generated) {
+      return timestamp_ns;
+    }
+    const size_t index = static_cast<size_t>(stage) - 1;
+    if (index >= CARRIED_STAGES || stage_offset_ns[index] == 0) {
+      return 0;
+    }
+    return timestamp_ns + stage_offset_ns[index];
+  }
+
   // ========================================================================
   // JSON SERIALIZATION
   // ========================================================================
@@ -117,7 +216,9 @@ struct alignas(64) MarketData {
   //   "instrument": "RELIANCE",
   //   "bid": 2850.25,
   //   "ask": 2850.75,
-  //   "timestamp_ns": 1234567890123
+  //   "timestamp_ns": 1234567890123,
+  //   "sequence": 42,
+  //   "enqueued_ns": 1234567890456     (stage stamps, only if stamped)
   // }
   //
   // NOTE: JSON is human-readable but SLOW compared to binary formats.
@@ -129,9 +230,31 @@ struct alignas(64) MarketData {
     j["bid"] = bid;
     j["ask"] = ask;
     j["timestamp_ns"] = timestamp_ns;
+    j["sequence"] = sequence;
+    for (size_t i = 1; i <= CARRIED_STAGES; ++i) {
+      const Stage stage = static_cast<Stage>(i);
+      if (stage_ns(stage) != 0) {
+        j[std::string(stage_name(stage)) + "_ns"] = stage_ns(stage);
+      }
+    }
     return j.dump(); // dump() converts to string
   }
 
+  // Stamp a stage on JSON already made by to_json(), e.g. Serialized right
+  // after to_json() returns or Written right before the socket write. Appends
+  // a field instead of serializing again
+  static void stamp_json(std::string &json, Stage stage, int64_t now_ns) {
+    if (json.empty() || json.back() != '}') {
+      return;
+    }
+    json.pop_back();
+    json += ",\"";
+    json += stage_name(stage);
+    json += "_ns\":";
+    json += std::to_string(now_ns);
+    json += '}';
+  }
+
   // Parse JSON string back into MarketData
   // Returns true on success, false on failure
   // We return bool instead of throwing because exceptions are SLOW
@@ -148,6 +271,19 @@ struct alignas(64) MarketData {
       out.ask = j["ask"].get<double>();
       out.timestamp_ns = j["timestamp_ns"].get<int64_t>();
 
+      // Optional so messages from older publishers still parse
+      out.sequence = j.value("sequence", uint64_t{0});
+
+      // Stage stamps, if the publisher recorded any
+      std::memset(out.stage_offset_ns, 0, sizeof(out.stage_offset_ns));
+      for (size_t i = 1; i <= CARRIED_STAGES; ++i) {
+        const Stage stage = static_cast<Stage>(i);
+        const int64_t at = j.value(std::string(stage_name(stage)) + "_ns", int64_t{0});
+        if (at != 0) {
+          out.stamp(stage, at);
+        }
+      }
+
       return true;
     } catch (...) {
       // Any parse error returns false
@@ -156,6 +292,130 @@ struct alignas(64) MarketData {
   }
 };
 
+// ============================================================================
+// SequenceTracker
+// ============================================================================
+// Consumer-side bookkeeping of MarketData::sequence. Feed it every message
+// in arrival order; it tells gaps (lost messages) apart from a quiet market
+// and remembers the last sequence processed, e.g. to report where a
+// reconnecting consumer is resuming from.
+class SequenceTracker {
+private:
+  uint64_t expected_ = 0; // Sequence we expect next
+  bool started_ = false;  // Seen at least one message
+  uint64_t gaps_ = 0;     // Number of discontinuities
+  uint64_t missing_ = 0;  // Messages skipped over by those gaps
+  uint64_t resets_ = 0;   // Sequence went backwards (publisher restarted)
+
+public:
+  // Record a message; returns how many messages are missing right before it
+  // (0 when it is the expected next one, or the first message seen)
+  uint64_t on_message(uint64_t sequence) noexcept {
+    uint64_t missing = 0;
+    if (started_ && sequence != expected_) {
+      if (sequence > expected_) {
+        missing = sequence - expected_;
+        ++gaps_;
+        missing_ += missing;
+      } else {
+        ++resets_; // New publisher run: start counting again from here
+      }
+    }
+    started_ = true;
+    expected_ = sequence + 1;
+    return missing;
+  }
+
+  [[nodiscard]] bool has_last() const noexcept { return started_; }
+  [[nodiscard]] uint64_t last() const noexcept { return expected_ - 1; }
+  [[nodiscard]] uint64_t gaps() const noexcept { return gaps_; }
+  [[nodiscard]] uint64_t missing() const noexcept { return missing_; }
+  [[nodiscard]] uint64_t resets() const noexcept { return resets_; }
+};
+
+// ============================================================================
+// StageBreakdown
+// ============================================================================
+// Consumer-side report of where the latency goes. Feed it every message with
+// the consumer's own stage stamps; for each stage it keeps the time since the
+// previous stage that was stamped on the same message (count, mean, min, max),
+// so the per-stage means add up to the end-to-end latency. Stages no message
+// was stamped at stay empty.
+class StageBreakdown {
+public:
+  struct StageStats {
+    uint64_t count = 0;
+    int64_t total_ns = 0;
+    int64_t min_ns = INT64_MAX;
+    int64_t max_ns = INT64_MIN;
+
+    [[nodiscard]] double mean_ns() const noexcept {
+      return count == 0 ? 0.0 : static_cast<double>(total_ns) / static_cast<double>(count);
+    }
+  };
+
+private:
+  StageStats stages_[static_cast<size_t>(Stage::Count)];
+
+public:
+  // Stamps a message carries, Generated through Written (0 = not stamped)
+  using CarriedStamps = std::array<int64_t, CARRIED_STAGES + 1>;
+
+  // Take the stamps out of a message, e.g. one being read in place that
+  // may still be overwritten, to record() them once it is known to be intact
+  [[nodiscard]] static CarriedStamps carried(const MarketData &msg) noexcept {
+    CarriedStamps carried{};
+    for (size_t i = 0; i <= CARRIED_STAGES; ++i) {
+      carried[i] = msg.stage_ns(static_cast<Stage>(i));
+    }
+    return carried;
+  }
+
+  // dequeued_ns / parsed_ns: when this consumer took the message off its
+  // transport and finished decoding it (0 = not applicable)
+  void record(const MarketData &msg, int64_t dequeued_ns, int64_t parsed_ns = 0) noexcept {
+    record(carried(msg), dequeued_ns, parsed_ns);
+  }
+
+  void record(const CarriedStamps &carried, int64_t dequeued_ns, int64_t parsed_ns = 0) noexcept {
+    int64_t stamps[static_cast<size_t>(Stage::Count)] = {};
+    for (size_t i = 0; i <= CARRIED_STAGES; ++i) {
+      stamps[i] = carried[i];
+    }
+    stamps[static_cast<size_t>(Stage::Dequeued)] = dequeued_ns;
+    stamps[static_cast<size_t>(Stage::Parsed)] = parsed_ns;
+
+    int64_t previous = stamps[0];
+    for (size_t i = 1; i < static_cast<size_t>(Stage::Count); ++i) {
+      if (stamps[i] == 0) {
+        continue;
+      }
+      const int64_t spent = stamps[i] - previous;
+      StageStats &stats = stages_[i];
+      ++stats.count;
+      stats.total_ns += spent;
+      stats.min_ns = std::min(stats.min_ns, spent);
+      stats.max_ns = std::max(stats.max_ns, spent);
+      previous = stamps[i];
+    }
+  }
+
+  // Time spent reaching stage (from the previous stamped stage)
+  [[nodiscard]] const StageStats &stage(Stage stage) const noexcept {
+    return stages_[static_cast<size_t>(stage)];
+  }
+
+  // Call f(Stage, const StageStats&) for every stage with samples, in path order
+  template <typename F>
+  void for_each(F &&f) const {
+    for (size_t i = 1; i < static_cast<size_t>(Stage::Count); ++i) {
+      if (stages_[i].count > 0) {
+        f(static_cast<Stage>(i), stages_[i]);
+      }
+    }
+  }
+};
+
 // ============================================================================
 // COMPILE-TIME CHECKS
 // ============================================================================
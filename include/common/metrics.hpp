@@ -0,0 +1,275 @@
+#pragma once
+
+// ============================================================================
+// SHARED MEMORY METRICS
+// ============================================================================
+// This header lets every process publish its counters, gauges and latency
+// histograms in a shared memory segment of its own, where an external monitor
+// (hft_top) can read them live without asking the process for anything.
+//
+//   hft_metrics_<pid>            MetricsTable of one process
+//
+// Each metric has exactly one writer, the process that owns the segment, so
+// updating one is a relaxed load and store (RelaxedCounter): no locked
+// instruction, no syscall, nothing shared with other writers. Metrics are
+// registered by name at startup, off the hot path; the hot path only keeps
+// the handles.
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <dirent.h>
+#include <unistd.h>
+#include "latency_histogram.hpp"
+#include "shared_memory.hpp"
+
+namespace hft {
+
+// ============================================================================
+// CONSTANTS
+// ============================================================================
+
+// Longest metric or process name, including the terminating null
+constexpr size_t METRIC_NAME_LEN = 32;
+
+// Metrics one process can register of each kind
+constexpr size_t MAX_COUNTERS = 32;
+constexpr size_t MAX_GAUGES = 32;
+constexpr size_t MAX_HISTOGRAMS = 4;
+
+// Metrics segments are named METRICS_SEGMENT_PREFIX + pid
+inline constexpr const char* METRICS_SEGMENT_PREFIX = "hft_metrics_";
+
+inline std::string metrics_segment(pid_t pid) {
+    return METRICS_SEGMENT_PREFIX + std::to_string(pid);
+}
+
+// ============================================================================
+// MetricsTable
+// ============================================================================
+//
+// LAYOUT:
+//   - Names and values are kept apart, so the values the hot path writes are
+//     packed together on as few cache lines as possible
+//   - A slot's name is written before the *_used count is raised (release),
+//     so a reader that sees the count also sees the name
+//
+struct MetricsTable {
+    char process[METRIC_NAME_LEN];
+
+    std::atomic<uint32_t> counters_used{0};
+    std::atomic<uint32_t> gauges_used{0};
+    std::atomic<uint32_t> histograms_used{0};
+
+    char counter_names[MAX_COUNTERS][METRIC_NAME_LEN];
+    char gauge_names[MAX_GAUGES][METRIC_NAME_LEN];
+    char histogram_names[MAX_HISTOGRAMS][METRIC_NAME_LEN];
+
+    alignas(64) RelaxedCounter counters[MAX_COUNTERS];
+    alignas(64) std::atomic<int64_t> gauges[MAX_GAUGES];
+    alignas(64) SharedLatencyHistogram histograms[MAX_HISTOGRAMS];
+
+    explicit MetricsTable(std::string_view process_name) noexcept {
+        std::memset(process, 0, sizeof(process));
+        std::memset(counter_names, 0, sizeof(counter_names));
+        std::memset(gauge_names, 0, sizeof(gauge_names));
+        std::memset(histogram_names, 0, sizeof(histogram_names));
+        std::memcpy(process, process_name.data(), std::min(process_name.size(), METRIC_NAME_LEN - 1));
+        for (auto& gauge : gauges) {
+            gauge.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    // Visit registered metrics: f(const char* name, value)
+    template<typename F>
+    void for_each_counter(F&& f) const {
+        const uint32_t used = counters_used.load(std::memory_order_acquire);
+        for (uint32_t i = 0; i < used && i < MAX_COUNTERS; ++i) {
+            f(counter_names[i], static_cast<uint64_t>(counters[i]));
+        }
+    }
+
+    template<typename F>
+    void for_each_gauge(F&& f) const {
+        const uint32_t used = gauges_used.load(std::memory_order_acquire);
+        for (uint32_t i = 0; i < used && i < MAX_GAUGES; ++i) {
+            f(gauge_names[i], gauges[i].load(std::memory_order_relaxed));
+        }
+    }
+
+    // f(const char* name, const SharedLatencyHistogram&)
+    template<typename F>
+    void for_each_histogram(F&& f) const {
+        const uint32_t used = histograms_used.load(std::memory_order_acquire);
+        for (uint32_t i = 0; i < used && i < MAX_HISTOGRAMS; ++i) {
+            f(histogram_names[i], histograms[i]);
+        }
+    }
+};
+
+// ============================================================================
+// Counter / Gauge
+// ============================================================================
+// Hot path handles onto one slot of the owning process's table
+
+class Counter {
+private:
+    RelaxedCounter* value_;
+
+public:
+    explicit Counter(RelaxedCounter& value) noexcept : value_(&value) {}
+
+    void add(uint64_t n = 1) noexcept { *value_ += n; }
+
+    // Mirror a count the caller already keeps: a single store
+    void set(uint64_t value) noexcept { *value_ = value; }
+
+    [[nodiscard]] uint64_t value() const noexcept { return *value_; }
+};
+
+class Gauge {
+private:
+    std::atomic<int64_t>* value_;
+
+public:
+    explicit Gauge(std::atomic<int64_t>& value) noexcept : value_(&value) {}
+
+    void set(int64_t value) noexcept { value_->store(value, std::memory_order_relaxed); }
+
+    [[nodiscard]] int64_t value() const noexcept { return value_->load(std::memory_order_relaxed); }
+};
+
+// ============================================================================
+// MetricsRegistry
+// ============================================================================
+class MetricsRegistry {
+private:
+    SharedMemoryManager shm_;
+    MetricsTable* table_;
+
+    MetricsRegistry(SharedMemoryManager&& shm, MetricsTable* table) noexcept
+        : shm_(std::move(shm)), table_(table) {}
+
+    static ShmLayout layout() noexcept {
+        return ShmLayout{sizeof(MetricsTable), 1, sizeof(MetricsTable)};
+    }
+
+    // Find name among the used slots, or claim the next free one; returns
+    // the slot index, or N if the table is full
+    template<size_t N>
+    static size_t slot_for(char (&names)[N][METRIC_NAME_LEN], std::atomic<uint32_t>& used,
+                           std::string_view name) {
+        if (name.empty() || name.size() >= METRIC_NAME_LEN) {
+            throw std::runtime_error("Invalid metric name '" + std::string(name) + "'");
+        }
+        const uint32_t count = used.load(std::memory_order_relaxed);
+        for (uint32_t i = 0; i < count; ++i) {
+            if (name == names[i]) {
+                return i;
+            }
+        }
+        if (count >= N) {
+            return N;
+        }
+        std::memcpy(names[count], name.data(), name.size());
+        names[count][name.size()] = '\0';
+        used.store(count + 1, std::memory_order_release);
+        return count;
+    }
+
+public:
+    // Create this process's table (replacing one a process with our pid left
+    // behind), after removing tables of processes that have exited
+    static MetricsRegistry create(std::string_view process_name,
+                                  const std::string& segment = metrics_segment(getpid()),
+                                  const ShmOptions& options = ShmOptions{}) {
+        remove_stale();
+        SharedMemoryManager shm = SharedMemoryManager::create_segment(segment, layout(), options);
+        MetricsTable* table = new(shm.payload()) MetricsTable(process_name);
+        shm.mark_ready();
+        return MetricsRegistry(std::move(shm), table);
+    }
+
+    // Attach read-only to another process's table
+    // Throws std::runtime_error if there is none, or it has another layout
+    static MetricsRegistry open(const std::string& segment) {
+        SharedMemoryManager shm = SharedMemoryManager::attach_segment(segment, layout());
+        MetricsTable* table = static_cast<MetricsTable*>(shm.payload());
+        return MetricsRegistry(std::move(shm), table);
+    }
+
+    // Names of all metrics segments on this host (Linux: listed in /dev/shm)
+    static std::vector<std::string> list() {
+        std::vector<std::string> segments;
+        DIR* dir = opendir("/dev/shm");
+        if (dir == nullptr) {
+            return segments;
+        }
+        while (dirent* entry = readdir(dir)) {
+            if (std::string_view(entry->d_name).substr(0, std::strlen(METRICS_SEGMENT_PREFIX)) ==
+                METRICS_SEGMENT_PREFIX) {
+                segments.emplace_back(entry->d_name);
+            }
+        }
+        closedir(dir);
+        return segments;
+    }
+
+    // Remove the tables of processes that have exited; returns how many
+    static size_t remove_stale() {
+        size_t removed = 0;
+        for (const std::string& segment : list()) {
+            const pid_t pid = static_cast<pid_t>(
+                std::strtol(segment.c_str() + std::strlen(METRICS_SEGMENT_PREFIX), nullptr, 10));
+            if (pid > 0 && !process_alive(pid) && SharedMemoryManager::remove(segment)) {
+                ++removed;
+            }
+        }
+        return removed;
+    }
+
+    // Register (or look up) a metric by name. Setup only: throws
+    // std::runtime_error if the name is invalid or the table is full
+    Counter counter(std::string_view name) {
+        const size_t slot = slot_for(table_->counter_names, table_->counters_used, name);
+        if (slot == MAX_COUNTERS) {
+            throw std::runtime_error("Too many counters registering '" + std::string(name) + "'");
+        }
+        return Counter(table_->counters[slot]);
+    }
+
+    Gauge gauge(std::string_view name) {
+        const size_t slot = slot_for(table_->gauge_names, table_->gauges_used, name);
+        if (slot == MAX_GAUGES) {
+            throw std::runtime_error("Too many gauges registering '" + std::string(name) + "'");
+        }
+        return Gauge(table_->gauges[slot]);
+    }
+
+    SharedLatencyHistogram& histogram(std::string_view name) {
+        const size_t slot = slot_for(table_->histogram_names, table_->histograms_used, name);
+        if (slot == MAX_HISTOGRAMS) {
+            throw std::runtime_error("Too many histograms registering '" + std::string(name) + "'");
+        }
+        return table_->histograms[slot];
+    }
+
+    [[nodiscard]] const MetricsTable& table() const noexcept { return *table_; }
+
+    [[nodiscard]] const SharedMemoryManager& segment() const noexcept { return shm_; }
+
+    // The owning process is still running
+    [[nodiscard]] bool owner_alive() const {
+        return process_alive(shm_.header()->creator_pid);
+    }
+};
+
+} // namespace hft
@@ -4,11 +4,16 @@
 // PERFORMANCE OPTIMIZATION UTILITIES
 // ============================================================================
 // This header provides utilities for CPU affinity binding and memory 
-// optimization patterns commonly used in high-frequency trading systems.
+// optimization patterns commonly used in high-frequency trading systems,
+// and hardware performance counters to see why a hot loop got slower.
 
 #include <thread>
+#include <array>
+#include <cerrno>
 #include <cstddef>
 #include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <stdexcept>
 #include <string>
 
@@ -16,6 +21,9 @@
 #include <sched.h>
 #include <pthread.h>
 #include <unistd.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
 #elif __APPLE__
 #include <mach/thread_policy.h>
 #include <mach/thread_act.h>
@@ -203,6 +211,322 @@ public:
     }
 };
 
+// ============================================================================
+// HARDWARE PERFORMANCE COUNTERS
+// ============================================================================
+//
+// A latency regression in a hot loop has a cause the clock cannot show:
+// more instructions, a lower IPC from cache misses or branch mispredictions,
+// or the core running at a lower frequency. PerfCounters opens one
+// perf_event_open group per thread counting:
+//   - cycles and instructions (IPC = instructions / cycles)
+//   - L1 data cache read misses and last level cache misses
+//   - branch mispredictions
+// plus the time the thread was on a CPU. Events are counted in user space
+// only, while that time includes the kernel's, so cycles / time is the
+// effective clock frequency only for regions that make no syscalls. The
+// group is read with one read() and scheduled as a unit, so the events of
+// one reading always cover the same instructions.
+//
+// USAGE:
+//   PerfCounters counters;              // on the thread to measure
+//   PerfStats stats;
+//   {
+//       ScopedPerfCounter scope(counters, stats);
+//       ... region ...
+//   }
+//   stats.per_region(PerfEvent::Cycles) // mean per region
+//
+// Only user space is counted, which perf_event_paranoid <= 2 (the default)
+// allows without privileges. Where counters are not permitted or the CPU
+// exposes none (containers, most VMs, macOS), available() is false and
+// every call is a no-op. Each reading is a syscall (~0.3-1us), so measure
+// per message only when asked to (see requested()).
+
+enum class PerfEvent : size_t {
+    Cycles,
+    Instructions,
+    L1dMisses,
+    LlcMisses,
+    BranchMisses,
+    Count
+};
+
+constexpr size_t PERF_EVENT_COUNT = static_cast<size_t>(PerfEvent::Count);
+
+inline const char* perf_event_name(PerfEvent event) noexcept {
+    switch (event) {
+        case PerfEvent::Cycles: return "cycles";
+        case PerfEvent::Instructions: return "instructions";
+        case PerfEvent::L1dMisses: return "L1d misses";
+        case PerfEvent::LlcMisses: return "LLC misses";
+        case PerfEvent::BranchMisses: return "branch misses";
+        default: return "unknown";
+    }
+}
+
+/**
+ * One reading of the counter group, or the difference of two
+ */
+struct PerfReading {
+    std::array<uint64_t, PERF_EVENT_COUNT> values{};
+    uint64_t running_ns = 0;  // Time the group was counting (thread on a CPU)
+
+    uint64_t operator[](PerfEvent event) const noexcept {
+        return values[static_cast<size_t>(event)];
+    }
+
+    PerfReading operator-(const PerfReading& earlier) const noexcept {
+        PerfReading delta;
+        for (size_t i = 0; i < PERF_EVENT_COUNT; ++i) {
+            delta.values[i] = values[i] - earlier.values[i];
+        }
+        delta.running_ns = running_ns - earlier.running_ns;
+        return delta;
+    }
+
+    PerfReading& operator+=(const PerfReading& other) noexcept {
+        for (size_t i = 0; i < PERF_EVENT_COUNT; ++i) {
+            values[i] += other.values[i];
+        }
+        running_ns += other.running_ns;
+        return *this;
+    }
+};
+
+class PerfCounters {
+private:
+    std::array<int, PERF_EVENT_COUNT> fds_;
+    std::array<uint64_t, PERF_EVENT_COUNT> ids_{};
+    int leader_ = -1;
+    int error_ = 0;  // errno of the first event that failed to open
+
+#ifdef __linux__
+    static perf_event_attr attr_for(PerfEvent event) noexcept {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        switch (event) {
+            case PerfEvent::Cycles: attr.config = PERF_COUNT_HW_CPU_CYCLES; break;
+            case PerfEvent::Instructions: attr.config = PERF_COUNT_HW_INSTRUCTIONS; break;
+            case PerfEvent::LlcMisses: attr.config = PERF_COUNT_HW_CACHE_MISSES; break;
+            case PerfEvent::BranchMisses: attr.config = PERF_COUNT_HW_BRANCH_MISSES; break;
+            default:
+                attr.type = PERF_TYPE_HW_CACHE;
+                attr.config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                              (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+                break;
+        }
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        attr.disabled = 1;  // Members follow the leader, enabled once all are open
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        return attr;
+    }
+#endif
+
+public:
+    /**
+     * Open the counters for the calling thread; never throws
+     * @param enable false builds an inactive (no-op) instance
+     */
+    explicit PerfCounters(bool enable = true) noexcept {
+        fds_.fill(-1);
+#ifdef __linux__
+        if (!enable) {
+            return;
+        }
+        for (size_t i = 0; i < PERF_EVENT_COUNT; ++i) {
+            perf_event_attr attr = attr_for(static_cast<PerfEvent>(i));
+            // The first event that opens leads the group; events the CPU
+            // lacks (e.g. LLC misses in some VMs) are left out
+            const long fd = syscall(SYS_perf_event_open, &attr, 0, -1, leader_, 0);
+            if (fd < 0) {
+                if (error_ == 0) {
+                    error_ = errno;
+                }
+                continue;
+            }
+            fds_[i] = static_cast<int>(fd);
+            if (ioctl(fds_[i], PERF_EVENT_IOC_ID, &ids_[i]) != 0) {
+                ids_[i] = UINT64_MAX;
+            }
+            if (leader_ < 0) {
+                leader_ = fds_[i];
+            }
+        }
+        if (leader_ >= 0) {
+            ioctl(leader_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(leader_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+#else
+        (void)enable;
+        error_ = ENOSYS;
+#endif
+    }
+
+    ~PerfCounters() {
+#ifdef __linux__
+        for (int fd : fds_) {
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+#endif
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    /**
+     * Whether per-message counters were asked for: HFT_PERF set to anything
+     * but 0 in the environment
+     */
+    static bool requested() noexcept {
+        const char* value = std::getenv("HFT_PERF");
+        return value != nullptr && *value != '\0' && std::strcmp(value, "0") != 0;
+    }
+
+    /**
+     * @return true if at least one event is counting
+     */
+    bool available() const noexcept {
+        return leader_ >= 0;
+    }
+
+    /**
+     * @return true if this event is counting
+     */
+    bool counting(PerfEvent event) const noexcept {
+        return fds_[static_cast<size_t>(event)] >= 0;
+    }
+
+    /**
+     * Why counters are missing, e.g. "No such file or directory" when the
+     * CPU exposes no PMU, "Permission denied" when perf_event_paranoid
+     * forbids them; empty when every event is counting
+     */
+    std::string status() const {
+        return error_ == 0 ? std::string() : std::string(std::strerror(error_));
+    }
+
+    /**
+     * Read every counter in one syscall; all zero when unavailable
+     */
+    PerfReading read() const noexcept {
+        PerfReading reading;
+#ifdef __linux__
+        if (leader_ < 0) {
+            return reading;
+        }
+        // { nr, time_running, { value, id } x nr }
+        uint64_t buffer[2 + 2 * PERF_EVENT_COUNT];
+        const ssize_t bytes = ::read(leader_, buffer, sizeof(buffer));
+        if (bytes < static_cast<ssize_t>(2 * sizeof(uint64_t))) {
+            return reading;
+        }
+        const uint64_t members = buffer[0] < PERF_EVENT_COUNT ? buffer[0] : PERF_EVENT_COUNT;
+        reading.running_ns = buffer[1];
+        for (uint64_t m = 0; m < members; ++m) {
+            const uint64_t value = buffer[2 + 2 * m];
+            const uint64_t id = buffer[3 + 2 * m];
+            for (size_t i = 0; i < PERF_EVENT_COUNT; ++i) {
+                if (fds_[i] >= 0 && ids_[i] == id) {
+                    reading.values[i] = value;
+                }
+            }
+        }
+#endif
+        return reading;
+    }
+};
+
+/**
+ * Counter deltas accumulated over many regions (e.g. one per message)
+ */
+class PerfStats {
+private:
+    PerfReading total_;
+    uint64_t regions_ = 0;
+
+public:
+    void add(const PerfReading& delta) noexcept {
+        total_ += delta;
+        ++regions_;
+    }
+
+    /**
+     * Add one delta covering several regions, e.g. a whole benchmark run
+     */
+    void add(const PerfReading& delta, uint64_t regions) noexcept {
+        total_ += delta;
+        regions_ += regions;
+    }
+
+    void reset() noexcept {
+        total_ = PerfReading{};
+        regions_ = 0;
+    }
+
+    uint64_t regions() const noexcept { return regions_; }
+    const PerfReading& total() const noexcept { return total_; }
+
+    /**
+     * Mean count of an event per region; 0 before the first region
+     */
+    double per_region(PerfEvent event) const noexcept {
+        return regions_ == 0 ? 0.0 : static_cast<double>(total_[event]) / static_cast<double>(regions_);
+    }
+
+    /**
+     * Instructions per cycle; 0 without cycles
+     */
+    double ipc() const noexcept {
+        const uint64_t cycles = total_[PerfEvent::Cycles];
+        return cycles == 0 ? 0.0 : static_cast<double>(total_[PerfEvent::Instructions]) / static_cast<double>(cycles);
+    }
+
+    /**
+     * User-mode cycles per running nanosecond. Cycles are counted in user
+     * space only, but running_ns includes time spent in the kernel, so this
+     * is the clock frequency in GHz only for regions that make no syscalls;
+     * for regions that do, it reads low by the kernel's share of the time
+     */
+    double user_cycles_per_ns() const noexcept {
+        return total_.running_ns == 0 ? 0.0
+             : static_cast<double>(total_[PerfEvent::Cycles]) / static_cast<double>(total_.running_ns);
+    }
+};
+
+/**
+ * Adds the counter deltas over its lifetime to a PerfStats as one region;
+ * does nothing when the counters are unavailable
+ */
+class ScopedPerfCounter {
+private:
+    const PerfCounters& counters_;
+    PerfStats& stats_;
+    PerfReading start_;
+
+public:
+    ScopedPerfCounter(const PerfCounters& counters, PerfStats& stats) noexcept
+        : counters_(counters), stats_(stats) {
+        if (counters_.available()) {
+            start_ = counters_.read();
+        }
+    }
+
+    ~ScopedPerfCounter() {
+        if (counters_.available()) {
+            stats_.add(counters_.read() - start_);
+        }
+    }
+
+    ScopedPerfCounter(const ScopedPerfCounter&) = delete;
+    ScopedPerfCounter& operator=(const ScopedPerfCounter&) = delete;
+};
+
 // ============================================================================
 // MEMORY ALLOCATION OPTIMIZATIONS
 // ============================================================================
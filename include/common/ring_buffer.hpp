@@ -8,6 +8,9 @@
 
 #include <atomic>
 #include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
 #include "market_data.hpp"
 
 namespace hft {
@@ -24,8 +27,42 @@ constexpr size_t RING_BUFFER_SIZE = 1024;
 static_assert((RING_BUFFER_SIZE & (RING_BUFFER_SIZE - 1)) == 0, 
               "RING_BUFFER_SIZE must be a power of 2");
 
+// Slot count of the ring shared between publisher and shm_consumer.
+// 64K slots absorb ~65ms of backlog at 1M msg/s, so a scheduling hiccup on
+// the consumer side no longer turns straight into publisher drops.
+constexpr size_t SHM_RING_BUFFER_SIZE = 65536;
+
+// ============================================================================
+// RingGeometry
+// ============================================================================
+//
+// Recorded in the first cache line of every ring. A process that attaches to
+// a ring it did not construct (e.g. shm_consumer) reads this before touching
+// any index, so it can refuse a segment built with a different element type
+// or capacity instead of reading garbage.
+//
+struct RingGeometry {
+    uint64_t element_size; // sizeof(T)
+    uint64_t slot_count;   // Capacity (number of slots, power of 2)
+    uint64_t total_bytes;  // sizeof(the whole ring object)
+
+    [[nodiscard]] bool operator==(const RingGeometry& other) const noexcept {
+        return element_size == other.element_size &&
+               slot_count == other.slot_count &&
+               total_bytes == other.total_bytes;
+    }
+    [[nodiscard]] bool operator!=(const RingGeometry& other) const noexcept {
+        return !(*this == other);
+    }
+};
+
+// Read the geometry of a ring living at addr (any SpscRingBuffer instantiation)
+[[nodiscard]] inline RingGeometry read_ring_geometry(const void* addr) noexcept {
+    return *static_cast<const RingGeometry*>(addr);
+}
+
 // ============================================================================
-// RingBuffer Class
+// SpscRingBuffer Class Template
 // ============================================================================
 //
 // DESIGN PRINCIPLES:
@@ -33,11 +70,16 @@ static_assert((RING_BUFFER_SIZE & (RING_BUFFER_SIZE - 1)) == 0,
 //   - Lock-free using atomic operations with acquire-release semantics
 //   - 64-byte alignment to prevent false sharing between cache lines
 //   - Power-of-2 buffer size for efficient modulo operations using bitwise AND
+//   - Element type and slot count are template parameters, so bursty feeds
+//     can use 64K/1M-slot rings and control channels small ones
 //
 // MEMORY LAYOUT:
-//   - write_idx and read_idx are on separate cache lines (64-byte aligned)
+//   - geometry, write_idx and read_idx are each on their own cache line
 //   - This prevents false sharing when producer updates write_idx and
 //     consumer updates read_idx simultaneously
+//   - Each index shares its line with that side's private cached copy of
+//     the opposite index, so the cache touches only lines it already owns
+//   - The slot array starts on a fresh cache line
 //
 // MEMORY ORDERING:
 //   - Producer uses memory_order_release on write_idx to ensure all data
@@ -46,119 +88,329 @@ static_assert((RING_BUFFER_SIZE & (RING_BUFFER_SIZE - 1)) == 0,
 //   - Consumer uses memory_order_release on read_idx for consistency
 //
 // ALGORITHM:
+//   - write_idx and read_idx are monotonic 64-bit sequence numbers (items
+//     written / read since construction); they are never wrapped, and the
+//     slot for sequence s is s & MASK. At 1e9 msg/s they overflow after
+//     ~584 years
 //   - Empty condition: read_idx == write_idx
-//   - Full condition: (write_idx + 1) % BUFFER_SIZE == read_idx
-//   - Available space: (read_idx - write_idx - 1) % BUFFER_SIZE
+//   - Full condition: write_idx - read_idx == Capacity - 1 (one slot is
+//     still left unused, so capacity() is unchanged)
+//   - Available space: Capacity - 1 - (write_idx - read_idx)
+//
+// CACHED OPPOSITE INDEX:
+//   - The producer keeps cached_read_idx, the last read_idx it observed,
+//     and only re-loads read_idx when the cached value says the ring is full
+//   - The consumer keeps cached_write_idx and only re-loads write_idx when
+//     the cached value says the ring is empty
+//   - A stale cache is always conservative (it under-reports free space or
+//     ready items), so correctness is unchanged; in steady state each side
+//     touches the other's cache line once per lap instead of once per message
+//
+// BATCHING:
+//   - try_write_n / try_read_n / consume_all move up to N items with one
+//     load of the other side's index and one release store of their own,
+//     so a consumer that wakes up 500 messages behind pays for a single
+//     cross-core index update rather than 500
 //
+// ZERO-COPY ACCESS:
+//   - claim() hands the producer the next free slot so a message can be
+//     constructed in place; commit() publishes it with the usual release
+//     store of write_idx
+//   - peek() hands the consumer the next ready slot so it can be processed
+//     in place; release() gives the slot back to the producer
+//   - The slot is owned by one side between the two calls, so no copy
+//     into or out of the ring is needed
+//
+
+template<typename T, size_t Capacity>
+class alignas(64) SpscRingBuffer {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                  "SpscRingBuffer capacity must be a power of 2");
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "SpscRingBuffer elements are copied across processes and must be trivially copyable");
 
-class alignas(64) RingBuffer {
 private:
-    // Producer's write index (aligned to separate cache line)
-    alignas(64) std::atomic<size_t> write_idx{0};
+    // Index mask maps a sequence number to its slot
+    static constexpr uint64_t MASK = Capacity - 1;
+    
+    // Most items the ring holds at once
+    static constexpr uint64_t USABLE = Capacity - 1;
+
+    // Layout description for processes that attach to an existing ring
+    // Must stay the first member: read_ring_geometry() reads it at offset 0
+    alignas(64) RingGeometry geometry{sizeof(T), Capacity, sizeof(SpscRingBuffer)};
+
+    // Producer's write index: sequence of the next item to write
+    // (aligned to separate cache line)
+    alignas(64) std::atomic<uint64_t> write_idx{0};
+    
+    // Producer-private copy of read_idx (same line as write_idx, never
+    // touched by the consumer)
+    uint64_t cached_read_idx{0};
+    
+    // Consumer's read index: sequence of the next item to read
+    // (aligned to separate cache line)
+    alignas(64) std::atomic<uint64_t> read_idx{0};
     
-    // Consumer's read index (aligned to separate cache line)
-    alignas(64) std::atomic<size_t> read_idx{0};
+    // Consumer-private copy of write_idx (same line as read_idx, never
+    // touched by the producer)
+    uint64_t cached_write_idx{0};
     
-    // The actual data buffer
-    // Each MarketData is 64-byte aligned for optimal cache performance
-    MarketData buffer[RING_BUFFER_SIZE];
+    // The actual data buffer, starting on its own cache line
+    alignas(64) T buffer[Capacity];
 
 public:
+    using value_type = T;
+
     // ========================================================================
     // CONSTRUCTOR
     // ========================================================================
-    RingBuffer() = default;
+    SpscRingBuffer() = default;
 
     // ========================================================================
     // COPY/MOVE SEMANTICS
     // ========================================================================
-    // RingBuffer is not copyable or movable due to atomic members
-    RingBuffer(const RingBuffer&) = delete;
-    RingBuffer& operator=(const RingBuffer&) = delete;
-    RingBuffer(RingBuffer&&) = delete;
-    RingBuffer& operator=(RingBuffer&&) = delete;
+    // SpscRingBuffer is not copyable or movable due to atomic members
+    SpscRingBuffer(const SpscRingBuffer&) = delete;
+    SpscRingBuffer& operator=(const SpscRingBuffer&) = delete;
+    SpscRingBuffer(SpscRingBuffer&&) = delete;
+    SpscRingBuffer& operator=(SpscRingBuffer&&) = delete;
 
     // ========================================================================
     // PRODUCER INTERFACE (Single Producer)
     // ========================================================================
     
-    // Try to write a market data item to the buffer
+    // Try to write an item to the buffer
     // Returns true on success, false if buffer is full
-    [[nodiscard]] bool try_write(const MarketData& data) noexcept {
-        const size_t current_write = write_idx.load(std::memory_order_relaxed);
-        const size_t next_write = (current_write + 1) & (RING_BUFFER_SIZE - 1);
+    [[nodiscard]] bool try_write(const T& data) noexcept {
+        const uint64_t current_write = write_idx.load(std::memory_order_relaxed);
         
         // Check if buffer is full
-        // We need to leave one slot empty to distinguish between full and empty
-        const size_t current_read = read_idx.load(std::memory_order_acquire);
-        if (next_write == current_read) {
-            return false; // Buffer is full
+        // Only go to the consumer's cache line when our cached copy says full
+        if (current_write - cached_read_idx == USABLE) {
+            cached_read_idx = read_idx.load(std::memory_order_acquire);
+            if (current_write - cached_read_idx == USABLE) {
+                return false; // Buffer is full
+            }
         }
         
         // Write the data to the buffer
-        buffer[current_write] = data;
+        buffer[current_write & MASK] = data;
         
         // Update write index with release semantics
         // This ensures the data write is visible before the index update
-        write_idx.store(next_write, std::memory_order_release);
+        write_idx.store(current_write + 1, std::memory_order_release);
         
         return true;
     }
     
+    // Try to write up to count items from data in one batch
+    // Slots are filled first and write_idx is published once for the whole
+    // batch, so the consumer sees one index update instead of count updates
+    // Returns the number of items written (0 if the buffer is full)
+    [[nodiscard]] size_t try_write_n(const T* data, size_t count) noexcept {
+        const uint64_t current_write = write_idx.load(std::memory_order_relaxed);
+        
+        // Refresh the cached read_idx only if it cannot satisfy the whole batch
+        size_t free_slots = USABLE - (current_write - cached_read_idx);
+        if (free_slots < count) {
+            cached_read_idx = read_idx.load(std::memory_order_acquire);
+            free_slots = USABLE - (current_write - cached_read_idx);
+        }
+        const size_t n = count < free_slots ? count : free_slots;
+        if (n == 0) {
+            return 0;
+        }
+        
+        // Copy in at most two runs: up to the end of the array, then from slot 0
+        const size_t start = current_write & MASK;
+        const size_t first_run = (Capacity - start) < n ? (Capacity - start) : n;
+        for (size_t i = 0; i < first_run; ++i) {
+            buffer[start + i] = data[i];
+        }
+        for (size_t i = first_run; i < n; ++i) {
+            buffer[i - first_run] = data[i];
+        }
+        
+        // Single release store publishes every slot written above
+        write_idx.store(current_write + n, std::memory_order_release);
+        
+        return n;
+    }
+    
+    // Claim the next free slot for in-place construction
+    // Returns nullptr if the buffer is full; otherwise the slot belongs to the
+    // producer until commit() publishes it. Calling claim() again before
+    // commit() returns the same slot
+    [[nodiscard]] T* claim() noexcept {
+        const uint64_t current_write = write_idx.load(std::memory_order_relaxed);
+        
+        if (current_write - cached_read_idx == USABLE) {
+            cached_read_idx = read_idx.load(std::memory_order_acquire);
+            if (current_write - cached_read_idx == USABLE) {
+                return nullptr; // Buffer is full
+            }
+        }
+        
+        return &buffer[current_write & MASK];
+    }
+    
+    // Publish the slot returned by the last successful claim()
+    void commit() noexcept {
+        const uint64_t current_write = write_idx.load(std::memory_order_relaxed);
+        write_idx.store(current_write + 1, std::memory_order_release);
+    }
+    
     // Check if the buffer is full (from producer's perspective)
     [[nodiscard]] bool is_full() const noexcept {
-        const size_t current_write = write_idx.load(std::memory_order_relaxed);
-        const size_t next_write = (current_write + 1) & (RING_BUFFER_SIZE - 1);
-        const size_t current_read = read_idx.load(std::memory_order_acquire);
-        return next_write == current_read;
+        const uint64_t current_write = write_idx.load(std::memory_order_relaxed);
+        const uint64_t current_read = read_idx.load(std::memory_order_acquire);
+        return current_write - current_read == USABLE;
     }
     
     // Get the number of available slots for writing
     [[nodiscard]] size_t available_for_write() const noexcept {
-        const size_t current_write = write_idx.load(std::memory_order_relaxed);
-        const size_t current_read = read_idx.load(std::memory_order_acquire);
+        const uint64_t current_write = write_idx.load(std::memory_order_relaxed);
+        const uint64_t current_read = read_idx.load(std::memory_order_acquire);
         
         // Calculate available space, accounting for the one slot we keep empty
-        return (current_read - current_write - 1) & (RING_BUFFER_SIZE - 1);
+        return USABLE - (current_write - current_read);
     }
 
     // ========================================================================
     // CONSUMER INTERFACE (Single Consumer)
     // ========================================================================
     
-    // Try to read a market data item from the buffer
+    // Try to read an item from the buffer
     // Returns true on success, false if buffer is empty
-    [[nodiscard]] bool try_read(MarketData& data) noexcept {
-        const size_t current_read = read_idx.load(std::memory_order_relaxed);
-        const size_t current_write = write_idx.load(std::memory_order_acquire);
+    [[nodiscard]] bool try_read(T& data) noexcept {
+        const uint64_t current_read = read_idx.load(std::memory_order_relaxed);
         
         // Check if buffer is empty
-        if (current_read == current_write) {
-            return false; // Buffer is empty
+        // Only go to the producer's cache line when our cached copy says empty
+        if (current_read == cached_write_idx) {
+            cached_write_idx = write_idx.load(std::memory_order_acquire);
+            if (current_read == cached_write_idx) {
+                return false; // Buffer is empty
+            }
         }
         
         // Read the data from the buffer
-        data = buffer[current_read];
+        data = buffer[current_read & MASK];
         
         // Update read index with release semantics
-        const size_t next_read = (current_read + 1) & (RING_BUFFER_SIZE - 1);
-        read_idx.store(next_read, std::memory_order_release);
+        read_idx.store(current_read + 1, std::memory_order_release);
         
         return true;
     }
     
+    // Try to read up to max_count items into out in one batch
+    // read_idx is published once for the whole batch
+    // Returns the number of items read (0 if the buffer is empty)
+    [[nodiscard]] size_t try_read_n(T* out, size_t max_count) noexcept {
+        const uint64_t current_read = read_idx.load(std::memory_order_relaxed);
+        
+        // Refresh the cached write_idx only if it cannot fill the whole batch
+        size_t ready = cached_write_idx - current_read;
+        if (ready < max_count) {
+            cached_write_idx = write_idx.load(std::memory_order_acquire);
+            ready = cached_write_idx - current_read;
+        }
+        const size_t n = max_count < ready ? max_count : ready;
+        if (n == 0) {
+            return 0;
+        }
+        
+        const size_t start = current_read & MASK;
+        const size_t first_run = (Capacity - start) < n ? (Capacity - start) : n;
+        for (size_t i = 0; i < first_run; ++i) {
+            out[i] = buffer[start + i];
+        }
+        for (size_t i = first_run; i < n; ++i) {
+            out[i] = buffer[i - first_run];
+        }
+        
+        read_idx.store(current_read + n, std::memory_order_release);
+        
+        return n;
+    }
+    
+    // Drain everything currently available (at most max_items), calling
+    // callback(const T&) on each item in place, without copying it out
+    // The producer cannot reuse the slots until read_idx is published after
+    // the last callback, so references stay valid for the callback's duration
+    // If callback throws, read_idx is not advanced and the batch is redelivered
+    // Returns the number of items consumed
+    template<typename Callback>
+    size_t consume_all(Callback&& callback, size_t max_items = Capacity) {
+        const uint64_t current_read = read_idx.load(std::memory_order_relaxed);
+        
+        size_t ready = cached_write_idx - current_read;
+        if (ready < max_items) {
+            cached_write_idx = write_idx.load(std::memory_order_acquire);
+            ready = cached_write_idx - current_read;
+        }
+        const size_t n = max_items < ready ? max_items : ready;
+        if (n == 0) {
+            return 0;
+        }
+        
+        for (size_t i = 0; i < n; ++i) {
+            callback(static_cast<const T&>(buffer[(current_read + i) & MASK]));
+        }
+        
+        read_idx.store(current_read + n, std::memory_order_release);
+        
+        return n;
+    }
+    
+    // Look at the next item in place without copying it out
+    // Returns nullptr if the buffer is empty; otherwise the slot stays valid
+    // (the producer cannot reuse it) until release() is called
+    [[nodiscard]] const T* peek() noexcept {
+        const uint64_t current_read = read_idx.load(std::memory_order_relaxed);
+        
+        if (current_read == cached_write_idx) {
+            cached_write_idx = write_idx.load(std::memory_order_acquire);
+            if (current_read == cached_write_idx) {
+                return nullptr; // Buffer is empty
+            }
+        }
+        
+        return &buffer[current_read & MASK];
+    }
+    
+    // Hand the slot returned by the last successful peek() back to the producer
+    void release() noexcept {
+        const uint64_t current_read = read_idx.load(std::memory_order_relaxed);
+        read_idx.store(current_read + 1, std::memory_order_release);
+    }
+    
+    // Drain like consume_all(); if the buffer is empty, idle once using the
+    // wait strategy (see wait_strategy.hpp) instead of spinning raw
+    template<typename WaitStrategy, typename Callback>
+    size_t poll(Callback&& callback, WaitStrategy& wait, size_t max_items = Capacity) {
+        const size_t consumed = consume_all(std::forward<Callback>(callback), max_items);
+        if (consumed > 0) {
+            wait.reset();
+        } else {
+            wait.idle();
+        }
+        return consumed;
+    }
+    
     // Check if the buffer is empty (from consumer's perspective)
     [[nodiscard]] bool is_empty() const noexcept {
-        const size_t current_read = read_idx.load(std::memory_order_relaxed);
-        const size_t current_write = write_idx.load(std::memory_order_acquire);
+        const uint64_t current_read = read_idx.load(std::memory_order_relaxed);
+        const uint64_t current_write = write_idx.load(std::memory_order_acquire);
         return current_read == current_write;
     }
     
     // Get the number of items available for reading
     [[nodiscard]] size_t available_for_read() const noexcept {
-        const size_t current_read = read_idx.load(std::memory_order_relaxed);
-        const size_t current_write = write_idx.load(std::memory_order_acquire);
-        return (current_write - current_read) & (RING_BUFFER_SIZE - 1);
+        const uint64_t current_read = read_idx.load(std::memory_order_relaxed);
+        const uint64_t current_write = write_idx.load(std::memory_order_acquire);
+        return current_write - current_read;
     }
 
     // ========================================================================
@@ -167,30 +419,55 @@ public:
     
     // Get the buffer capacity (total number of slots minus one for full/empty distinction)
     [[nodiscard]] static constexpr size_t capacity() noexcept {
-        return RING_BUFFER_SIZE - 1;
+        return Capacity - 1;
     }
     
     // Get the raw buffer size
     [[nodiscard]] static constexpr size_t buffer_size() noexcept {
-        return RING_BUFFER_SIZE;
+        return Capacity;
+    }
+
+    // Geometry this instantiation records in shared memory
+    [[nodiscard]] static constexpr RingGeometry expected_geometry() noexcept {
+        return RingGeometry{sizeof(T), Capacity, sizeof(SpscRingBuffer)};
+    }
+
+    // Check whether a recorded geometry was produced by this instantiation
+    [[nodiscard]] static bool geometry_matches(const RingGeometry& recorded) noexcept {
+        return recorded == expected_geometry();
+    }
+
+    // Geometry recorded in this ring instance
+    [[nodiscard]] const RingGeometry& get_geometry() const noexcept {
+        return geometry;
     }
     
-    // Get current write index (for debugging/monitoring)
-    [[nodiscard]] size_t get_write_index() const noexcept {
+    // Get current write index: total items written so far (monotonic)
+    [[nodiscard]] uint64_t get_write_index() const noexcept {
         return write_idx.load(std::memory_order_relaxed);
     }
     
-    // Get current read index (for debugging/monitoring)
-    [[nodiscard]] size_t get_read_index() const noexcept {
+    // Get current read index: total items read so far (monotonic)
+    [[nodiscard]] uint64_t get_read_index() const noexcept {
         return read_idx.load(std::memory_order_relaxed);
     }
     
     // Get buffer address for memory prefetching (advanced optimization)
-    [[nodiscard]] const MarketData* get_buffer_address() const noexcept {
+    [[nodiscard]] const T* get_buffer_address() const noexcept {
         return buffer;
     }
 };
 
+// ============================================================================
+// TYPE ALIASES
+// ============================================================================
+
+// The original MarketData ring; kept so existing code and tests are unchanged
+using RingBuffer = SpscRingBuffer<MarketData, RING_BUFFER_SIZE>;
+
+// Ring constructed by the publisher in the "hft_market_data" segment
+using ShmRingBuffer = SpscRingBuffer<MarketData, SHM_RING_BUFFER_SIZE>;
+
 // ============================================================================
 // COMPILE-TIME CHECKS
 // ============================================================================
@@ -203,7 +480,7 @@ static_assert(alignof(RingBuffer) == 64,
 static_assert(RING_BUFFER_SIZE >= 64, 
               "Buffer size should be at least 64 for reasonable capacity");
 
-static_assert(RING_BUFFER_SIZE <= 65536, 
-              "Buffer size should not exceed 64K to avoid excessive memory usage");
+static_assert(SHM_RING_BUFFER_SIZE >= RING_BUFFER_SIZE,
+              "Shared memory ring should not be smaller than the default ring");
 
-} // namespace hft
\ No newline at end of file
+} // namespace hft
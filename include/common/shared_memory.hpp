@@ -1,14 +1,163 @@
 #pragma once
 
 #include <sys/mman.h>
+#include <sys/resource.h>
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <cerrno>
+#include <csignal>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <optional>
 #include <string>
 #include <stdexcept>
 
+#ifdef __linux__
+#include <linux/magic.h>
+#include <sys/vfs.h>
+#endif
+
 namespace hft {
 
+/**
+ * Identifies a segment laid out by this codebase ("HFTSHM01" in memory)
+ */
+constexpr uint64_t SHM_SEGMENT_MAGIC = 0x31304D4853544648ull;
+
+/**
+ * Version of the segment layout (header and everything behind it)
+ * Bump whenever a shared structure changes size or meaning, so processes
+ * built from different sources refuse to talk instead of corrupting data
+ *   1: control header introduced
+ *   2: broadcast ring reader cursors moved to their own segment
+ *   3: header generation counter (segments survive a creator restart)
+ *   4: broadcast ring reader heartbeat counters
+ *   5: broadcast ring reader slots are owned through their pid
+ */
+constexpr uint32_t SHM_LAYOUT_VERSION = 5;
+
+/**
+ * Control header at offset 0 of every segment created with
+ * SharedMemoryManager::create_segment(). The payload (e.g. a ring) follows
+ * at payload_offset. magic is written last, with release semantics, once the
+ * creator has finished constructing the payload, so an attaching process
+ * either sees a complete segment or refuses it. generation counts the
+ * creators that have owned the segment: 1 when created, +1 each time a
+ * restarted creator takes it over with SharedMemoryManager::resume_segment().
+ */
+struct alignas(64) ShmSegmentHeader {
+    std::atomic<uint64_t> magic;        // SHM_SEGMENT_MAGIC once the segment is ready
+    uint32_t layout_version;            // SHM_LAYOUT_VERSION of the creator
+    uint32_t payload_offset;            // Bytes from segment start to the payload
+    uint64_t element_size;              // sizeof one payload element
+    uint64_t capacity;                  // Number of payload elements (slots)
+    uint64_t payload_bytes;             // sizeof the whole payload object
+    int64_t start_time_ns;              // Creation time, ns since the Unix epoch
+    int32_t creator_pid;                // Process that created (or last resumed) the segment
+    std::atomic<uint32_t> generation;   // Creator incarnation, see above
+    std::atomic<int64_t> heartbeat_ns;  // Last sign of life from the creator
+};
+
+static_assert(sizeof(ShmSegmentHeader) == 64, "ShmSegmentHeader should fill one cache line");
+static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<int64_t>::is_always_lock_free &&
+              std::atomic<uint32_t>::is_always_lock_free,
+              "ShmSegmentHeader atomics must be lock-free to work across processes");
+
+/**
+ * Payload description a creator records and an attacher expects
+ */
+struct ShmLayout {
+    uint64_t element_size;  // sizeof one element
+    uint64_t capacity;      // Number of elements
+    uint64_t payload_bytes; // sizeof the whole payload object
+};
+
+/**
+ * Wall-clock nanoseconds since the Unix epoch, as stored in the header
+ */
+inline int64_t shm_clock_ns() noexcept {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Minor page faults taken by this process so far
+ * Compare before and after a hot loop to confirm it ran fault-free
+ */
+inline long minor_page_faults() noexcept {
+    struct rusage usage;
+    return getrusage(RUSAGE_SELF, &usage) == 0 ? usage.ru_minflt : 0;
+}
+
+/**
+ * False only if no process with this pid exists any more
+ * (a pid we may not signal still counts as alive)
+ */
+inline bool process_alive(int32_t pid) noexcept {
+    return pid <= 0 || kill(pid, 0) == 0 || errno != ESRCH;
+}
+
+/**
+ * Pages behind a mapped segment
+ */
+enum class ShmBacking {
+    NormalPages,  // shm_open segment, base (4K) pages
+    HugePages     // File on hugetlbfs, huge (usually 2MB) pages
+};
+
+inline const char* shm_backing_name(ShmBacking backing) noexcept {
+    return backing == ShmBacking::HugePages ? "huge pages" : "normal pages";
+}
+
+/**
+ * How a segment is backed and mapped
+ */
+struct ShmOptions {
+    /**
+     * Creator: back the segment with huge pages from hugetlbfs, so a large
+     * ring needs a handful of TLB entries instead of thousands. Falls back
+     * to normal pages when hugetlbfs is not mounted or has no pages reserved
+     * (see backing()). Reserve pages with e.g.
+     *   echo 64 > /proc/sys/vm/nr_hugepages
+     */
+    bool huge_pages = false;
+
+    /**
+     * hugetlbfs mount point. Attachers look here for a segment that is not
+     * found among the normal shm_open segments
+     */
+    const char* hugetlbfs_dir = "/dev/hugepages";
+
+    /**
+     * Map with MAP_POPULATE, so the kernel faults in every page of the
+     * segment inside mmap() instead of on first touch (Linux only)
+     */
+    bool populate = false;
+
+    /**
+     * After mapping, touch every page once (MADV_POPULATE_READ/WRITE where
+     * available). Never modifies the contents, so it is safe on a segment
+     * other processes are already using
+     */
+    bool pretouch = false;
+
+    /**
+     * mlock() the mapping so its pages stay resident and are never swapped
+     * out. Best effort: limited by RLIMIT_MEMLOCK (see locked())
+     */
+    bool lock = false;
+
+    /**
+     * Creator: leave the segment in place when the manager is destroyed
+     * instead of unlinking it. Attached processes keep reading it, and a
+     * restarted creator takes it over with resume_segment(). Remove it for
+     * good with SharedMemoryManager::remove()
+     */
+    bool persist = false;
+};
+
 /**
  * RAII wrapper for POSIX shared memory operations
  * Provides safe creation, mapping, and cleanup of shared memory segments
@@ -20,25 +169,52 @@ private:
     size_t size_;
     std::string name_;
     bool is_creator_;
+    bool persist_;          // Creator leaves the segment behind on destruction
+    ShmBacking backing_;
+    size_t page_size_;      // Page size of the backing
+    size_t mapped_bytes_;   // size_ rounded up to page_size_ (what we munmap)
+    std::string path_;      // hugetlbfs file, empty for shm_open segments
+    bool locked_;           // mlock() succeeded
+    long prefaulted_pages_; // Minor faults taken up front by populate/pretouch/lock
 
 public:
     /**
      * Constructor for shared memory management
      * @param name Shared memory segment name (without leading slash)
-     * @param size Size of the shared memory segment in bytes
+     * @param size Size of the shared memory segment in bytes. When attaching,
+     *             0 maps the whole segment at whatever size its creator chose
      * @param create True to create new segment, false to attach to existing
+     * @param writable When attaching, map read-write instead of read-only.
+     *                 Needed by readers that publish state into the segment
+     *                 (e.g. a BroadcastRing reader cursor). Creators always
+     *                 map read-write.
+     * @param options Page backing (see ShmOptions)
      */
-    SharedMemoryManager(const std::string& name, size_t size, bool create = true)
-        : shm_fd_(-1), mapped_addr_(MAP_FAILED), size_(size), name_("/" + name), is_creator_(create) {
+    SharedMemoryManager(const std::string& name, size_t size, bool create = true, bool writable = false,
+                        const ShmOptions& options = ShmOptions{})
+        : shm_fd_(-1), mapped_addr_(MAP_FAILED), size_(size), name_("/" + name), is_creator_(create),
+          persist_(options.persist), backing_(ShmBacking::NormalPages), page_size_(static_cast<size_t>(sysconf(_SC_PAGESIZE))),
+          mapped_bytes_(size), path_(), locked_(false), prefaulted_pages_(0) {
+        const long faults_before = minor_page_faults();
+#ifdef MAP_POPULATE
+        const int map_flags = MAP_SHARED | (options.populate ? MAP_POPULATE : 0);
+#else
+        const int map_flags = MAP_SHARED;
+#endif
         
         // Validate inputs
         if (name.empty()) {
             throw std::runtime_error("Shared memory name cannot be empty");
         }
-        if (size == 0) {
+        if (size == 0 && create) {
             throw std::runtime_error("Shared memory size cannot be zero");
         }
         
+        if (create && options.huge_pages && create_huge(options.hugetlbfs_dir, map_flags)) {
+            warm_up(options, true, faults_before);
+            return;
+        }
+        
         if (create) {
             // Create new shared memory segment (or open existing)
             shm_fd_ = shm_open(name_.c_str(), O_CREAT | O_RDWR, 0666);
@@ -66,15 +242,37 @@ public:
             // This allows multiple creators to open the same segment
         } else {
             // Attach to existing shared memory segment
-            shm_fd_ = shm_open(name_.c_str(), O_RDONLY, 0666);
+            shm_fd_ = shm_open(name_.c_str(), writable ? O_RDWR : O_RDONLY, 0666);
+            if (shm_fd_ == -1 && errno == ENOENT && attach_huge(options.hugetlbfs_dir, writable, map_flags)) {
+                warm_up(options, writable, faults_before);
+                return;
+            }
             if (shm_fd_ == -1) {
                 throw std::runtime_error("Failed to open existing shared memory segment: " + name_);
             }
+            
+            // The creator decides the segment size; mapping past its end
+            // would only fail later with SIGBUS on first touch
+            struct stat shm_stat;
+            if (fstat(shm_fd_, &shm_stat) == -1) {
+                close(shm_fd_);
+                throw std::runtime_error("Failed to get shared memory stats");
+            }
+            const size_t segment_size = static_cast<size_t>(shm_stat.st_size);
+            if (size_ == 0) {
+                size_ = segment_size;
+            }
+            if (size_ == 0 || size_ > segment_size) {
+                close(shm_fd_);
+                throw std::runtime_error("Shared memory segment " + name_ + " is smaller than requested (" +
+                                         std::to_string(segment_size) + " < " + std::to_string(size_) + " bytes)");
+            }
         }
         
         // Map the shared memory into process address space
-        int prot = create ? (PROT_READ | PROT_WRITE) : PROT_READ;
-        mapped_addr_ = mmap(nullptr, size_, prot, MAP_SHARED, shm_fd_, 0);
+        int prot = (create || writable) ? (PROT_READ | PROT_WRITE) : PROT_READ;
+        mapped_bytes_ = size_;
+        mapped_addr_ = mmap(nullptr, size_, prot, map_flags, shm_fd_, 0);
         
         if (mapped_addr_ == MAP_FAILED) {
             close(shm_fd_);
@@ -83,6 +281,107 @@ public:
             }
             throw std::runtime_error("Failed to map shared memory");
         }
+        
+        warm_up(options, create || writable, faults_before);
+    }
+
+    /**
+     * Create a segment with a control header followed by a payload of
+     * layout.payload_bytes. The header is filled in but not yet marked
+     * ready: construct the payload at payload(), then call mark_ready()
+     * A segment of the same name left behind by an earlier creator is
+     * removed first rather than rebuilt in place, so processes still mapped
+     * to it keep a consistent (if dead) copy; see unlinked()
+     * @param name Shared memory segment name (without leading slash)
+     * @param layout Element size, capacity and size of the payload object
+     * @param options Page backing (see ShmOptions)
+     * @throws std::runtime_error if the segment cannot be created
+     */
+    static SharedMemoryManager create_segment(const std::string& name, const ShmLayout& layout,
+                                              const ShmOptions& options = ShmOptions{}) {
+        remove(name, options);
+        SharedMemoryManager shm(name, sizeof(ShmSegmentHeader) + layout.payload_bytes, true, false, options);
+        
+        ShmSegmentHeader* hdr = shm.header();
+        hdr->magic.store(0, std::memory_order_relaxed);
+        hdr->layout_version = SHM_LAYOUT_VERSION;
+        hdr->payload_offset = sizeof(ShmSegmentHeader);
+        hdr->element_size = layout.element_size;
+        hdr->capacity = layout.capacity;
+        hdr->payload_bytes = layout.payload_bytes;
+        hdr->start_time_ns = shm_clock_ns();
+        hdr->creator_pid = static_cast<int32_t>(getpid());
+        hdr->generation.store(1, std::memory_order_relaxed);
+        hdr->heartbeat_ns.store(hdr->start_time_ns, std::memory_order_relaxed);
+        return shm;
+    }
+
+    /**
+     * Creator restart: take over a ready segment an earlier creator left
+     * behind (see ShmOptions::persist), keeping its payload and everyone
+     * attached to it. Records this process as the creator and bumps the
+     * header generation so attached processes can tell
+     * @param name Shared memory segment name (without leading slash)
+     * @param layout Element size, capacity and size of the payload object
+     * @param options Page backing (see ShmOptions)
+     * @return Nothing if there is no ready segment with this layout to
+     *         resume; create a fresh one with create_segment() instead
+     * @throws std::runtime_error if the segment's creator is still running
+     */
+    static std::optional<SharedMemoryManager> resume_segment(const std::string& name, const ShmLayout& layout,
+                                                             const ShmOptions& options = ShmOptions{}) {
+        std::optional<SharedMemoryManager> shm;
+        try {
+            shm.emplace(name, 0, false, true, options);
+            shm->validate_header(layout);
+        } catch (const std::runtime_error&) {
+            return std::nullopt;
+        }
+        
+        ShmSegmentHeader* hdr = shm->header();
+        const int32_t self_pid = static_cast<int32_t>(getpid());
+        if (hdr->creator_pid != self_pid && process_alive(hdr->creator_pid)) {
+            throw std::runtime_error("Shared memory segment " + shm->name_ + " is still owned by process " +
+                                     std::to_string(hdr->creator_pid));
+        }
+        
+        shm->is_creator_ = true;
+        hdr->creator_pid = self_pid;
+        hdr->heartbeat_ns.store(shm_clock_ns(), std::memory_order_relaxed);
+        hdr->generation.fetch_add(1, std::memory_order_release);
+        return shm;
+    }
+
+    /**
+     * Remove a segment by name (normal or huge page backed), e.g. one left
+     * behind with ShmOptions::persist. Processes that still map it keep
+     * their mapping
+     * @return True if a segment was removed
+     */
+    static bool remove(const std::string& name, const ShmOptions& options = ShmOptions{}) {
+        bool removed = shm_unlink(("/" + name).c_str()) == 0;
+        if (hugetlbfs_page_size(options.hugetlbfs_dir) != 0) {
+            removed = unlink((std::string(options.hugetlbfs_dir) + "/" + name).c_str()) == 0 || removed;
+        }
+        return removed;
+    }
+
+    /**
+     * Attach to a segment made by create_segment() and validate its header
+     * against the layout this process was built with
+     * @param name Shared memory segment name (without leading slash)
+     * @param expected Element size, capacity and payload size we expect
+     * @param writable Map read-write (see the constructor)
+     * @param options Where to look for a huge page segment (see ShmOptions)
+     * @throws std::runtime_error if the segment is missing, not ready, or
+     *         was created with a different layout version or geometry
+     */
+    static SharedMemoryManager attach_segment(const std::string& name, const ShmLayout& expected,
+                                              bool writable = false,
+                                              const ShmOptions& options = ShmOptions{}) {
+        SharedMemoryManager shm(name, 0, false, writable, options);
+        shm.validate_header(expected);
+        return shm;
     }
 
     /**
@@ -99,7 +398,9 @@ public:
     // Enable move constructor and assignment operator
     SharedMemoryManager(SharedMemoryManager&& other) noexcept
         : shm_fd_(other.shm_fd_), mapped_addr_(other.mapped_addr_), 
-          size_(other.size_), name_(std::move(other.name_)), is_creator_(other.is_creator_) {
+          size_(other.size_), name_(std::move(other.name_)), is_creator_(other.is_creator_),
+          persist_(other.persist_), backing_(other.backing_), page_size_(other.page_size_), mapped_bytes_(other.mapped_bytes_),
+          path_(std::move(other.path_)), locked_(other.locked_), prefaulted_pages_(other.prefaulted_pages_) {
         other.shm_fd_ = -1;
         other.mapped_addr_ = MAP_FAILED;
         other.is_creator_ = false;
@@ -114,6 +415,13 @@ public:
             size_ = other.size_;
             name_ = std::move(other.name_);
             is_creator_ = other.is_creator_;
+            persist_ = other.persist_;
+            backing_ = other.backing_;
+            page_size_ = other.page_size_;
+            mapped_bytes_ = other.mapped_bytes_;
+            path_ = std::move(other.path_);
+            locked_ = other.locked_;
+            prefaulted_pages_ = other.prefaulted_pages_;
             
             other.shm_fd_ = -1;
             other.mapped_addr_ = MAP_FAILED;
@@ -162,13 +470,268 @@ public:
         return is_creator_;
     }
 
+    /**
+     * True once the segment has been removed from the namespace (its creator
+     * exited, or a new creator replaced it). The mapping stays valid, but
+     * nothing will ever be written to it again
+     */
+    bool unlinked() const {
+        struct stat shm_stat;
+        return shm_fd_ != -1 && fstat(shm_fd_, &shm_stat) == 0 && shm_stat.st_nlink == 0;
+    }
+
+    /**
+     * Which pages back the mapping (huge pages may have been requested but
+     * unavailable)
+     */
+    ShmBacking backing() const {
+        return backing_;
+    }
+
+    /**
+     * Page size of the backing in bytes (4096, or e.g. 2MB for huge pages)
+     */
+    size_t page_size() const {
+        return page_size_;
+    }
+
+    /**
+     * True if the mapping is mlock()ed (ShmOptions::lock was set and the
+     * memlock limit allowed it)
+     */
+    bool locked() const {
+        return locked_;
+    }
+
+    /**
+     * Page faults taken while mapping instead of later on the hot path
+     * (0 unless populate, pretouch or lock was requested)
+     */
+    long prefaulted_pages() const {
+        return prefaulted_pages_;
+    }
+
+    /**
+     * Control header at the start of the segment (segments made with
+     * create_segment() / attach_segment() only)
+     */
+    ShmSegmentHeader* header() const {
+        return static_cast<ShmSegmentHeader*>(mapped_addr_);
+    }
+
+    /**
+     * Start of the payload behind the control header
+     */
+    void* payload() const {
+        return static_cast<char*>(mapped_addr_) + sizeof(ShmSegmentHeader);
+    }
+
+    /**
+     * Creator: publish the header once the payload is constructed
+     * Attaching processes refuse the segment until this is called
+     */
+    void mark_ready() {
+        header()->magic.store(SHM_SEGMENT_MAGIC, std::memory_order_release);
+    }
+
+    /**
+     * Creator incarnation recorded in the header (see ShmSegmentHeader)
+     */
+    uint32_t generation() const {
+        return header()->generation.load(std::memory_order_acquire);
+    }
+
+    /**
+     * Creator: record a sign of life, read by attached processes
+     */
+    void heartbeat(int64_t now_ns = shm_clock_ns()) {
+        header()->heartbeat_ns.store(now_ns, std::memory_order_relaxed);
+    }
+
+    /**
+     * Check the control header against the layout we were built with
+     * @throws std::runtime_error describing the first mismatch found
+     */
+    void validate_header(const ShmLayout& expected) const {
+        if (size_ < sizeof(ShmSegmentHeader)) {
+            throw std::runtime_error("Shared memory segment " + name_ + " is too small for a header");
+        }
+        const ShmSegmentHeader* hdr = header();
+        if (hdr->magic.load(std::memory_order_acquire) != SHM_SEGMENT_MAGIC) {
+            throw std::runtime_error("Shared memory segment " + name_ +
+                                     " has no valid header (not initialised yet, or not an HFT segment)");
+        }
+        if (hdr->layout_version != SHM_LAYOUT_VERSION) {
+            throw std::runtime_error("Shared memory segment " + name_ + " has layout version " +
+                                     std::to_string(hdr->layout_version) + ", expected " +
+                                     std::to_string(SHM_LAYOUT_VERSION));
+        }
+        if (hdr->payload_offset != sizeof(ShmSegmentHeader) ||
+            hdr->element_size != expected.element_size ||
+            hdr->capacity != expected.capacity ||
+            hdr->payload_bytes != expected.payload_bytes) {
+            throw std::runtime_error("Shared memory segment " + name_ + " geometry mismatch: " +
+                                     std::to_string(hdr->capacity) + " x " +
+                                     std::to_string(hdr->element_size) + " bytes (" +
+                                     std::to_string(hdr->payload_bytes) + " total), expected " +
+                                     std::to_string(expected.capacity) + " x " +
+                                     std::to_string(expected.element_size) + " bytes (" +
+                                     std::to_string(expected.payload_bytes) + " total)");
+        }
+        if (size_ < hdr->payload_offset + hdr->payload_bytes) {
+            throw std::runtime_error("Shared memory segment " + name_ + " is smaller than its header claims");
+        }
+    }
+
 private:
+    static size_t round_up(size_t bytes, size_t page) {
+        return (bytes + page - 1) / page * page;
+    }
+
+    /**
+     * Huge page size of the hugetlbfs mounted at dir, or 0 if there is none
+     */
+    static size_t hugetlbfs_page_size(const char* dir) {
+#ifdef __linux__
+        struct statfs fs;
+        if (dir != nullptr && statfs(dir, &fs) == 0 && fs.f_type == HUGETLBFS_MAGIC) {
+            return static_cast<size_t>(fs.f_bsize);
+        }
+#else
+        (void)dir;
+#endif
+        return 0;
+    }
+
+    /**
+     * Try to create the segment as a file on hugetlbfs
+     * @return False (with nothing left behind) if hugetlbfs is not mounted
+     *         or the kernel has too few huge pages reserved for the mapping
+     */
+    bool create_huge(const char* dir, int map_flags) {
+        const size_t huge_page = hugetlbfs_page_size(dir);
+        if (huge_page == 0) {
+            return false;
+        }
+        
+        const std::string path = std::string(dir) + name_;
+        int fd = open(path.c_str(), O_CREAT | O_RDWR, 0666);
+        if (fd == -1) {
+            return false;
+        }
+        
+        struct stat file_stat;
+        const bool sized = fstat(fd, &file_stat) == 0 &&
+            (file_stat.st_size != 0 || ftruncate(fd, static_cast<off_t>(round_up(size_, huge_page))) == 0);
+        
+        // Pages are reserved here: this fails with ENOMEM when none are left
+        void* addr = sized ? mmap(nullptr, round_up(size_, huge_page), PROT_READ | PROT_WRITE,
+                                  map_flags, fd, 0)
+                           : MAP_FAILED;
+        if (addr == MAP_FAILED) {
+            close(fd);
+            unlink(path.c_str());
+            return false;
+        }
+        
+        // Attachers try shm_open first; make sure they do not find a stale
+        // normal segment of the same name instead of ours
+        shm_unlink(name_.c_str());
+        
+        shm_fd_ = fd;
+        mapped_addr_ = addr;
+        mapped_bytes_ = round_up(size_, huge_page);
+        page_size_ = huge_page;
+        backing_ = ShmBacking::HugePages;
+        path_ = path;
+        return true;
+    }
+
+    /**
+     * Try to attach to a segment living on hugetlbfs
+     * @return False if there is no such segment
+     * @throws std::runtime_error if it exists but cannot be mapped
+     */
+    bool attach_huge(const char* dir, bool writable, int map_flags) {
+        const size_t huge_page = hugetlbfs_page_size(dir);
+        if (huge_page == 0) {
+            return false;
+        }
+        
+        const std::string path = std::string(dir) + name_;
+        int fd = open(path.c_str(), writable ? O_RDWR : O_RDONLY);
+        if (fd == -1) {
+            return false;
+        }
+        
+        struct stat file_stat;
+        if (fstat(fd, &file_stat) == -1) {
+            close(fd);
+            throw std::runtime_error("Failed to get shared memory stats");
+        }
+        const size_t segment_size = static_cast<size_t>(file_stat.st_size);
+        if (size_ == 0) {
+            size_ = segment_size;
+        }
+        if (size_ == 0 || size_ > segment_size) {
+            close(fd);
+            throw std::runtime_error("Shared memory segment " + name_ + " is smaller than requested (" +
+                                     std::to_string(segment_size) + " < " + std::to_string(size_) + " bytes)");
+        }
+        
+        void* addr = mmap(nullptr, round_up(size_, huge_page),
+                          writable ? (PROT_READ | PROT_WRITE) : PROT_READ, map_flags, fd, 0);
+        if (addr == MAP_FAILED) {
+            close(fd);
+            throw std::runtime_error("Failed to map huge page shared memory: " + path);
+        }
+        
+        shm_fd_ = fd;
+        mapped_addr_ = addr;
+        mapped_bytes_ = round_up(size_, huge_page);
+        page_size_ = huge_page;
+        backing_ = ShmBacking::HugePages;
+        path_ = path;
+        return true;
+    }
+
+    /**
+     * Fault in and lock the fresh mapping as requested, and record how many
+     * page faults that took (MAP_POPULATE faults are already counted)
+     */
+    void warm_up(const ShmOptions& options, bool writable, long faults_before) {
+        if (options.pretouch) {
+            bool populated = false;
+#if defined(MADV_POPULATE_READ) && defined(MADV_POPULATE_WRITE)
+            // Write-populating maps pages writable up front, so the first
+            // store does not fault either; neither variant changes the data
+            populated = madvise(mapped_addr_, mapped_bytes_,
+                                writable ? MADV_POPULATE_WRITE : MADV_POPULATE_READ) == 0;
+#endif
+            if (!populated) {
+                // Reads only: a write here could race with other processes
+                const volatile char* bytes = static_cast<const volatile char*>(mapped_addr_);
+                for (size_t offset = 0; offset < mapped_bytes_; offset += page_size_) {
+                    (void)bytes[offset];
+                }
+            }
+        }
+        
+        if (options.lock) {
+            locked_ = mlock(mapped_addr_, mapped_bytes_) == 0;
+        }
+        
+        if (options.populate || options.pretouch || options.lock) {
+            prefaulted_pages_ = minor_page_faults() - faults_before;
+        }
+    }
+
     /**
      * Internal cleanup method
      */
     void cleanup() {
         if (mapped_addr_ != MAP_FAILED) {
-            munmap(mapped_addr_, size_);
+            munmap(mapped_addr_, mapped_bytes_);
             mapped_addr_ = MAP_FAILED;
         }
         
@@ -177,9 +740,13 @@ private:
             shm_fd_ = -1;
         }
         
-        // Only unlink if we created the segment
-        if (is_creator_ && !name_.empty()) {
-            shm_unlink(name_.c_str());
+        // Only unlink if we created the segment (and were not asked to keep it)
+        if (is_creator_ && !persist_ && !name_.empty()) {
+            if (backing_ == ShmBacking::HugePages) {
+                unlink(path_.c_str());
+            } else {
+                shm_unlink(name_.c_str());
+            }
             is_creator_ = false;
         }
     }
@@ -0,0 +1,96 @@
+#pragma once
+
+// ============================================================================
+// SHARED TIMEBASE
+// ============================================================================
+// This header puts the publisher's clock calibration in shared memory, so
+// every process on the host stamps and measures time on the same timebase.
+// The publisher's Tsc FastClock calibrates the ClockTimebase in the segment
+// and keeps correcting it; consumers construct their FastClock on that
+// timebase and convert counter reads with exactly the same frequency, offset
+// and epoch. A one-way latency (receive stamp minus publish stamp) then
+// contains no calibration error between two clocks, only the time that passed.
+//
+//   hft_timebase                 ClockTimebase, written by the publisher
+//
+// Consumers that find no timebase (an older publisher, or one on another
+// host) fall back to calibrating their own clock.
+
+#include <new>
+#include <optional>
+#include <string>
+#include "fast_clock.hpp"
+#include "shared_memory.hpp"
+
+namespace hft {
+
+// Shared memory segment holding the publisher's timebase
+inline constexpr const char* TIMEBASE_SEGMENT = "hft_timebase";
+
+// ============================================================================
+// SharedTimebase
+// ============================================================================
+// Owns the mapping of the timebase segment. The publisher creates it before
+// its clock and passes timebase() to FastClock(ClockSource::Tsc, ...), which
+// must be destroyed first; consumers open it and pass timebase() to
+// FastClock(const ClockTimebase&).
+class SharedTimebase {
+private:
+    SharedMemoryManager shm_;
+    ClockTimebase* timebase_;
+
+    SharedTimebase(SharedMemoryManager&& shm, ClockTimebase* timebase) noexcept
+        : shm_(std::move(shm)), timebase_(timebase) {}
+
+    static ShmLayout layout() noexcept {
+        return ShmLayout{sizeof(ClockTimebase), 1, sizeof(ClockTimebase)};
+    }
+
+public:
+    // Create an uncalibrated timebase (replacing one left behind). Until its
+    // clock stores the first calibration, followers read CLOCK_REALTIME
+    static SharedTimebase create(const std::string& segment = TIMEBASE_SEGMENT,
+                                 const ShmOptions& options = ShmOptions{}) {
+        SharedMemoryManager shm = SharedMemoryManager::create_segment(segment, layout(), options);
+        ClockTimebase* timebase = new(shm.payload()) ClockTimebase();
+        shm.mark_ready();
+        return SharedTimebase(std::move(shm), timebase);
+    }
+
+    // Publisher restart: take over the timebase a previous owner left behind,
+    // so consumers following it carry on; the new clock recalibrates it in
+    // place. Creates one if there is none
+    // Throws std::runtime_error if its owner is still running
+    static SharedTimebase resume(const std::string& segment = TIMEBASE_SEGMENT,
+                                 const ShmOptions& options = ShmOptions{}) {
+        std::optional<SharedMemoryManager> shm = SharedMemoryManager::resume_segment(segment, layout(), options);
+        if (!shm) {
+            return create(segment, options);
+        }
+        ClockTimebase* timebase = static_cast<ClockTimebase*>(shm->payload());
+        return SharedTimebase(std::move(*shm), timebase);
+    }
+
+    // Attach read-only to the publisher's timebase
+    // Throws std::runtime_error if there is none, or it has another layout
+    static SharedTimebase open(const std::string& segment = TIMEBASE_SEGMENT) {
+        SharedMemoryManager shm = SharedMemoryManager::attach_segment(segment, layout());
+        ClockTimebase* timebase = static_cast<ClockTimebase*>(shm.payload());
+        return SharedTimebase(std::move(shm), timebase);
+    }
+
+    [[nodiscard]] ClockTimebase& timebase() noexcept { return *timebase_; }
+    [[nodiscard]] const ClockTimebase& timebase() const noexcept { return *timebase_; }
+
+    [[nodiscard]] const SharedMemoryManager& segment() const noexcept {
+        return shm_;
+    }
+
+    // True once a new (cold started) publisher has replaced the segment;
+    // open() again and FastClock::follow() the new timebase
+    [[nodiscard]] bool replaced() const {
+        return shm_.unlinked();
+    }
+};
+
+} // namespace hft
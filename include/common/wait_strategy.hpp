@@ -0,0 +1,206 @@
+#pragma once
+
+// ============================================================================
+// CONSUMER WAIT STRATEGIES
+// ============================================================================
+// This header provides the idle policies a ring reader can use while the ring
+// is empty. Each one trades wake-up latency against CPU usage differently, so
+// every deployment can choose:
+//
+//   Strategy        Wake-up latency        CPU while idle
+//   BusySpinWait    ~100 ns (cache miss)   100% of a core
+//   SpinYieldWait   spin, then ~1-5 us     100% (but gives way to others)
+//   BlockingWait    spin, then park_time   ~0%
+//
+// A strategy is a small stateful object with two hooks:
+//   idle()       called once per empty poll
+//   idle(park)   same, but a strategy that wants to sleep calls
+//                park(duration) instead of sleeping itself; readers pass a
+//                park that sleeps on the ring's doorbell when it has one, so
+//                the consumer wakes as soon as the writer publishes
+//   reset()      called after a poll that made progress
+// Readers take the strategy as a template parameter of poll(), so the idle
+// path is inlined and a busy-spinning consumer pays nothing for the choice.
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <thread>
+#include <time.h>
+
+namespace hft {
+
+// ============================================================================
+// CPU PAUSE HINT
+// ============================================================================
+
+// Tell the CPU we are in a spin-wait loop. On x86 PAUSE avoids the memory
+// order mis-speculation flush when the awaited line finally changes and
+// leaves execution resources to the sibling hyperthread
+inline void cpu_relax() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield" ::: "memory");
+#else
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+}
+
+// Default park: sleep in the kernel for the given duration
+inline void park_for(std::chrono::nanoseconds duration) noexcept {
+    timespec park{static_cast<time_t>(duration.count() / 1000000000),
+                  static_cast<long>(duration.count() % 1000000000)};
+    nanosleep(&park, nullptr);
+}
+
+// ============================================================================
+// WAIT STRATEGIES
+// ============================================================================
+
+// Spin on the ring with a pause hint; lowest latency, burns a whole core
+class BusySpinWait {
+public:
+    void idle() noexcept {
+        cpu_relax();
+    }
+
+    template<typename Park>
+    void idle(Park&&) noexcept {
+        cpu_relax();
+    }
+
+    void reset() noexcept {}
+
+    [[nodiscard]] static constexpr const char* name() noexcept {
+        return "busy-spin";
+    }
+};
+
+// Spin for spin_limit empty polls, then yield the CPU on every further one
+// Still 100% CPU when the core is otherwise idle, but other runnable threads
+// on the same core get to run instead of being starved by the spinner
+class SpinYieldWait {
+private:
+    uint32_t spin_limit_;
+    uint32_t spins_{0};
+
+public:
+    explicit SpinYieldWait(uint32_t spin_limit = 1000) noexcept
+        : spin_limit_(spin_limit) {}
+
+    void idle() noexcept {
+        if (spins_ < spin_limit_) {
+            ++spins_;
+            cpu_relax();
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+    template<typename Park>
+    void idle(Park&&) noexcept {
+        idle();
+    }
+
+    void reset() noexcept {
+        spins_ = 0;
+    }
+
+    [[nodiscard]] static constexpr const char* name() noexcept {
+        return "spin-yield";
+    }
+};
+
+// Spin, then yield, then park the thread in the kernel for park_time per
+// empty poll. Idle CPU drops to ~0%, at the cost of waking up to park_time
+// (plus the thread's timer slack, 50 us by default on Linux) late. When the
+// reader parks on a doorbell instead, it wakes within microseconds of the
+// next publish
+class BlockingWait {
+private:
+    uint32_t spin_limit_;
+    uint32_t yield_limit_;
+    std::chrono::nanoseconds park_time_;
+    uint32_t polls_{0};
+
+public:
+    explicit BlockingWait(uint32_t spin_limit = 100, uint32_t yield_limit = 100,
+                          std::chrono::nanoseconds park_time = std::chrono::microseconds(50)) noexcept
+        : spin_limit_(spin_limit), yield_limit_(yield_limit), park_time_(park_time) {}
+
+    void idle() noexcept {
+        idle(park_for);
+    }
+
+    template<typename Park>
+    void idle(Park&& park) noexcept {
+        if (polls_ < spin_limit_) {
+            ++polls_;
+            cpu_relax();
+        } else if (polls_ < spin_limit_ + yield_limit_) {
+            ++polls_;
+            std::this_thread::yield();
+        } else {
+            park(park_time_);
+        }
+    }
+
+    void reset() noexcept {
+        polls_ = 0;
+    }
+
+    [[nodiscard]] static constexpr const char* name() noexcept {
+        return "blocking";
+    }
+};
+
+// ============================================================================
+// RUNTIME SELECTION
+// ============================================================================
+
+enum class WaitStrategyKind {
+    BusySpin,
+    SpinYield,
+    Blocking
+};
+
+// Parse a strategy name as accepted on the command line
+// ("spin", "yield" or "block"); returns nothing for an unknown name
+[[nodiscard]] inline std::optional<WaitStrategyKind> parse_wait_strategy(std::string_view name) noexcept {
+    if (name == "spin" || name == BusySpinWait::name()) {
+        return WaitStrategyKind::BusySpin;
+    }
+    if (name == "yield" || name == SpinYieldWait::name()) {
+        return WaitStrategyKind::SpinYield;
+    }
+    if (name == "block" || name == BlockingWait::name()) {
+        return WaitStrategyKind::Blocking;
+    }
+    return std::nullopt;
+}
+
+// Call fn with a default-constructed strategy of the given kind, so a
+// strategy chosen at runtime still reaches the reader as a template argument
+template<typename Fn>
+decltype(auto) with_wait_strategy(WaitStrategyKind kind, Fn&& fn) {
+    switch (kind) {
+        case WaitStrategyKind::SpinYield: {
+            SpinYieldWait wait;
+            return fn(wait);
+        }
+        case WaitStrategyKind::Blocking: {
+            BlockingWait wait;
+            return fn(wait);
+        }
+        case WaitStrategyKind::BusySpin:
+        default: {
+            BusySpinWait wait;
+            return fn(wait);
+        }
+    }
+}
+
+} // namespace hft
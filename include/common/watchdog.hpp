@@ -0,0 +1,172 @@
+#pragma once
+
+// ============================================================================
+// SHARED MEMORY PEER WATCHDOG
+// ============================================================================
+// This header tells a stuck peer apart from a slow one, on either side of a
+// broadcast ring:
+//
+//   ReaderWatchdog    publisher side: samples every reader cursor and
+//                     reports readers that stopped making progress, how long
+//                     ago and how far behind they are, before they cause
+//                     back-pressure (Gate) or start losing data (Overwrite)
+//   ProducerWatchdog  consumer side: reports a publisher whose segment
+//                     heartbeat went quiet, and whether its process is gone
+//
+// Both are sampled from a slow path (a status timer, an idle loop) and never
+// touch the ring's hot lines in between.
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <sys/types.h>
+#include "broadcast_ring.hpp"
+#include "shared_memory.hpp"
+
+namespace hft {
+
+// Monotonic nanoseconds for measuring how long a peer has been stalled
+inline int64_t watchdog_clock_ns() noexcept {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// ============================================================================
+// ReaderWatchdog
+// ============================================================================
+//
+// DESIGN:
+//   - A reader shows progress by advancing its position (consuming) or by
+//     bumping its heartbeat (empty polls, parking). The watchdog remembers
+//     both per cursor slot and when either last changed
+//   - A reader is stalled once neither has changed for stall_after. That
+//     catches a hung reader while it is still idle, before it falls behind
+//   - Readers whose process has died are reported too, so the publisher can
+//     evict them rather than wait for the next attach to reclaim the slot
+//
+template<typename Ring>
+class ReaderWatchdog {
+public:
+    using CursorTable = typename Ring::CursorTable;
+
+    // One stalled reader, as passed to the check() callback
+    struct ReaderStall {
+        size_t id;           // Reader slot index
+        pid_t pid;           // Process that registered the reader
+        bool alive;          // That process still exists
+        uint64_t lag;        // Messages published but not yet consumed
+        int64_t stalled_ns;  // Time since the reader last showed progress
+        bool first_report;   // First check() to report this stall
+    };
+
+private:
+    // What we last saw of one cursor slot
+    struct Sample {
+        bool tracked = false;
+        int32_t pid = 0;
+        uint64_t position = 0;
+        uint64_t heartbeat = 0;
+        int64_t progress_ns = 0;  // When position or heartbeat last changed
+        bool reported = false;
+    };
+
+    const Ring* ring_;
+    const CursorTable* table_;
+    int64_t stall_after_ns_;
+    Sample samples_[Ring::max_readers()];
+
+public:
+    ReaderWatchdog(const Ring& ring, const CursorTable& table, std::chrono::nanoseconds stall_after) noexcept
+        : ring_(&ring), table_(&table), stall_after_ns_(stall_after.count()) {}
+
+    // Sample every active reader and call on_stall(const ReaderStall&) for
+    // each stalled one; returns the number of stalled readers
+    template<typename OnStall>
+    size_t check(OnStall&& on_stall, int64_t now_ns = watchdog_clock_ns()) {
+        const uint64_t published = ring_->published();
+        size_t stalled = 0;
+        for (size_t i = 0; i < Ring::max_readers(); ++i) {
+            const auto& cursor = table_->readers[i];
+            Sample& sample = samples_[i];
+            if (cursor.state.load(std::memory_order_acquire) != CursorTable::READER_ACTIVE) {
+                sample.tracked = false;
+                continue;
+            }
+
+            const int32_t pid = cursor.pid.load(std::memory_order_relaxed);
+            const uint64_t position = cursor.position.load(std::memory_order_acquire);
+            const uint64_t heartbeat = cursor.heartbeat.load(std::memory_order_relaxed);
+
+            // New reader in this slot, or one that showed progress
+            if (!sample.tracked || sample.pid != pid ||
+                sample.position != position || sample.heartbeat != heartbeat) {
+                const bool same_reader = sample.tracked && sample.pid == pid;
+                sample = Sample{true, pid, position, heartbeat, now_ns, false};
+                if (same_reader || process_alive(pid)) {
+                    continue;
+                }
+            }
+
+            const bool alive = process_alive(pid);
+            const int64_t stalled_ns = now_ns - sample.progress_ns;
+            if (stalled_ns < stall_after_ns_ && alive) {
+                continue;
+            }
+
+            on_stall(ReaderStall{i, static_cast<pid_t>(pid), alive,
+                                 published > position ? published - position : 0,
+                                 stalled_ns, !sample.reported});
+            sample.reported = true;
+            ++stalled;
+        }
+        return stalled;
+    }
+
+    [[nodiscard]] std::chrono::nanoseconds stall_after() const noexcept {
+        return std::chrono::nanoseconds(stall_after_ns_);
+    }
+};
+
+// ============================================================================
+// ProducerWatchdog
+// ============================================================================
+// Watches the heartbeat the creator of a segment stores in its header
+// (SharedMemoryManager::heartbeat()). The publisher beats on a timer in its
+// loop (every 50ms, with its reader watchdog) whether or not it has anything
+// to publish, so silence means it is stuck or gone, not just a quiet market.
+class ProducerWatchdog {
+public:
+    struct Status {
+        int32_t pid;         // Creator recorded in the header
+        bool alive;          // That process still exists
+        int64_t silent_ns;   // Time since its last heartbeat
+        bool stalled;        // Silent for at least stall_after, or gone
+        bool first_report;   // First check() to find this stall
+    };
+
+private:
+    int64_t stall_after_ns_;
+    bool reported_{false};
+
+public:
+    explicit ProducerWatchdog(std::chrono::nanoseconds stall_after) noexcept
+        : stall_after_ns_(stall_after.count()) {}
+
+    // Heartbeats are wall-clock (shm_clock_ns()) so processes can compare them
+    Status check(const ShmSegmentHeader& header, int64_t now_ns = shm_clock_ns()) noexcept {
+        const int32_t pid = header.creator_pid;
+        const int64_t silent_ns = now_ns - header.heartbeat_ns.load(std::memory_order_relaxed);
+        const bool alive = process_alive(pid);
+        const bool stalled = !alive || silent_ns >= stall_after_ns_;
+
+        const bool first_report = stalled && !reported_;
+        reported_ = stalled;
+        return Status{pid, alive, silent_ns, stalled, first_report};
+    }
+
+    [[nodiscard]] std::chrono::nanoseconds stall_after() const noexcept {
+        return std::chrono::nanoseconds(stall_after_ns_);
+    }
+};
+
+} // namespace hft
@@ -0,0 +1,148 @@
+// ============================================================================
+// HFT_TOP: LIVE METRICS MONITOR
+// ============================================================================
+// This process shows what the publisher and consumers are doing, live,
+// without touching them. Every process publishes its counters, gauges and
+// latency histograms in its own shared memory segment (see metrics.hpp);
+// hft_top finds those segments, maps them read-only and redraws a summary
+// every interval:
+//   - per process: pid, whether it is still running, uptime
+//   - counters with their rate over the last interval
+//   - gauges (readers, ring lag and occupancy, TCP clients, ...)
+//   - latency percentiles of each histogram
+// Reading a segment costs the writer nothing: no locks, no messages, and
+// only the cache lines the monitor happens to read.
+//
+// Usage: hft_top [interval_ms] [refreshes]   (default 1000, 0 = until Ctrl+C)
+
+#include "common/shared_memory.hpp"
+#include "common/latency_histogram.hpp"
+#include "common/metrics.hpp"
+#include <fmt/core.h>
+#include <chrono>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+namespace {
+
+// One monitored process: its table, and counter values at the last refresh
+struct Watched {
+  hft::MetricsRegistry metrics;
+  std::map<std::string, uint64_t> last_counters;
+  int64_t last_sample_ns = 0;
+
+  explicit Watched(hft::MetricsRegistry&& registry) : metrics(std::move(registry)) {}
+};
+
+void print_process(Watched& watched, int64_t now_ns) {
+  const hft::MetricsTable& table = watched.metrics.table();
+  const hft::ShmSegmentHeader& header = *watched.metrics.segment().header();
+  const double uptime_s = static_cast<double>(now_ns - header.start_time_ns) / 1e9;
+  fmt::print("{:<14} pid {:<8} {:<8} up {:.1f}s\n", table.process, header.creator_pid,
+            watched.metrics.owner_alive() ? "running" : "exited", uptime_s);
+
+  // Counters, with their rate since the previous refresh
+  const double elapsed_s = watched.last_sample_ns == 0 ? 0.0
+                         : static_cast<double>(now_ns - watched.last_sample_ns) / 1e9;
+  table.for_each_counter([&](const char* name, uint64_t value) {
+    auto last = watched.last_counters.find(name);
+    if (last != watched.last_counters.end() && elapsed_s > 0.0 && value >= last->second) {
+      fmt::print("  {:<22} {:>14} {:>12.1f}/s\n", name, value,
+                static_cast<double>(value - last->second) / elapsed_s);
+    } else {
+      fmt::print("  {:<22} {:>14} {:>14}\n", name, value, "-");
+    }
+    watched.last_counters[name] = value;
+  });
+  watched.last_sample_ns = now_ns;
+
+  // Gauges; a ring lag next to the ring capacity is also shown as occupancy
+  int64_t ring_lag = -1;
+  int64_t ring_capacity = 0;
+  table.for_each_gauge([&](const char* name, int64_t value) {
+    fmt::print("  {:<22} {:>14}\n", name, value);
+    if (std::string(name) == "ring_max_lag") {
+      ring_lag = value;
+    } else if (std::string(name) == "ring_capacity") {
+      ring_capacity = value;
+    }
+  });
+  if (ring_lag >= 0 && ring_capacity > 0) {
+    fmt::print("  {:<22} {:>13.2f}%\n", "ring_occupancy",
+              100.0 * static_cast<double>(ring_lag) / static_cast<double>(ring_capacity));
+  }
+
+  // Latency percentiles over the process's whole run
+  table.for_each_histogram([&](const char* name, const hft::SharedLatencyHistogram& shared) {
+    hft::LatencyHistogram snapshot;
+    snapshot.merge(shared);
+    const hft::LatencySummary latency = hft::LatencySummary::of(snapshot);
+    fmt::print("  {:<22} {:>14} samples | p50 {:.3f}μs | p90 {:.3f}μs | p99 {:.3f}μs | p99.9 {:.3f}μs | p99.99 {:.3f}μs | max {:.3f}μs\n",
+              name, latency.count, latency.p50_ns / 1000.0, latency.p90_ns / 1000.0,
+              latency.p99_ns / 1000.0, latency.p999_ns / 1000.0, latency.p9999_ns / 1000.0,
+              latency.max_ns / 1000.0);
+  });
+  fmt::print("\n");
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  const long interval_ms = argc > 1 ? std::strtol(argv[1], nullptr, 10) : 1000;
+  const long refreshes = argc > 2 ? std::strtol(argv[2], nullptr, 10) : 0;
+  if (interval_ms <= 0 || refreshes < 0) {
+    fmt::print("Usage: {} [interval_ms] [refreshes]\n", argv[0]);
+    return 1;
+  }
+
+  // Redraw in place on a terminal; append when piped to a file
+  const bool redraw = isatty(STDOUT_FILENO) != 0;
+
+  // Heap-allocated: the table maps stay put while the map rebalances
+  std::map<std::string, std::unique_ptr<Watched>> watched;
+
+  for (long refresh = 0; refreshes == 0 || refresh < refreshes; ++refresh) {
+    if (refresh > 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(interval_ms));
+    }
+
+    // Attach to new processes, forget ones whose segment is gone
+    const std::vector<std::string> segments = hft::MetricsRegistry::list();
+    for (auto it = watched.begin(); it != watched.end();) {
+      if (it->second->metrics.segment().unlinked()) {
+        it = watched.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    for (const std::string& segment : segments) {
+      if (watched.count(segment) == 0) {
+        try {
+          watched.emplace(segment, std::make_unique<Watched>(hft::MetricsRegistry::open(segment)));
+        } catch (const std::runtime_error&) {
+          // Still being created, or from an incompatible build; try again later
+        }
+      }
+    }
+
+    if (redraw) {
+      fmt::print("\033[H\033[2J");
+    }
+    fmt::print("hft_top | {} process(es) | every {}ms\n\n", watched.size(), interval_ms);
+    const int64_t now_ns = hft::shm_clock_ns();
+    for (auto& [segment, process] : watched) {
+      print_process(*process, now_ns);
+    }
+    if (watched.empty()) {
+      fmt::print("No metrics segments ({}*) found. Start the publisher or a consumer.\n\n",
+                hft::METRICS_SEGMENT_PREFIX);
+    }
+    std::fflush(stdout);
+  }
+  return 0;
+}
@@ -3,20 +3,43 @@
 // ============================================================================
 // This is the main entry point for the publisher process.
 // It will:
-//   1. Initialize shared memory and ring buffer
+//   1. Initialize shared memory channels (one ring each) and list them in
+//      the channel registry
 //   2. Generate random market data in a loop
-//   3. Push data to shared memory ring buffer (for Process B)
+//   3. Push data to the channel owning each instrument (for Process B)
 //   4. Send JSON messages over TCP (for Process C)
+//
+// Usage: publisher [channels] [warm] [stages] [doorbell]
+//   channels  number of shared memory channels (default 1: market_data.0
+//             carries everything)
+//   warm      keep the channels in shared memory on exit, and take over the
+//             ones a previous `publisher warm` left behind: attached
+//             consumers carry on, and sequence numbers continue
+//   stages    stamp every message as it is enqueued, serialized and written,
+//             so consumers can break its latency down by stage
+//   doorbell  ring a futex doorbell after every publish, so `shm_consumer
+//             block` sleeps until the next tick instead of on a timer. Off by
+//             default: each publish then pays a full fence and a load even
+//             while every consumer spins
 
 #include "common/market_data.hpp"
 #include "common/shared_memory.hpp"
 #include "common/ring_buffer.hpp"
+#include "common/broadcast_ring.hpp"
+#include "common/channel_registry.hpp"
+#include "common/watchdog.hpp"
 #include "common/fast_clock.hpp"
+#include "common/shared_timebase.hpp"
+#include "common/metrics.hpp"
+#include "common/async_logger.hpp"
 #include "common/performance_utils.hpp"
 #include <fmt/chrono.h> // For timestamp formatting
 #include <fmt/core.h>   // For fmt::print (fast, type-safe printing)
 #include <boost/asio.hpp>
 #include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
 #include <random>
 #include <thread>
 #include <chrono>
@@ -34,6 +57,9 @@ private:
     boost::asio::ip::tcp::acceptor acceptor_;
     std::set<std::shared_ptr<boost::asio::ip::tcp::socket>> clients_;
     mutable std::mutex clients_mutex_;
+    
+    // Stamps the Written stage on each message when set
+    const hft::FastClock* stage_clock_ = nullptr;
 
 public:
     TcpServer(boost::asio::io_context& io_context, short port)
@@ -136,6 +162,10 @@ private:
     }
 
 public:
+    void set_stage_clock(const hft::FastClock* clock) {
+        stage_clock_ = clock;
+    }
+    
     void broadcast_json(const std::string& json_message) {
         std::lock_guard<std::mutex> lock(clients_mutex_);
         
@@ -149,11 +179,16 @@ public:
                 continue;
             }
             
-            // Send JSON message + newline for message boundary
-            std::string message = json_message + "\n";
+            // Send JSON message + newline for message boundary; owned by the
+            // handler, since the write completes after we return
+            auto message = std::make_shared<std::string>(json_message);
+            if (stage_clock_ != nullptr) {
+                hft::MarketData::stamp_json(*message, hft::Stage::Written, stage_clock_->now());
+            }
+            *message += "\n";
             
-            boost::asio::async_write(*socket, boost::asio::buffer(message),
-                [socket](boost::system::error_code ec, std::size_t /*bytes_transferred*/) {
+            boost::asio::async_write(*socket, boost::asio::buffer(*message),
+                [socket, message](boost::system::error_code ec, std::size_t /*bytes_transferred*/) {
                     if (ec) {
                         // Error sending, socket will be cleaned up on next broadcast
                         fmt::print("Error sending to client: {}\n", ec.message());
@@ -170,11 +205,36 @@ public:
     }
 };
 
-int main() {
+int main(int argc, char* argv[]) {
   fmt::print("===========================================\n");
   fmt::print("   HFT Market Data Publisher (Process A)\n");
   fmt::print("===========================================\n\n");
 
+  // Number of shared memory channels to shard instruments across, whether
+  // to warm restart (resume channels left in shared memory), whether to
+  // stamp pipeline stages on every message, and whether to ring a doorbell
+  // for sleeping consumers
+  size_t channel_count = 1;
+  bool warm = false;
+  bool stage_stamps = false;
+  bool enable_doorbell = false;
+  for (int i = 1; i < argc; ++i) {
+    if (std::string(argv[i]) == "warm") {
+      warm = true;
+    } else if (std::string(argv[i]) == "stages") {
+      stage_stamps = true;
+    } else if (std::string(argv[i]) == "doorbell") {
+      enable_doorbell = true;
+    } else {
+      channel_count = std::strtoull(argv[i], nullptr, 10);
+    }
+  }
+  if (channel_count == 0 || channel_count > hft::MAX_CHANNELS) {
+    fmt::print("ERROR: Channel count must be between 1 and {}\n", hft::MAX_CHANNELS);
+    fmt::print("Usage: {} [channels] [warm] [stages] [doorbell]\n", argv[0]);
+    return 1;
+  }
+
   try {
     // ========================================================================
     // STEP 0: Apply Performance Optimizations
@@ -212,7 +272,7 @@ int main() {
     fmt::print("MarketData 64-byte aligned: {}\n", market_data_aligned ? "YES" : "NO");
     
     // Check RingBuffer alignment  
-    bool ring_buffer_aligned = hft::MemoryUtils::is_type_aligned<hft::RingBuffer>(64);
+    bool ring_buffer_aligned = hft::MemoryUtils::is_type_aligned<hft::ShmBroadcastRing>(64);
     fmt::print("RingBuffer 64-byte aligned: {}\n", ring_buffer_aligned ? "YES" : "NO");
     
     if (!market_data_aligned || !ring_buffer_aligned) {
@@ -235,31 +295,120 @@ int main() {
     // STEP 2: Initialize Fast Clock for timestamping
     // ========================================================================
     fmt::print("Initializing Fast Clock...\n");
-    hft::FastClock fast_clock;
+    
+    // Calibrated in shared memory, so consumers measure latency against our
+    // stamps on the same timebase. Kept across a warm restart like the channels
+    hft::ShmOptions timebase_options;
+    timebase_options.persist = warm;
+    hft::SharedTimebase shared_timebase = warm ? hft::SharedTimebase::resume(hft::TIMEBASE_SEGMENT, timebase_options)
+                                               : hft::SharedTimebase::create(hft::TIMEBASE_SEGMENT, timebase_options);
+    hft::FastClock fast_clock(hft::ClockSource::Tsc, &shared_timebase.timebase());
+    fmt::print("Clock source: {}", hft::clock_source_name(fast_clock.source()));
+    if (fast_clock.source() == hft::ClockSource::Tsc) {
+      fmt::print(" ({:.3f} GHz)", fast_clock.tsc_frequency_hz() / 1e9);
+    }
+    fmt::print(", shared as '{}'\n", hft::TIMEBASE_SEGMENT);
+    if (stage_stamps) {
+      fmt::print("Stamping pipeline stages (enqueued, serialized, written)\n");
+      tcp_server.set_stage_clock(&fast_clock);
+    }
     
     // ========================================================================
-    // STEP 3: Initialize Shared Memory and Ring Buffer
+    // STEP 3: Initialize Shared Memory Channels
     // ========================================================================
-    fmt::print("Creating shared memory segment...\n");
-    
-    // Calculate size needed for ring buffer
-    constexpr size_t ring_buffer_size = sizeof(hft::RingBuffer);
+    fmt::print("{} shared memory channels...\n", warm ? "Resuming" : "Creating");
     
-    // Create shared memory segment
-    hft::SharedMemoryManager shm_manager("hft_market_data", ring_buffer_size, true);
+    // Warm restart: everything we create outlives us, so the next
+    // `publisher warm` can take it over while consumers stay attached
+    hft::ShmOptions registry_options;
+    registry_options.persist = warm;
     
-    if (!shm_manager.is_valid()) {
-      fmt::print("ERROR: Failed to create shared memory\n");
-      return 1;
+    // Cold start: clear out channels an earlier warm run left behind
+    if (!warm) {
+      try {
+        for (const hft::ChannelDescriptor& stale : hft::ChannelRegistry::open().channels()) {
+          if (!hft::process_alive(stale.owner_pid)) {
+            hft::remove_channel_segments(stale.name, registry_options);
+          }
+        }
+      } catch (const std::runtime_error&) {
+        // No directory left behind
+      }
     }
     
-    fmt::print("Shared memory created successfully (size: {} bytes)\n", ring_buffer_size);
+    // Directory consumers use to discover our channels
+    hft::ChannelRegistry registry = warm ? hft::ChannelRegistry::resume(hft::CHANNEL_DIRECTORY_SEGMENT, registry_options)
+                                         : hft::ChannelRegistry::create(hft::CHANNEL_DIRECTORY_SEGMENT, registry_options);
+    
+    // Back each 8MB ring with huge pages when the host has some reserved:
+    // 4 TLB entries instead of ~2000. Falls back to normal pages otherwise
+    hft::ShmOptions shm_options;
+    shm_options.huge_pages = true;
+    shm_options.persist = warm;
+    
+    // Fault in and lock every page before the session opens, so building
+    // the first pass of ticks does not take a page fault per 4K
+    shm_options.populate = true;
+    shm_options.lock = true;
+    
+    // Reader cursors and the doorbell live in a second, small segment per
+    // channel: it is the only one consumers map writable, so they cannot
+    // corrupt the ring, and their cursor stores stay off the pages we
+    // stream ticks into
+    hft::ShmOptions cursor_options;
+    cursor_options.populate = true;
+    cursor_options.lock = true;
+    cursor_options.persist = warm;
     
-    // Get pointer to shared memory and construct ring buffer in-place
-    void* shm_addr = shm_manager.get_address();
-    hft::RingBuffer* ring_buffer = new(shm_addr) hft::RingBuffer();
+    // What to do when the slowest reader is a full ring behind:
+    //   Overwrite - keep the newest data; the lagging reader detects it was
+    //               lapped and reports its losses. The feed never blocks.
+    //   Gate      - hold the writer back for the slowest reader; when it is a
+    //               full ring behind we evict it (let it lap) below
+    constexpr hft::OverflowPolicy overflow_policy = hft::OverflowPolicy::Overwrite;
     
-    fmt::print("Ring buffer initialized in shared memory\n");
+    // Doorbell (`publisher doorbell`): lets `shm_consumer block` sleep until
+    // the next tick instead of on a timer. The Dekker handshake with sleeping
+    // readers costs a seq_cst fence and a load on every publish, sleeper or
+    // not, so it stays off unless asked for. A warm restart keeps whatever
+    // the resumed rings were built with
+    
+    // One broadcast ring per channel; instruments are sharded across them so
+    // a consumer can subscribe to part of the feed
+    using Channel = hft::BroadcastChannelWriter<hft::ShmBroadcastRing>;
+    std::vector<std::unique_ptr<Channel>> channels;
+    for (size_t shard = 0; shard < channel_count; ++shard) {
+      const std::string name = fmt::format("market_data.{}", shard);
+      channels.push_back(std::make_unique<Channel>(name, overflow_policy, enable_doorbell,
+                                                   shm_options, cursor_options, warm));
+      registry.add_channel(hft::ChannelDescriptor::for_ring<hft::ShmBroadcastRing>(
+          name, hft::MARKET_DATA_SCHEMA, hft::MARKET_DATA_SCHEMA_VERSION));
+      
+      const hft::SharedMemoryManager& segment = channels.back()->data_segment();
+      fmt::print("Channel '{}' -> {} ({} bytes, layout v{}, {}, {} pages prefaulted, locked: {})\n",
+                name, segment.get_name(), segment.get_size(), segment.header()->layout_version,
+                hft::shm_backing_name(segment.backing()), segment.prefaulted_pages(),
+                segment.locked() ? "YES" : "NO (check ulimit -l)");
+      if (channels.back()->resumed()) {
+        fmt::print("  resumed: generation {}, {} readers attached, continuing at sequence {}\n",
+                  segment.generation(), channels.back()->writer().active_readers(),
+                  channels.back()->ring().published());
+      }
+    }
+    
+    // Warm restart with fewer channels: drop the ones nobody publishes any more
+    for (const hft::ChannelDescriptor& stale : registry.channels()) {
+      if (!hft::process_alive(stale.owner_pid)) {
+        registry.remove_channel(stale.name);
+        hft::remove_channel_segments(stale.name, registry_options);
+      }
+    }
+    
+    fmt::print("Broadcast rings initialized in shared memory ({} channels, {} slots x {} bytes, up to {} readers each, {} on full{})\n",
+              channels.size(), hft::ShmBroadcastRing::capacity(), sizeof(hft::MarketData),
+              hft::ShmBroadcastRing::max_readers(),
+              overflow_policy == hft::OverflowPolicy::Overwrite ? "overwrite" : "gate",
+              channels.front()->ring().doorbell_enabled() ? ", doorbell" : "");
     
     // ========================================================================
     // STEP 4: Prepare Market Data Generation
@@ -294,9 +443,115 @@ int main() {
     fmt::print("Press Ctrl+C to stop\n\n");
     
     size_t message_count = 0;
+    const long faults_at_start = hft::minor_page_faults();
     size_t overflow_count = 0;
     
+    // Sequence numbers are per stream, so consumers can detect gaps: one
+    // counter per shared memory channel and one for the TCP feed, which
+    // carries every channel. Only consumed by published messages, so a
+    // resumed channel simply continues from what its ring has published
+    std::vector<uint64_t> next_sequence;
+    for (const auto& channel : channels) {
+      next_sequence.push_back(channel->ring().published());
+    }
+    uint64_t next_tcp_sequence = 0;
+    
+    // Readers and worst lag over all channels, for the status lines
+    struct FeedStatus {
+      size_t readers = 0;
+      uint32_t asleep = 0;
+      uint64_t max_lag = 0;
+      uint64_t published = 0;
+    };
+    auto feed_status = [&channels]() {
+      FeedStatus status;
+      for (const auto& channel : channels) {
+        auto slowest = channel->writer().slowest_reader();
+        status.readers += channel->writer().active_readers();
+        status.asleep += channel->writer().sleeping_readers();
+        status.max_lag = std::max(status.max_lag, slowest ? slowest->lag : 0);
+        status.published += channel->ring().published();
+      }
+      return status;
+    };
+    
+    // Reader watchdog: a reader whose cursor and heartbeat have both stood
+    // still for stall_after is stuck, not slow. Sampled a few times a second,
+    // so it never competes with readers for their cursor lines
+    constexpr auto stall_after = std::chrono::milliseconds(250);
+    constexpr int64_t watchdog_interval_ns = 50'000'000;
+    std::vector<hft::ReaderWatchdog<hft::ShmBroadcastRing>> watchdogs;
+    for (const auto& channel : channels) {
+      watchdogs.emplace_back(channel->ring(), channel->cursor_table(), stall_after);
+    }
+    int64_t next_watchdog_ns = 0;
+    size_t stalled_readers = 0;
+    
+    // Live counters for hft_top, in our own metrics segment. Each update is a
+    // plain store; feed gauges are refreshed with the watchdog
+    hft::MetricsRegistry metrics = hft::MetricsRegistry::create("publisher");
+    hft::Counter published_metric = metrics.counter("messages_published");
+    hft::Counter overflow_metric = metrics.counter("overflows");
+    hft::Counter tcp_sent_metric = metrics.counter("tcp_messages");
+    hft::Counter evicted_metric = metrics.counter("readers_evicted");
+    hft::Gauge readers_gauge = metrics.gauge("shm_readers");
+    hft::Gauge stalled_gauge = metrics.gauge("stalled_readers");
+    hft::Gauge max_lag_gauge = metrics.gauge("ring_max_lag");
+    hft::Gauge tcp_clients_gauge = metrics.gauge("tcp_clients");
+    metrics.gauge("ring_capacity").set(static_cast<int64_t>(hft::ShmBroadcastRing::capacity()));
+    metrics.gauge("channels").set(static_cast<int64_t>(channels.size()));
+    fmt::print("Publishing metrics in '{}'\n", hft::metrics_segment(getpid()));
+    
+    // Hardware counters around publishing each message, when asked for
+    // (HFT_PERF=1): two extra syscalls per message
+    hft::PerfCounters perf_counters(hft::PerfCounters::requested());
+    hft::PerfStats publish_perf;
+    if (perf_counters.available()) {
+      fmt::print("Hardware counters: on, reported per published message\n");
+    } else if (hft::PerfCounters::requested()) {
+      fmt::print("Hardware counters: unavailable ({})\n", perf_counters.status());
+    }
+    
+    // Status lines are formatted and written by a background thread, so a
+    // slow terminal never delays the next tick
+    hft::AsyncLogger logger;
+    logger.attach();
+    
     while (true) {
+      // Look for stuck or dead readers, and tell attached consumers we are
+      // still alive. Beating here rather than per message keeps the clock
+      // read and the store to each header line (which idle consumers poll)
+      // off the publish path; 50ms is a tenth of their stall threshold
+      if (hft::watchdog_clock_ns() >= next_watchdog_ns) {
+        next_watchdog_ns = hft::watchdog_clock_ns() + watchdog_interval_ns;
+        for (auto& each : channels) {
+          each->data_segment().heartbeat();
+        }
+        stalled_readers = 0;
+        for (size_t i = 0; i < channels.size(); ++i) {
+          auto& channel_writer = channels[i]->writer();
+          stalled_readers += watchdogs[i].check([&](const auto& stall) {
+            if (stall.first_report) {
+              logger.log("WARNING: Reader {} (pid {}) on '{}' {}: no progress for {:.1f}ms, {} messages behind\n",
+                        stall.id, stall.pid, channels[i]->name(), stall.alive ? "stalled" : "exited",
+                        stall.stalled_ns / 1e6, stall.lag);
+            }
+            // A dead reader will never catch up; stop gating on it
+            if (!stall.alive && channel_writer.evict_reader(stall.id)) {
+              evicted_metric.add();
+              logger.log("Evicted reader {} of exited process {} on '{}'\n",
+                        stall.id, stall.pid, channels[i]->name());
+            }
+          });
+        }
+        
+        const FeedStatus status = feed_status();
+        readers_gauge.set(static_cast<int64_t>(status.readers));
+        stalled_gauge.set(static_cast<int64_t>(stalled_readers));
+        max_lag_gauge.set(static_cast<int64_t>(status.max_lag));
+        tcp_clients_gauge.set(static_cast<int64_t>(tcp_server.get_client_count()));
+      }
+      
       // Generate random market data
       const std::string& instrument = instruments[gen() % instruments.size()];
       double bid = price_dist(gen);
@@ -304,40 +559,84 @@ int main() {
       double ask = bid + spread;
       int64_t timestamp = fast_clock.now();
       
-      // Create market data message
-      hft::MarketData market_data(instrument.c_str(), bid, ask, timestamp);
+      // Channel carrying this instrument
+      const size_t shard = std::hash<std::string>{}(instrument) % channels.size();
+      Channel& channel = *channels[shard];
+      auto& writer = channel.writer();
       
       // Memory optimization: prefetch the next ring buffer slot for writing
-      size_t next_write_idx = ring_buffer->get_write_index();
-      const hft::MarketData* buffer_addr = ring_buffer->get_buffer_address();
-      if (buffer_addr && next_write_idx < hft::RING_BUFFER_SIZE) {
-          hft::MemoryUtils::prefetch_write(&buffer_addr[next_write_idx]);
+      hft::MemoryUtils::prefetch_write(channel.ring().next_slot_address());
+      
+      const hft::PerfReading perf_start = perf_counters.read();
+      
+      // Claim the next slot (always succeeds in overwrite mode)
+      hft::MarketData* slot = writer.claim();
+      
+      if (slot == nullptr) {
+        // Gate mode: slowest reader is holding the ring; let it lap rather than drop
+        auto slowest = writer.slowest_reader();
+        if (slowest && writer.evict_reader(slowest->id)) {
+          logger.log("WARNING: Reader {} (pid {}) is {} messages behind, letting it lap\n",
+                    slowest->id, slowest->pid, slowest->lag);
+          slot = writer.claim();
+        }
       }
       
-      // Try to write to ring buffer
-      if (ring_buffer->try_write(market_data)) {
+      if (slot != nullptr) {
+        // Build the message directly in shared memory and publish it to every reader
+        new(slot) hft::MarketData(instrument.c_str(), bid, ask, timestamp, next_sequence[shard]++);
+        if (stage_stamps) {
+          slot->stamp(hft::Stage::Enqueued, fast_clock.now());
+        }
+        writer.commit();
         message_count++;
+        published_metric.set(message_count);
         
-        // Broadcast JSON to TCP clients
+        // Broadcast JSON to TCP clients, restamped with the TCP feed sequence
+        // Only this process writes the ring, so the slot is stable until we lap it
         if (tcp_server.get_client_count() > 0) {
-          std::string json_message = market_data.to_json();
-          tcp_server.broadcast_json(json_message);
+          hft::MarketData tcp_message = *slot;
+          tcp_message.sequence = next_tcp_sequence++;
+          std::string json = tcp_message.to_json();
+          if (stage_stamps) {
+            hft::MarketData::stamp_json(json, hft::Stage::Serialized, fast_clock.now());
+          }
+          tcp_server.broadcast_json(json);
+          tcp_sent_metric.add();
+        }
+        if (perf_counters.available()) {
+          publish_perf.add(perf_counters.read() - perf_start);
         }
         
         // Print status every 100 messages
         if (message_count % 100 == 0) {
-          fmt::print("Generated {} messages | Buffer usage: {}/{} | Overflows: {} | TCP clients: {}\n",
+          const FeedStatus status = feed_status();
+          logger.log("Generated {} messages | SHM readers: {} ({} asleep, {} stalled) | Max lag: {}/{} | Overflows: {} | TCP clients: {}\n",
                     message_count, 
-                    ring_buffer->available_for_read(),
-                    ring_buffer->capacity(),
+                    status.readers,
+                    status.asleep,
+                    stalled_readers,
+                    status.max_lag,
+                    hft::ShmBroadcastRing::capacity(),
                     overflow_count,
                     tcp_server.get_client_count());
+          // No cycles per ns here: the region includes the TCP send
+          // syscalls, whose kernel time the user-only cycle count misses
+          if (publish_perf.regions() > 0) {
+            logger.log("HW counters per message ({} msgs): {:.0f} cycles | {:.0f} instructions (IPC {:.2f}) | {:.1f} L1d misses | {:.2f} LLC misses | {:.2f} branch misses\n",
+                      publish_perf.regions(), publish_perf.per_region(hft::PerfEvent::Cycles),
+                      publish_perf.per_region(hft::PerfEvent::Instructions), publish_perf.ipc(),
+                      publish_perf.per_region(hft::PerfEvent::L1dMisses), publish_perf.per_region(hft::PerfEvent::LlcMisses),
+                      publish_perf.per_region(hft::PerfEvent::BranchMisses));
+            publish_perf.reset();
+          }
         }
       } else {
         overflow_count++;
+        overflow_metric.set(overflow_count);
         // Buffer is full, skip this message
         if (overflow_count % 10 == 1) {
-          fmt::print("WARNING: Ring buffer full, dropped message (total drops: {})\n", overflow_count);
+          logger.log("WARNING: Ring buffer full, dropped message (total drops: {})\n", overflow_count);
         }
       }
       
@@ -346,13 +645,21 @@ int main() {
       
       // Stop after generating 1000+ messages for this basic implementation
       if (message_count >= 1000) {
-        fmt::print("\nGenerated {} messages successfully!\n", message_count);
-        fmt::print("Ring buffer final state: {}/{} messages\n", 
-                  ring_buffer->available_for_read(), ring_buffer->capacity());
+        logger.log("\nGenerated {} messages successfully!\n", message_count);
+        const FeedStatus status = feed_status();
+        logger.log("Ring buffer final state: {} published on {} channels | {} readers | max lag {}/{}\n", 
+                  status.published, channels.size(), status.readers,
+                  status.max_lag, hft::ShmBroadcastRing::capacity());
+        logger.log("Minor page faults while publishing: {}\n", hft::minor_page_faults() - faults_at_start);
+        if (warm) {
+          logger.log("Leaving channels in shared memory for the next `publisher warm`\n");
+        }
         break;
       }
     }
     
+    logger.stop();
+    
     fmt::print("\n[Task 7.2 Complete] JSON streaming over TCP connections working!\n");
     fmt::print("Next: Add property tests for TCP functionality\n");
     
@@ -7,155 +7,604 @@
 //   - No data copying (both processes see the same memory)
 //   - No network stack overhead
 //
-// This consumer attaches to the existing shared memory segment created by
-// the publisher and polls the ring buffer for new messages using spin-wait.
+// This consumer looks up the publisher's channels in the channel registry,
+// attaches to the ones it wants, registers itself as a reader of each
+// channel's broadcast ring and polls them for new messages. Any number of
+// consumers can attach at once; each one sees every message of its channels.
+//
+// Usage: shm_consumer [spin|yield|block] [channel ...]
+//        shm_consumer list
+//   The first argument selects what the consumer does while its rings are
+//   empty (see wait_strategy.hpp): busy-spin (default, lowest latency), spin
+//   then yield, or sleep (~0% CPU when idle): on the ring's doorbell, woken
+//   by the publisher's next tick, when it runs with `publisher doorbell`,
+//   else on a short timer. Channels default to every channel the publisher
+//   registered; "list" prints them and exits.
 
 #include "common/market_data.hpp"
 #include "common/shared_memory.hpp"
 #include "common/ring_buffer.hpp"
+#include "common/broadcast_ring.hpp"
+#include "common/channel_registry.hpp"
+#include "common/watchdog.hpp"
 #include "common/fast_clock.hpp"
+#include "common/latency_histogram.hpp"
+#include "common/metrics.hpp"
+#include "common/shared_timebase.hpp"
+#include "common/wait_strategy.hpp"
+#include "common/performance_utils.hpp"
+#include "common/hiccup_meter.hpp"
+#include "common/async_logger.hpp"
 #include <fmt/chrono.h>
 #include <fmt/core.h>
 #include <chrono>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <string>
 #include <thread>
+#include <vector>
+
+namespace {
+
+// The publisher beats every 50ms from its ~1 kHz loop; this much silence
+// means it is stuck or gone
+constexpr auto publisher_stall_after = std::chrono::milliseconds(500);
+
+// One subscribed channel: its reader plus per-stream gap tracking and a
+// watchdog on the publisher's heartbeat
+struct Subscription {
+  hft::BroadcastChannelReader<hft::ShmBroadcastRing> channel;
+  hft::SequenceTracker sequence_tracker;
+  hft::ProducerWatchdog publisher_watchdog{publisher_stall_after};
+
+  Subscription(const std::string& name, const hft::ShmOptions& data_options,
+               const hft::ShmOptions& cursor_options)
+      : channel(name, data_options, cursor_options) {}
+};
+
+// The publisher's timebase, if it shares one
+std::optional<hft::SharedTimebase> open_timebase() {
+  try {
+    return hft::SharedTimebase::open();
+  } catch (const std::runtime_error&) {
+    return std::nullopt;
+  }
+}
+
+// Tail latency of a histogram: what the average hides
+void print_latency_percentiles(hft::AsyncLogger& logger, const char* label,
+                               const hft::LatencyHistogram& histogram) {
+  const hft::LatencySummary latency = hft::LatencySummary::of(histogram);
+  logger.log("{} ({} msgs): p50 {:.3f}μs | p90 {:.3f}μs | p99 {:.3f}μs | p99.9 {:.3f}μs | p99.99 {:.3f}μs | max {:.3f}μs\n",
+            label, latency.count, latency.p50_ns / 1000.0, latency.p90_ns / 1000.0, latency.p99_ns / 1000.0,
+            latency.p999_ns / 1000.0, latency.p9999_ns / 1000.0, latency.max_ns / 1000.0);
+}
+
+// Per-stage latency, when the publisher stamps stages (`publisher stages`)
+void print_stage_breakdown(hft::AsyncLogger& logger, const hft::StageBreakdown& breakdown) {
+  breakdown.for_each([&](hft::Stage stage, const hft::StageBreakdown::StageStats& stats) {
+    logger.log("  -> {:<10} mean {:9.3f}μs | min {:9.3f}μs | max {:9.3f}μs\n", hft::stage_name(stage),
+              stats.mean_ns() / 1000.0, stats.min_ns / 1000.0, stats.max_ns / 1000.0);
+  });
+}
+
+// A message slower than this is a spike worth matching against the hiccup
+// meter; at most max_latency_spikes are kept per report
+constexpr int64_t latency_spike_ns = 50000;
+constexpr size_t max_latency_spikes = 16;
+
+// What processing a tick needs from its slot, taken out while the slot is
+// peeked. Only trusted once release() confirms the publisher did not
+// overwrite the slot meanwhile (Overwrite mode laps slow readers)
+struct Tick {
+  uint64_t sequence;
+  int64_t receive_ns;
+  int64_t latency_ns;
+  hft::StageBreakdown::CarriedStamps stages;
+  char instrument[hft::INSTRUMENT_MAX_LEN];
+  double bid;
+  double ask;
+};
+
+Tick read_tick(const hft::MarketData& market_data, int64_t receive_ns) noexcept {
+  Tick tick;
+  tick.sequence = market_data.sequence;
+  tick.receive_ns = receive_ns;
+  tick.latency_ns = receive_ns - market_data.timestamp_ns;
+  tick.stages = hft::StageBreakdown::carried(market_data);
+  std::memcpy(tick.instrument, market_data.instrument, sizeof(tick.instrument));
+  tick.instrument[hft::INSTRUMENT_MAX_LEN - 1] = '\0';
+  tick.bid = market_data.bid;
+  tick.ask = market_data.ask;
+  return tick;
+}
+
+struct LatencySpike {
+  int64_t receive_ns;
+  int64_t latency_ns;
+};
 
-int main() {
+// Platform stalls since the last report, and whether one of them was under
+// way while each of our latency spikes was in flight
+void print_hiccups(hft::AsyncLogger& logger, hft::HiccupMeter& meter, hft::HiccupLog<>& log,
+                   std::vector<LatencySpike>& spikes, int64_t run_start_ns) {
+  const size_t drained = meter.drain([&](const hft::Hiccup& hiccup) { log.add(hiccup); });
+  hft::LatencyHistogram snapshot;
+  snapshot.merge(meter.histogram());
+  const hft::LatencySummary hiccups = hft::LatencySummary::of(snapshot);
+  logger.log("Hiccups on core {}{} (> {:.1f}μs): {} new, {} total | p50 {:.3f}μs | p99 {:.3f}μs | max {:.3f}μs | {} dropped\n",
+            meter.cpu(), meter.pinned() ? "" : " (not pinned)", meter.threshold_ns() / 1000.0, drained,
+            hiccups.count, hiccups.p50_ns / 1000.0, hiccups.p99_ns / 1000.0, hiccups.max_ns / 1000.0,
+            meter.dropped());
+  for (const LatencySpike& spike : spikes) {
+    const std::optional<hft::Hiccup> stall =
+        log.longest_overlapping(spike.receive_ns - spike.latency_ns, spike.receive_ns);
+    if (stall) {
+      logger.log("  spike {:.3f}μs at +{:.3f}s: platform stall of {:.3f}μs at the same time\n",
+                spike.latency_ns / 1000.0, (spike.receive_ns - run_start_ns) / 1e9, stall->gap_ns / 1000.0);
+    } else {
+      logger.log("  spike {:.3f}μs at +{:.3f}s: no platform stall on core {}\n",
+                spike.latency_ns / 1000.0, (spike.receive_ns - run_start_ns) / 1e9, meter.cpu());
+    }
+  }
+  spikes.clear();
+}
+
+// Where the time per message went, when hardware counters are on (HFT_PERF=1)
+void print_perf_counters(hft::AsyncLogger& logger, const hft::PerfStats& perf) {
+  if (perf.regions() == 0) {
+    return;
+  }
+  logger.log("HW counters per message ({} msgs): {:.0f} cycles | {:.0f} instructions (IPC {:.2f}) | {:.1f} L1d misses | {:.2f} LLC misses | {:.2f} branch misses | {:.2f} user cycles/ns\n",
+            perf.regions(), perf.per_region(hft::PerfEvent::Cycles), perf.per_region(hft::PerfEvent::Instructions),
+            perf.ipc(), perf.per_region(hft::PerfEvent::L1dMisses), perf.per_region(hft::PerfEvent::LlcMisses),
+            perf.per_region(hft::PerfEvent::BranchMisses), perf.user_cycles_per_ns());
+}
+
+void print_channels(const std::vector<hft::ChannelDescriptor>& channels) {
+  fmt::print("{} channel(s) registered:\n", channels.size());
+  for (const hft::ChannelDescriptor& channel : channels) {
+    fmt::print("  {:<20} {} v{} | {} slots x {} bytes | owner pid {}\n",
+              channel.name, channel.schema, channel.schema_version,
+              channel.capacity, channel.element_size, channel.owner_pid);
+  }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
   fmt::print("===========================================\n");
   fmt::print("   HFT Shared Memory Consumer (Process B)\n");
   fmt::print("===========================================\n\n");
 
+  const std::string first_arg = argc > 1 ? argv[1] : "spin";
+  const bool list_only = first_arg == "list";
+  const std::optional<hft::WaitStrategyKind> wait_kind = hft::parse_wait_strategy(first_arg);
+  if (!wait_kind && !list_only) {
+    fmt::print("ERROR: Unknown wait strategy '{}'\n", argv[1]);
+    fmt::print("Usage: {} [spin|yield|block] [channel ...]\n", argv[0]);
+    fmt::print("       {} list\n", argv[0]);
+    return 1;
+  }
+
   try {
     // ========================================================================
     // STEP 1: Initialize Fast Clock for latency measurement
     // ========================================================================
     fmt::print("Initializing Fast Clock for latency measurement...\n");
-    hft::FastClock fast_clock;
+    
+    // Convert with the publisher's own calibration, so a latency is the
+    // difference of two stamps on one timebase; calibrate our own without it
+    std::optional<hft::SharedTimebase> shared_timebase = open_timebase();
+    hft::FastClock fast_clock = shared_timebase ? hft::FastClock(shared_timebase->timebase())
+                                                : hft::FastClock(hft::ClockSource::Tsc);
+    fmt::print("Clock source: {}", hft::clock_source_name(fast_clock.source()));
+    if (fast_clock.source() == hft::ClockSource::Tsc) {
+      fmt::print(" ({:.3f} GHz)", fast_clock.tsc_frequency_hz() / 1e9);
+    }
+    fmt::print("{}\n", fast_clock.following() ? ", publisher's timebase" : ", own calibration");
     
     // ========================================================================
-    // STEP 2: Attach to existing shared memory segment
+    // STEP 2: Discover and attach to the publisher's channels
     // ========================================================================
-    fmt::print("Attaching to shared memory segment 'hft_market_data'...\n");
-    
-    // Calculate size needed for ring buffer (same as publisher)
-    constexpr size_t ring_buffer_size = sizeof(hft::RingBuffer);
+    fmt::print("Opening channel registry '{}'...\n", hft::CHANNEL_DIRECTORY_SEGMENT);
     
-    // Attach to existing shared memory segment in read-only mode
-    hft::SharedMemoryManager shm_manager("hft_market_data", ring_buffer_size, false);
+    // Throws if the publisher has not created it yet
+    const hft::ChannelRegistry registry = hft::ChannelRegistry::open();
+    const std::vector<hft::ChannelDescriptor> available = registry.channels();
+    print_channels(available);
+    if (list_only) {
+      return 0;
+    }
     
-    if (!shm_manager.is_valid()) {
-      fmt::print("ERROR: Failed to attach to shared memory segment.\n");
+    // Channels named on the command line, or everything the publisher offers
+    std::vector<std::string> wanted;
+    for (int i = 2; i < argc; ++i) {
+      wanted.emplace_back(argv[i]);
+    }
+    if (wanted.empty()) {
+      for (const hft::ChannelDescriptor& channel : available) {
+        wanted.emplace_back(channel.name);
+      }
+    }
+    if (wanted.empty()) {
+      fmt::print("ERROR: No channels to subscribe to.\n");
       fmt::print("Make sure the publisher (Process A) is running first.\n");
       return 1;
     }
     
-    fmt::print("Successfully attached to shared memory (size: {} bytes)\n", ring_buffer_size);
+    // Data segments are mapped read-only: we can never corrupt the feed.
+    // Fault in and lock them now, so the first pass over a ring does not
+    // take a page fault per 4K of ticks.
+    hft::ShmOptions shm_options;
+    shm_options.pretouch = true;
+    shm_options.lock = true;
     
-    // Get pointer to shared memory and cast to ring buffer
-    void* shm_addr = shm_manager.get_address();
-    hft::RingBuffer* ring_buffer = static_cast<hft::RingBuffer*>(shm_addr);
-    
-    fmt::print("Ring buffer attached successfully\n");
+    std::vector<std::unique_ptr<Subscription>> subscriptions;
+    for (const std::string& name : wanted) {
+      const std::optional<hft::ChannelDescriptor> descriptor = registry.find(name);
+      if (!descriptor) {
+        fmt::print("ERROR: Channel '{}' is not registered\n", name);
+        return 1;
+      }
+      if (std::string(descriptor->schema) != hft::MARKET_DATA_SCHEMA ||
+          descriptor->schema_version != hft::MARKET_DATA_SCHEMA_VERSION ||
+          !descriptor->readable_as<hft::ShmBroadcastRing>()) {
+        fmt::print("ERROR: Channel '{}' carries {} v{} in {} slots x {} bytes; we read {} v{} in {} slots x {} bytes\n",
+                  name, descriptor->schema, descriptor->schema_version,
+                  descriptor->capacity, descriptor->element_size,
+                  hft::MARKET_DATA_SCHEMA, hft::MARKET_DATA_SCHEMA_VERSION,
+                  hft::ShmBroadcastRing::capacity(), sizeof(hft::MarketData));
+        fmt::print("Rebuild publisher and shm_consumer from the same sources.\n");
+        return 1;
+      }
+      
+      // Validates both segment headers and the ring geometry; registers our cursor
+      subscriptions.push_back(std::make_unique<Subscription>(name, shm_options, shm_options));
+      
+      const auto& channel = subscriptions.back()->channel;
+      const hft::SharedMemoryManager& segment = channel.data_segment();
+      const hft::ShmSegmentHeader* header = segment.header();
+      fmt::print("Attached to '{}' as reader {} ({} readers active)\n",
+                name, channel.reader().id(), channel.cursor_table().active_readers());
+      fmt::print("  {} ({} bytes, layout v{}, {}) | prefaulted {} pages | memory locked: {}\n",
+                segment.get_name(), segment.get_size(), header->layout_version,
+                hft::shm_backing_name(segment.backing()), segment.prefaulted_pages(),
+                segment.locked() ? "YES" : "NO (check ulimit -l)");
+      fmt::print("  Publisher pid {} | up {:.1f}s | last heartbeat {:.1f}ms ago\n",
+                header->creator_pid,
+                (hft::shm_clock_ns() - header->start_time_ns) / 1e9,
+                (hft::shm_clock_ns() - header->heartbeat_ns.load(std::memory_order_relaxed)) / 1e6);
+    }
     
     // ========================================================================
     // STEP 3: Basic ring buffer polling loop
     // ========================================================================
-    fmt::print("\nStarting ring buffer polling loop...\n");
+    fmt::print("\nStarting ring buffer polling loop (wait strategy: {})...\n",
+              hft::with_wait_strategy(*wait_kind, [](auto& wait) { return wait.name(); }));
     fmt::print("Waiting for market data from publisher...\n");
     fmt::print("Press Ctrl+C to stop\n\n");
     
     size_t message_count = 0;
     size_t empty_polls = 0;
+    size_t torn_reads = 0;
     int64_t total_latency_ns = 0;
     int64_t min_latency_ns = INT64_MAX;
     int64_t max_latency_ns = 0;
+    hft::StageBreakdown stage_breakdown;
+    
+    // Latency distribution since the last report, and over the whole run
+    hft::LatencyHistogram interval_latency;
+    hft::LatencyHistogram run_latency;
+    
+    // Live counters for hft_top, in our own metrics segment. Each update is a
+    // plain store; totals summed over channels are refreshed while idle
+    hft::MetricsRegistry metrics = hft::MetricsRegistry::create("shm_consumer");
+    hft::Counter messages_metric = metrics.counter("messages");
+    hft::Counter empty_polls_metric = metrics.counter("empty_polls");
+    hft::Counter torn_reads_metric = metrics.counter("torn_reads");
+    hft::Counter lost_metric = metrics.counter("lost_lapped");
+    hft::Counter gaps_metric = metrics.counter("sequence_gaps");
+    hft::Counter missing_metric = metrics.counter("messages_missing");
+    hft::Gauge lag_gauge = metrics.gauge("reader_max_lag");
+    metrics.gauge("channels").set(static_cast<int64_t>(subscriptions.size()));
+    hft::SharedLatencyHistogram& latency_metric = metrics.histogram("latency_ns");
+    fmt::print("Publishing metrics in '{}'\n", hft::metrics_segment(getpid()));
+    const long faults_at_start = hft::minor_page_faults();
     
-    // Polling loop with spin-wait
-    while (true) {
-      hft::MarketData market_data;
+    // Totals across every subscribed channel
+    auto lost_messages = [&]() {
+      uint64_t lost = 0;
+      for (const auto& subscription : subscriptions) {
+        lost += subscription->channel.reader().lost_messages();
+      }
+      return lost;
+    };
+    auto times_lapped = [&]() {
+      uint64_t laps = 0;
+      for (const auto& subscription : subscriptions) {
+        laps += subscription->channel.reader().times_lapped();
+      }
+      return laps;
+    };
+    auto sequence_gaps = [&]() {
+      uint64_t gaps = 0;
+      for (const auto& subscription : subscriptions) {
+        gaps += subscription->sequence_tracker.gaps();
+      }
+      return gaps;
+    };
+    auto missing_messages = [&]() {
+      uint64_t missing = 0;
+      for (const auto& subscription : subscriptions) {
+        missing += subscription->sequence_tracker.missing();
+      }
+      return missing;
+    };
+    
+    // Hardware counters around processing each message in place, when asked
+    // for (HFT_PERF=1): two extra syscalls per message
+    hft::PerfCounters perf_counters(hft::PerfCounters::requested());
+    hft::PerfStats consume_perf;
+    hft::PerfStats run_consume_perf;
+    if (perf_counters.available()) {
+      fmt::print("Hardware counters: on, reported per consumed message\n");
+    } else if (hft::PerfCounters::requested()) {
+      fmt::print("Hardware counters: unavailable ({})\n", perf_counters.status());
+    }
+    
+    // Platform stalls on a chosen core, when asked for (HFT_HICCUP_CPU=<core>,
+    // -1 for unpinned; threshold HFT_HICCUP_US), to match our spikes against
+    std::unique_ptr<hft::HiccupMeter> hiccup_meter;
+    hft::HiccupLog<> hiccup_log;
+    std::vector<LatencySpike> latency_spikes;
+    const int64_t run_start_ns = fast_clock.now();
+    if (const std::optional<int> hiccup_cpu = hft::HiccupMeter::requested_cpu()) {
+      hiccup_meter = std::make_unique<hft::HiccupMeter>(*hiccup_cpu, hft::HiccupMeter::requested_threshold_ns());
+      latency_spikes.reserve(max_latency_spikes);
+      fmt::print("Hiccup meter: core {}, recording gaps over {:.1f}μs\n", *hiccup_cpu,
+                hiccup_meter->threshold_ns() / 1000.0);
+    }
+    
+    // Status lines are formatted and written by a background thread, so a
+    // slow terminal never holds up the polling loop
+    hft::AsyncLogger logger;
+    logger.attach();
+    
+    // Process one intact tick delivered by a channel's reader
+    auto process_tick = [&](Subscription& subscription, const Tick& tick) {
+      const int64_t latency_ns = tick.latency_ns;
+      if (hiccup_meter && latency_ns > latency_spike_ns && latency_spikes.size() < max_latency_spikes) {
+        latency_spikes.push_back(LatencySpike{tick.receive_ns, latency_ns});
+      }
       
-      // Try to read from ring buffer
-      if (ring_buffer->try_read(market_data)) {
-        // Calculate latency
-        int64_t receive_time = fast_clock.now();
-        int64_t latency_ns = receive_time - market_data.timestamp_ns;
-        
-        // Update latency statistics
-        total_latency_ns += latency_ns;
-        min_latency_ns = std::min(min_latency_ns, latency_ns);
-        max_latency_ns = std::max(max_latency_ns, latency_ns);
-        
-        message_count++;
+      // Detect messages we never saw (lapped, or torn and skipped)
+      // Sequences are per channel, so each stream is tracked on its own
+      uint64_t missing = subscription.sequence_tracker.on_message(tick.sequence);
+      if (missing > 0) {
+        logger.log("WARNING: Sequence gap on '{}', {} messages missing before #{}\n",
+                  subscription.channel.name(), missing, tick.sequence);
+      }
+      
+      // Update latency statistics
+      total_latency_ns += latency_ns;
+      min_latency_ns = std::min(min_latency_ns, latency_ns);
+      max_latency_ns = std::max(max_latency_ns, latency_ns);
+      interval_latency.record(latency_ns);
+      latency_metric.record(latency_ns);
+      stage_breakdown.record(tick.stages, tick.receive_ns);
+      
+      message_count++;
+      messages_metric.set(message_count);
+      
+      // Log received message with latency
+      if (message_count % 100 == 1 || message_count <= 10) {
+        logger.log("Received [{}]: {} | Bid: {:.2f} | Ask: {:.2f} | Latency: {:.3f}μs\n",
+                  subscription.channel.name(),
+                  tick.instrument,
+                  tick.bid,
+                  tick.ask,
+                  latency_ns / 1000.0); // Convert to microseconds
+      }
+      
+      // Print statistics every 100 messages
+      if (message_count % 100 == 0) {
+        double avg_latency_us = (total_latency_ns / message_count) / 1000.0;
+        double min_latency_us = min_latency_ns / 1000.0;
+        double max_latency_us = max_latency_ns / 1000.0;
         
-        // Log received message with latency
-        if (message_count % 100 == 1 || message_count <= 10) {
-          fmt::print("Received: {} | Bid: {:.2f} | Ask: {:.2f} | Latency: {:.3f}μs\n",
-                    market_data.instrument,
-                    market_data.bid,
-                    market_data.ask,
-                    latency_ns / 1000.0); // Convert to microseconds
+        logger.log("\n--- Statistics after {} messages ---\n", message_count);
+        logger.log("Average latency: {:.3f}μs\n", avg_latency_us);
+        logger.log("Min latency: {:.3f}μs\n", min_latency_us);
+        logger.log("Max latency: {:.3f}μs\n", max_latency_us);
+        print_latency_percentiles(logger, "Latency, last interval", interval_latency);
+        run_latency.merge(interval_latency);
+        interval_latency.reset();
+        print_stage_breakdown(logger, stage_breakdown);
+        print_perf_counters(logger, consume_perf);
+        run_consume_perf.add(consume_perf.total(), consume_perf.regions());
+        consume_perf.reset();
+        if (hiccup_meter) {
+          print_hiccups(logger, *hiccup_meter, hiccup_log, latency_spikes, run_start_ns);
         }
-        
-        // Print statistics every 100 messages
-        if (message_count % 100 == 0) {
-          double avg_latency_us = (total_latency_ns / message_count) / 1000.0;
-          double min_latency_us = min_latency_ns / 1000.0;
-          double max_latency_us = max_latency_ns / 1000.0;
-          
-          fmt::print("\n--- Statistics after {} messages ---\n", message_count);
-          fmt::print("Average latency: {:.3f}μs\n", avg_latency_us);
-          fmt::print("Min latency: {:.3f}μs\n", min_latency_us);
-          fmt::print("Max latency: {:.3f}μs\n", max_latency_us);
-          fmt::print("Empty polls: {}\n", empty_polls);
-          fmt::print("Buffer available: {}/{}\n", 
-                    ring_buffer->available_for_read(), ring_buffer->capacity());
-          fmt::print("----------------------------------------\n\n");
+        logger.log("Empty polls: {}\n", empty_polls);
+        for (const auto& subscription : subscriptions) {
+          // A quiet channel may not have delivered anything yet
+          const hft::SequenceTracker& tracker = subscription->sequence_tracker;
+          if (tracker.has_last()) {
+            logger.log("[{}] Reader lag: {}/{} | Last sequence: {}\n",
+                      subscription->channel.name(), subscription->channel.reader().lag(),
+                      subscription->channel.ring().capacity(), tracker.last());
+          } else {
+            logger.log("[{}] Reader lag: {}/{} | Last sequence: none\n",
+                      subscription->channel.name(), subscription->channel.reader().lag(),
+                      subscription->channel.ring().capacity());
+          }
         }
-        
-        // Reset empty poll counter when we successfully read
-        empty_polls = 0;
-        
-      } else {
-        // Buffer is empty, handle underflow condition
-        empty_polls++;
-        
-        // Avoid busy-waiting by adding a small delay when buffer is consistently empty
-        if (empty_polls > 1000) {
-          // After many empty polls, add a tiny sleep to reduce CPU usage
-          std::this_thread::sleep_for(std::chrono::microseconds(1));
-          
-          // Reset counter to avoid overflow
-          if (empty_polls > 10000) {
-            empty_polls = 1000;
+        logger.log("Lost (lapped): {} in {} laps | Torn reads: {}\n",
+                  lost_messages(), times_lapped(), torn_reads);
+        logger.log("Sequence gaps: {} ({} messages missing)\n", sequence_gaps(), missing_messages());
+        logger.log("----------------------------------------\n\n");
+      }
+    };
+    
+    // Publisher liveness and restarts, checked while idle. A silent heartbeat
+    // means the publisher is stuck or gone. A warm restart (`publisher warm`)
+    // takes our channel over in place: we keep our cursor and sequence numbers
+    // continue. A cold one replaces the channel, and we attach to the new one
+    constexpr int64_t replaced_check_interval_ns = 100'000'000;
+    int64_t next_replaced_check_ns = 0;
+    auto check_publisher = [&]() {
+      const int64_t now = fast_clock.now();
+      const bool check_replaced = now >= next_replaced_check_ns;
+      if (check_replaced) {
+        next_replaced_check_ns = now + replaced_check_interval_ns;
+        lost_metric.set(lost_messages());
+        gaps_metric.set(sequence_gaps());
+        missing_metric.set(missing_messages());
+        uint64_t max_lag = 0;
+        for (const auto& subscription : subscriptions) {
+          max_lag = std::max(max_lag, subscription->channel.reader().lag());
+        }
+        lag_gauge.set(static_cast<int64_t>(max_lag));
+      }
+      
+      // A cold started publisher calibrates a new timebase
+      if (check_replaced && shared_timebase && shared_timebase->replaced()) {
+        if (std::optional<hft::SharedTimebase> fresh = open_timebase()) {
+          fast_clock.follow(fresh->timebase());
+          shared_timebase = std::move(fresh);
+          logger.log("Following the new publisher's timebase\n");
+        }
+      }
+      
+      for (auto& subscription : subscriptions) {
+        auto& channel = subscription->channel;
+        if (channel.publisher_restarted()) {
+          logger.log("Publisher restarted on '{}' (generation {}, pid {}): reader carries on at sequence {}\n",
+                    channel.name(), channel.data_segment().generation(),
+                    channel.data_segment().header()->creator_pid, channel.reader().position());
+        }
+        if (check_replaced) {
+          const hft::ProducerWatchdog::Status publisher =
+              subscription->publisher_watchdog.check(*channel.data_segment().header());
+          if (publisher.first_report) {
+            logger.log("WARNING: Publisher of '{}' (pid {}) {}: no heartbeat for {:.1f}ms\n",
+                      channel.name(), publisher.pid, publisher.alive ? "stalled" : "exited",
+                      publisher.silent_ns / 1e6);
           }
         }
-        
-        // Print status occasionally when waiting
-        if (empty_polls % 100000 == 0) {
-          fmt::print("Waiting for data... (empty polls: {})\n", empty_polls);
+        if (check_replaced && channel.replaced()) {
+          try {
+            auto fresh = std::make_unique<Subscription>(channel.name(), shm_options, shm_options);
+            fresh->sequence_tracker = subscription->sequence_tracker;
+            subscription = std::move(fresh);
+            logger.log("Channel '{}' was recreated by a new publisher: reattached as reader {}\n",
+                      subscription->channel.name(), subscription->channel.reader().id());
+          } catch (const std::runtime_error&) {
+            // Not recreated yet; try again on a later check
+          }
         }
       }
+    };
+    
+    constexpr size_t target_messages = 1000;
+    
+    // Polling loop; the wait strategy decides what to do on an empty poll
+    hft::with_wait_strategy(*wait_kind, [&](auto& wait) {
+      while (true) {
+        // Drain everything the publisher has written to each channel since the
+        // last poll, reading each tick in place in shared memory instead of
+        // copying the whole message out. The slot is held only while the
+        // fields we need are read; nothing is counted until release() says
+        // they are intact
+        size_t drained = 0;
+        for (auto& subscription : subscriptions) {
+          auto& reader = subscription->channel.reader();
+          while (message_count < target_messages) {
+            const hft::MarketData* market_data = reader.peek();
+            if (market_data == nullptr) {
+              break;
+            }
+            const hft::PerfReading perf_start = perf_counters.read();
+            const Tick tick = read_tick(*market_data, fast_clock.now());
+            const bool intact = reader.release();
+            if (intact) {
+              process_tick(*subscription, tick);
+            }
+            if (perf_counters.available()) {
+              consume_perf.add(perf_counters.read() - perf_start);
+            }
+            if (!intact) {
+              // Publisher lapped us while we were reading this tick, so it may
+              // be torn: drop it. The reader has already skipped to the live
+              // cursor, and the sequence tracker sees the skip as a gap
+              torn_reads++;
+              torn_reads_metric.set(torn_reads);
+              break;
+            }
+            drained++;
+          }
+        }
       
-      // Exit condition for testing - stop after processing some messages
-      if (message_count >= 1000) {
-        fmt::print("\nProcessed {} messages successfully!\n", message_count);
+        if (drained > 0) {
+          wait.reset();
+        } else {
+          // Every ring is empty: idle according to the selected wait strategy
+          // With one channel, a strategy that sleeps parks on its ring's
+          // doorbell, so the publisher wakes us as soon as the next tick lands.
+          // A doorbell only covers one ring, so with several channels we park
+          // on a timer instead
+          empty_polls++;
+          empty_polls_metric.set(empty_polls);
+          check_publisher();
+          if (subscriptions.size() == 1) {
+            auto& reader = subscriptions.front()->channel.reader();
+            wait.idle([&](std::chrono::nanoseconds park_time) { reader.park(park_time); });
+          } else {
+            wait.idle(hft::park_for);
+          }
+        }
+      
+        // Exit condition for testing - stop after processing some messages
+        if (message_count >= target_messages) {
+          logger.log("\nProcessed {} messages successfully!\n", message_count);
         
-        // Final statistics
-        if (message_count > 0) {
-          double avg_latency_us = (total_latency_ns / message_count) / 1000.0;
-          double min_latency_us = min_latency_ns / 1000.0;
-          double max_latency_us = max_latency_ns / 1000.0;
+          // Final statistics
+          if (message_count > 0) {
+            double avg_latency_us = (total_latency_ns / message_count) / 1000.0;
+            double min_latency_us = min_latency_ns / 1000.0;
+            double max_latency_us = max_latency_ns / 1000.0;
           
-          fmt::print("\n=== Final Latency Statistics ===\n");
-          fmt::print("Messages processed: {}\n", message_count);
-          fmt::print("Average latency: {:.3f}μs\n", avg_latency_us);
-          fmt::print("Min latency: {:.3f}μs\n", min_latency_us);
-          fmt::print("Max latency: {:.3f}μs\n", max_latency_us);
-          fmt::print("Total empty polls: {}\n", empty_polls);
-          fmt::print("================================\n");
+            logger.log("\n=== Final Latency Statistics ===\n");
+            logger.log("Messages processed: {}\n", message_count);
+            logger.log("Average latency: {:.3f}μs\n", avg_latency_us);
+            logger.log("Min latency: {:.3f}μs\n", min_latency_us);
+            logger.log("Max latency: {:.3f}μs\n", max_latency_us);
+            run_latency.merge(interval_latency);
+            interval_latency.reset();
+            print_latency_percentiles(logger, "Latency, whole run", run_latency);
+            print_stage_breakdown(logger, stage_breakdown);
+            run_consume_perf.add(consume_perf.total(), consume_perf.regions());
+            consume_perf.reset();
+            print_perf_counters(logger, run_consume_perf);
+            if (hiccup_meter) {
+              hiccup_meter->stop();
+              print_hiccups(logger, *hiccup_meter, hiccup_log, latency_spikes, run_start_ns);
+            }
+            logger.log("Total empty polls: {}\n", empty_polls);
+            logger.log("Channels: {}\n", subscriptions.size());
+            logger.log("Messages lost to lapping: {} ({} laps)\n", lost_messages(), times_lapped());
+            logger.log("Sequence gaps: {} ({} messages missing)\n", sequence_gaps(), missing_messages());
+            logger.log("Minor page faults while consuming: {}\n", hft::minor_page_faults() - faults_at_start);
+            logger.log("================================\n");
+          }
+          break;
         }
-        break;
       }
-    }
+    });
+    logger.stop();
     
     fmt::print("\n[Task 9.1 Complete] Shared memory consumer with polling working!\n");
     fmt::print("Next: Add property tests for SHM consumer polling\n");
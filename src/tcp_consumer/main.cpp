@@ -8,6 +8,12 @@
 //   - Is the standard way exchanges deliver data
 
 #include "common/market_data.hpp"
+#include "common/fast_clock.hpp"
+#include "common/latency_histogram.hpp"
+#include "common/async_logger.hpp"
+#include "common/metrics.hpp"
+#include "common/shared_timebase.hpp"
+#include "common/performance_utils.hpp"
 #include <fmt/core.h>
 #include <fmt/chrono.h>
 #include <boost/asio.hpp>
@@ -15,6 +21,39 @@
 #include <iostream>
 #include <string>
 #include <chrono>
+#include <optional>
+
+namespace {
+
+// Tail latency of a histogram: what the average hides
+void print_latency_percentiles(hft::AsyncLogger& logger, const char* label,
+                               const hft::LatencyHistogram& histogram) {
+  const hft::LatencySummary latency = hft::LatencySummary::of(histogram);
+  logger.log("{} ({} msgs): p50 {:.3f}μs | p90 {:.3f}μs | p99 {:.3f}μs | p99.9 {:.3f}μs | p99.99 {:.3f}μs | max {:.3f}μs\n",
+            label, latency.count, latency.p50_ns / 1000.0, latency.p90_ns / 1000.0, latency.p99_ns / 1000.0,
+            latency.p999_ns / 1000.0, latency.p9999_ns / 1000.0, latency.max_ns / 1000.0);
+}
+
+// Per-stage latency, when the publisher stamps stages (`publisher stages`)
+void print_stage_breakdown(hft::AsyncLogger& logger, const hft::StageBreakdown& breakdown) {
+  breakdown.for_each([&](hft::Stage stage, const hft::StageBreakdown::StageStats& stats) {
+    logger.log("  -> {:<10} mean {:9.3f}μs | min {:9.3f}μs | max {:9.3f}μs\n", hft::stage_name(stage),
+              stats.mean_ns() / 1000.0, stats.min_ns / 1000.0, stats.max_ns / 1000.0);
+  });
+}
+
+// Where the parse time went, when hardware counters are on (HFT_PERF=1)
+void print_perf_counters(hft::AsyncLogger& logger, const hft::PerfStats& perf) {
+  if (perf.regions() == 0) {
+    return;
+  }
+  logger.log("HW counters per from_json ({} msgs): {:.0f} cycles | {:.0f} instructions (IPC {:.2f}) | {:.1f} L1d misses | {:.2f} LLC misses | {:.2f} branch misses | {:.2f} user cycles/ns\n",
+            perf.regions(), perf.per_region(hft::PerfEvent::Cycles), perf.per_region(hft::PerfEvent::Instructions),
+            perf.ipc(), perf.per_region(hft::PerfEvent::L1dMisses), perf.per_region(hft::PerfEvent::LlcMisses),
+            perf.per_region(hft::PerfEvent::BranchMisses), perf.user_cycles_per_ns());
+}
+
+} // namespace
 
 int main() {
   fmt::print("===========================================\n");
@@ -39,6 +78,19 @@ int main() {
     
     fmt::print("Successfully connected to publisher!\n\n");
     
+    // Stamp receive times on the publisher's timebase when it shares one
+    // (same host), so latency is not skewed by a second calibration
+    std::optional<hft::SharedTimebase> shared_timebase;
+    try {
+      shared_timebase = hft::SharedTimebase::open();
+    } catch (const std::runtime_error&) {
+      // Publisher on another host, or without a shared timebase
+    }
+    hft::FastClock fast_clock = shared_timebase ? hft::FastClock(shared_timebase->timebase())
+                                                : hft::FastClock(hft::ClockSource::Tsc);
+    fmt::print("Clock source: {}{}\n\n", hft::clock_source_name(fast_clock.source()),
+              fast_clock.following() ? ", publisher's timebase" : ", own calibration");
+    
     // ========================================================================
     // STEP 2: Message receiving and parsing loop
     // ========================================================================
@@ -49,10 +101,43 @@ int main() {
     size_t parse_errors = 0;
     boost::asio::streambuf buffer;
     
+    // Publisher sequence numbers: detects dropped messages, and tells us
+    // where we were if the connection goes away
+    hft::SequenceTracker sequence_tracker;
+    
     // Latency statistics tracking
     int64_t total_latency_ns = 0;
     int64_t min_latency_ns = INT64_MAX;
     int64_t max_latency_ns = 0;
+    hft::StageBreakdown stage_breakdown;
+    
+    // Latency distribution since the last report, and over the whole run
+    hft::LatencyHistogram interval_latency;
+    hft::LatencyHistogram run_latency;
+    
+    // Live counters for hft_top, in our own metrics segment
+    hft::MetricsRegistry metrics = hft::MetricsRegistry::create("tcp_consumer");
+    hft::Counter messages_metric = metrics.counter("messages");
+    hft::Counter parse_errors_metric = metrics.counter("parse_errors");
+    hft::Counter gaps_metric = metrics.counter("sequence_gaps");
+    hft::Counter missing_metric = metrics.counter("messages_missing");
+    hft::SharedLatencyHistogram& latency_metric = metrics.histogram("latency_ns");
+    
+    // Hardware counters around each MarketData::from_json, when asked for
+    // (HFT_PERF=1): two extra syscalls per message
+    hft::PerfCounters perf_counters(hft::PerfCounters::requested());
+    hft::PerfStats parse_perf;
+    hft::PerfStats run_parse_perf;
+    if (perf_counters.available()) {
+      fmt::print("Hardware counters: on, reported per parsed message\n");
+    } else if (hft::PerfCounters::requested()) {
+      fmt::print("Hardware counters: unavailable ({})\n", perf_counters.status());
+    }
+    
+    // Log lines are formatted and written by a background thread, so the
+    // receive loop never waits on stdout between two reads
+    hft::AsyncLogger logger;
+    logger.attach();
     
     while (true) {
       try {
@@ -70,15 +155,18 @@ int main() {
           message_count++;
           
           // Record receive timestamp for latency calculation
-          auto receive_time = std::chrono::high_resolution_clock::now();
-          auto receive_time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
-              receive_time.time_since_epoch()).count();
+          int64_t receive_time_ns = fast_clock.now();
           
           // ================================================================
           // STEP 3: Parse JSON message
           // ================================================================
           hft::MarketData market_data;
-          bool parse_success = hft::MarketData::from_json(json_line, market_data);
+          bool parse_success;
+          {
+            hft::ScopedPerfCounter perf_scope(perf_counters, parse_perf);
+            parse_success = hft::MarketData::from_json(json_line, market_data);
+          }
+          int64_t parsed_time_ns = fast_clock.now();
           
           if (parse_success) {
             // Calculate latency (receive_time - message_timestamp)
@@ -89,12 +177,25 @@ int main() {
             total_latency_ns += latency_ns;
             min_latency_ns = std::min(min_latency_ns, latency_ns);
             max_latency_ns = std::max(max_latency_ns, latency_ns);
+            interval_latency.record(latency_ns);
+            latency_metric.record(latency_ns);
+            messages_metric.set(message_count);
+            stage_breakdown.record(market_data, receive_time_ns, parsed_time_ns);
+            
+            uint64_t missing = sequence_tracker.on_message(market_data.sequence);
+            gaps_metric.set(sequence_tracker.gaps());
+            missing_metric.set(sequence_tracker.missing());
+            if (missing > 0) {
+              logger.log("WARNING: Sequence gap, {} messages missing before #{}\n",
+                        missing, market_data.sequence);
+            }
             
             // ============================================================
             // STEP 4: Structured logging with fmt
             // ============================================================
-            fmt::print("MSG #{:4d} | {} | BID: {:8.2f} | ASK: {:8.2f} | LATENCY: {:8.2f}μs\n",
+            logger.log("MSG #{:4d} | SEQ {:6d} | {} | BID: {:8.2f} | ASK: {:8.2f} | LATENCY: {:8.2f}μs\n",
                       message_count,
+                      market_data.sequence,
                       market_data.instrument,
                       market_data.bid,
                       market_data.ask,
@@ -106,21 +207,31 @@ int main() {
               double min_latency_us = min_latency_ns / 1000.0;
               double max_latency_us = max_latency_ns / 1000.0;
               
-              fmt::print("--- TCP Latency Stats after {} messages ---\n", message_count);
-              fmt::print("Average latency: {:.3f}μs | Min: {:.3f}μs | Max: {:.3f}μs | Parse errors: {}\n", 
+              logger.log("--- TCP Latency Stats after {} messages ---\n", message_count);
+              logger.log("Average latency: {:.3f}μs | Min: {:.3f}μs | Max: {:.3f}μs | Parse errors: {}\n", 
                         avg_latency_us, min_latency_us, max_latency_us, parse_errors);
+              print_latency_percentiles(logger, "Latency, last interval", interval_latency);
+              run_latency.merge(interval_latency);
+              interval_latency.reset();
+              print_stage_breakdown(logger, stage_breakdown);
+              print_perf_counters(logger, parse_perf);
+              run_parse_perf.add(parse_perf.total(), parse_perf.regions());
+              parse_perf.reset();
+              logger.log("Sequence gaps: {} ({} messages missing)\n",
+                        sequence_tracker.gaps(), sequence_tracker.missing());
             }
             
           } else {
             parse_errors++;
-            fmt::print("ERROR: Failed to parse JSON message #{}: {}\n", 
+            parse_errors_metric.set(parse_errors);
+            logger.log("ERROR: Failed to parse JSON message #{}: {}\n", 
                       message_count, json_line);
           }
           
           // Stop after receiving some messages for this implementation
           if (message_count >= 50) {
-            fmt::print("\nReceived and parsed {} messages successfully!\n", message_count);
-            fmt::print("Parse errors: {}\n", parse_errors);
+            logger.log("\nReceived and parsed {} messages successfully!\n", message_count);
+            logger.log("Parse errors: {}\n", parse_errors);
             
             // Final latency statistics
             if (message_count > 0) {
@@ -128,13 +239,22 @@ int main() {
               double min_latency_us = min_latency_ns / 1000.0;
               double max_latency_us = max_latency_ns / 1000.0;
               
-              fmt::print("\n=== Final TCP Latency Statistics ===\n");
-              fmt::print("Messages processed: {}\n", message_count);
-              fmt::print("Average latency: {:.3f}μs\n", avg_latency_us);
-              fmt::print("Min latency: {:.3f}μs\n", min_latency_us);
-              fmt::print("Max latency: {:.3f}μs\n", max_latency_us);
-              fmt::print("Parse errors: {}\n", parse_errors);
-              fmt::print("====================================\n");
+              logger.log("\n=== Final TCP Latency Statistics ===\n");
+              logger.log("Messages processed: {}\n", message_count);
+              logger.log("Average latency: {:.3f}μs\n", avg_latency_us);
+              logger.log("Min latency: {:.3f}μs\n", min_latency_us);
+              logger.log("Max latency: {:.3f}μs\n", max_latency_us);
+              run_latency.merge(interval_latency);
+              interval_latency.reset();
+              print_latency_percentiles(logger, "Latency, whole run", run_latency);
+              print_stage_breakdown(logger, stage_breakdown);
+              run_parse_perf.add(parse_perf.total(), parse_perf.regions());
+              parse_perf.reset();
+              print_perf_counters(logger, run_parse_perf);
+              logger.log("Parse errors: {}\n", parse_errors);
+              logger.log("Sequence gaps: {} ({} messages missing)\n",
+                        sequence_tracker.gaps(), sequence_tracker.missing());
+              logger.log("====================================\n");
             }
             break;
           }
@@ -142,21 +262,28 @@ int main() {
         
       } catch (const boost::system::system_error& e) {
         if (e.code() == boost::asio::error::eof) {
-          fmt::print("Publisher disconnected (EOF)\n");
+          logger.log("Publisher disconnected (EOF)\n");
           break;
         } else if (e.code() == boost::asio::error::connection_reset) {
-          fmt::print("Connection reset by publisher\n");
+          logger.log("Connection reset by publisher\n");
           break;
         } else {
-          fmt::print("Network error: {} ({})\n", e.what(), e.code().value());
+          logger.log("Network error: {} ({})\n", e.what(), e.code().value());
           break;
         }
       } catch (const std::exception& e) {
-        fmt::print("Unexpected error: {}\n", e.what());
+        logger.log("Unexpected error: {}\n", e.what());
         break;
       }
     }
     
+    logger.stop();
+    
+    // Where to resume from: the next connection should start after this
+    if (sequence_tracker.has_last()) {
+      fmt::print("Last sequence processed: {}\n", sequence_tracker.last());
+    }
+    
     fmt::print("\n[Task 8.2 Complete] JSON parsing and structured logging working!\n");
     fmt::print("Next: Add property tests for TCP consumer\n");
     
@@ -2,7 +2,18 @@
 #include <common/market_data.hpp>
 #include <common/fast_clock.hpp>
 #include <common/ring_buffer.hpp>
+#include <common/broadcast_ring.hpp>
+#include <common/byte_ring.hpp>
+#include <common/wait_strategy.hpp>
 #include <common/performance_utils.hpp>
+#include <common/shared_memory.hpp>
+#include <common/channel_registry.hpp>
+#include <common/watchdog.hpp>
+#include <common/shared_timebase.hpp>
+#include <common/latency_histogram.hpp>
+#include <common/metrics.hpp>
+#include <common/async_logger.hpp>
+#include <common/hiccup_meter.hpp>
 #include <string>
 #include <cstring>
 #include <random>
@@ -10,8 +21,14 @@
 #include <thread>
 #include <vector>
 #include <set>
+#include <memory>
+#include <type_traits>
 #include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
 #include <cstdlib>
+#include <algorithm>
+#include <cmath>
 
 using namespace hft;
 
@@ -606,6 +623,1970 @@ TEST_CASE("Property 11: Ring buffer state management", "[property][ring_buffer]"
     }
 }
 
+TEST_CASE("Property 16: Templated ring buffer geometry", "[property][ring_buffer]") {
+    // Feature: hft-market-data-system, Property 16: Templated ring buffer geometry
+    // Element type and capacity are compile-time parameters and are recorded
+    // in the ring so an attaching process can verify the layout
+    
+    // Small control-message ring with a non-MarketData element type
+    struct ControlMessage {
+        uint32_t command;
+        uint32_t argument;
+    };
+    using ControlRing = SpscRingBuffer<ControlMessage, 8>;
+    
+    auto control_ring = std::make_unique<ControlRing>();
+    REQUIRE(ControlRing::buffer_size() == 8);
+    REQUIRE(ControlRing::capacity() == 7);
+    REQUIRE(alignof(ControlRing) == 64);
+    
+    // Run property test with 100 iterations, wrapping the small ring many times
+    for (uint32_t i = 0; i < 100; ++i) {
+        uint32_t burst = 1 + (i % ControlRing::capacity());
+        for (uint32_t j = 0; j < burst; ++j) {
+            REQUIRE(control_ring->try_write(ControlMessage{i, j}));
+        }
+        REQUIRE(control_ring->available_for_read() == burst);
+        
+        for (uint32_t j = 0; j < burst; ++j) {
+            ControlMessage msg{};
+            REQUIRE(control_ring->try_read(msg));
+            REQUIRE(msg.command == i);
+            REQUIRE(msg.argument == j);
+        }
+        REQUIRE(control_ring->is_empty());
+    }
+    
+    // Geometry is readable from the raw address without knowing the type
+    RingGeometry control_geometry = read_ring_geometry(control_ring.get());
+    REQUIRE(control_geometry.element_size == sizeof(ControlMessage));
+    REQUIRE(control_geometry.slot_count == 8);
+    REQUIRE(control_geometry.total_bytes == sizeof(ControlRing));
+    REQUIRE(ControlRing::geometry_matches(control_geometry));
+    REQUIRE_FALSE(RingBuffer::geometry_matches(control_geometry));
+    
+    // Large shared memory ring: geometry and alias are consistent
+    auto shm_ring = std::make_unique<ShmRingBuffer>();
+    RingGeometry shm_geometry = read_ring_geometry(shm_ring.get());
+    REQUIRE(shm_geometry.element_size == sizeof(MarketData));
+    REQUIRE(shm_geometry.slot_count == SHM_RING_BUFFER_SIZE);
+    REQUIRE(shm_geometry.total_bytes == sizeof(ShmRingBuffer));
+    REQUIRE(ShmRingBuffer::capacity() == SHM_RING_BUFFER_SIZE - 1);
+    REQUIRE(ShmRingBuffer::geometry_matches(shm_geometry));
+    REQUIRE_FALSE(ShmRingBuffer::geometry_matches(read_ring_geometry(control_ring.get())));
+    
+    // The large ring holds far more than the default ring before refusing writes
+    MarketData data("BURST", 100.0, 100.5, 1);
+    for (size_t j = 0; j < RingBuffer::capacity() * 4; ++j) {
+        REQUIRE(shm_ring->try_write(data));
+    }
+    REQUIRE(shm_ring->available_for_read() == RingBuffer::capacity() * 4);
+    
+    // The default alias keeps its original geometry
+    REQUIRE(RingBuffer::buffer_size() == RING_BUFFER_SIZE);
+    REQUIRE(std::is_same_v<RingBuffer::value_type, MarketData>);
+}
+
+TEST_CASE("Property 17: Batched ring buffer transfer", "[property][ring_buffer]") {
+    // Feature: hft-market-data-system, Property 17: Batched ring buffer transfer
+    // try_write_n / try_read_n / consume_all must preserve FIFO order across
+    // wrap-around and never exceed the space or data actually available
+    
+    static std::random_device rd;
+    static std::mt19937 gen(rd());
+    std::uniform_int_distribution<size_t> batch_dist(1, RingBuffer::buffer_size() + 64);
+    
+    auto buffer = std::make_unique<RingBuffer>();
+    int64_t next_written = 0;
+    int64_t next_expected = 0;
+    
+    // Run property test with 100 iterations of random batch sizes
+    for (int i = 0; i < 100; ++i) {
+        // Producer: write a random-sized batch, clipped to the free space
+        size_t request = batch_dist(gen);
+        std::vector<MarketData> batch;
+        for (size_t j = 0; j < request; ++j) {
+            batch.emplace_back("BATCH", 100.0, 100.5, next_written + static_cast<int64_t>(j));
+        }
+        
+        size_t free_before = buffer->available_for_write();
+        size_t written = buffer->try_write_n(batch.data(), batch.size());
+        REQUIRE(written == std::min(request, free_before));
+        REQUIRE(buffer->available_for_read() == buffer->capacity() - free_before + written);
+        next_written += static_cast<int64_t>(written);
+        
+        // Consumer: alternate between copying out and draining in place
+        size_t ready = buffer->available_for_read();
+        size_t max_items = batch_dist(gen);
+        if (i % 2 == 0) {
+            std::vector<MarketData> out(max_items);
+            size_t read = buffer->try_read_n(out.data(), out.size());
+            REQUIRE(read == std::min(max_items, ready));
+            for (size_t j = 0; j < read; ++j) {
+                REQUIRE(out[j].timestamp_ns == next_expected++);
+            }
+        } else {
+            size_t consumed = buffer->consume_all([&](const MarketData& msg) {
+                REQUIRE(msg.timestamp_ns == next_expected++);
+            }, max_items);
+            REQUIRE(consumed == std::min(max_items, ready));
+        }
+    }
+    
+    // Drain the rest; everything written must come out exactly once, in order
+    buffer->consume_all([&](const MarketData& msg) {
+        REQUIRE(msg.timestamp_ns == next_expected++);
+    });
+    REQUIRE(next_expected == next_written);
+    REQUIRE(buffer->is_empty());
+    
+    // Batches on a full or empty ring move nothing
+    MarketData filler("FULL", 1.0, 2.0, 0);
+    while (buffer->try_write(filler)) {}
+    REQUIRE(buffer->try_write_n(&filler, 1) == 0);
+    MarketData sink;
+    while (buffer->try_read(sink)) {}
+    REQUIRE(buffer->try_read_n(&sink, 1) == 0);
+    REQUIRE(buffer->consume_all([](const MarketData&) {}) == 0);
+}
+
+TEST_CASE("Property 18: Broadcast ring delivers every message to every reader", "[property][broadcast_ring]") {
+    // Feature: hft-market-data-system, Property 18: Broadcast ring fan-out
+    // Independent readers must each see the full, ordered stream; the writer
+    // is gated by the slowest reader unless it evicts (laps) that reader
+    
+    using TestRing = BroadcastRing<MarketData, 64, 4>;
+    
+    SECTION("Every reader sees every message in order") {
+        auto ring = std::make_unique<TestRing>();
+        TestRing::Reader first(*ring);
+        TestRing::Reader second(*ring);
+        REQUIRE(first.id() != second.id());
+        REQUIRE(ring->active_readers() == 2);
+        
+        // Run property test with 100 iterations of random bursts
+        int64_t published = 0;
+        int64_t first_expected = 0;
+        int64_t second_expected = 0;
+        for (int i = 0; i < 100; ++i) {
+            int burst = 1 + (i * 7) % 40;
+            for (int j = 0; j < burst; ++j) {
+                REQUIRE(ring->try_publish(MarketData("FANOUT", 1.0, 2.0, published++)));
+            }
+            
+            // First reader copies one at a time, second drains in batches
+            MarketData msg;
+            while (first.try_read(msg)) {
+                REQUIRE(msg.timestamp_ns == first_expected++);
+            }
+            second.consume_all([&](const MarketData& m) {
+                REQUIRE(m.timestamp_ns == second_expected++);
+            });
+        }
+        REQUIRE(first_expected == published);
+        REQUIRE(second_expected == published);
+        REQUIRE(first.lost_messages() == 0);
+        REQUIRE(second.lost_messages() == 0);
+        REQUIRE(ring->published() == static_cast<uint64_t>(published));
+    }
+    
+    SECTION("Slowest reader gates the writer") {
+        auto ring = std::make_unique<TestRing>();
+        TestRing::Reader fast(*ring);
+        TestRing::Reader slow(*ring);
+        
+        MarketData msg;
+        for (size_t j = 0; j < TestRing::capacity(); ++j) {
+            REQUIRE(ring->try_publish(MarketData("GATE", 1.0, 2.0, static_cast<int64_t>(j))));
+            REQUIRE(fast.try_read(msg));
+        }
+        
+        // Slow reader has not consumed anything: the ring is full for it
+        REQUIRE_FALSE(ring->try_publish(MarketData("GATE", 1.0, 2.0, 999)));
+        auto slowest = ring->slowest_reader();
+        REQUIRE(slowest.has_value());
+        REQUIRE(slowest->id == slow.id());
+        REQUIRE(slowest->lag == TestRing::capacity());
+        REQUIRE(slowest->pid == getpid());
+        
+        // One read by the slow reader frees exactly one slot
+        REQUIRE(slow.try_read(msg));
+        REQUIRE(msg.timestamp_ns == 0);
+        REQUIRE(ring->try_publish(MarketData("GATE", 1.0, 2.0, 64)));
+        REQUIRE_FALSE(ring->try_publish(MarketData("GATE", 1.0, 2.0, 65)));
+    }
+    
+    SECTION("Evicted reader is lapped, resynchronises and counts losses") {
+        auto ring = std::make_unique<TestRing>();
+        TestRing::Reader slow(*ring);
+        
+        for (size_t j = 0; j < TestRing::capacity(); ++j) {
+            REQUIRE(ring->try_publish(MarketData("LAP", 1.0, 2.0, static_cast<int64_t>(j))));
+        }
+        REQUIRE_FALSE(ring->try_publish(MarketData("LAP", 1.0, 2.0, 64)));
+        
+        // Let the slow reader lap instead of dropping
+        REQUIRE(ring->evict_reader(slow.id()));
+        REQUIRE(ring->active_readers() == 0);
+        for (int64_t j = 64; j < 100; ++j) {
+            REQUIRE(ring->try_publish(MarketData("LAP", 1.0, 2.0, j)));
+        }
+        
+        // The reader notices, skips to the live cursor and reports the gap
+        MarketData msg;
+        REQUIRE_FALSE(slow.try_read(msg));
+        REQUIRE(slow.lost_messages() == 100);
+        REQUIRE(slow.position() == 100);
+        REQUIRE(ring->active_readers() == 1);
+        
+        // From there on it receives new messages normally and gates again
+        REQUIRE(ring->try_publish(MarketData("LAP", 1.0, 2.0, 100)));
+        REQUIRE(slow.try_read(msg));
+        REQUIRE(msg.timestamp_ns == 100);
+    }
+    
+    SECTION("Readers attach and detach while the writer keeps running") {
+        auto ring = std::make_unique<TestRing>();
+        for (int64_t j = 0; j < 10; ++j) {
+            REQUIRE(ring->try_publish(MarketData("ATTACH", 1.0, 2.0, j)));
+        }
+        
+        {
+            // A late reader starts at the live cursor, not at sequence 0
+            TestRing::Reader late(*ring);
+            REQUIRE(late.position() == 10);
+            REQUIRE(ring->try_publish(MarketData("ATTACH", 1.0, 2.0, 10)));
+            MarketData msg;
+            REQUIRE(late.try_read(msg));
+            REQUIRE(msg.timestamp_ns == 10);
+        }
+        REQUIRE(ring->active_readers() == 0);
+        
+        // All reader slots can be taken and released again
+        std::vector<std::unique_ptr<TestRing::Reader>> readers;
+        for (size_t j = 0; j < TestRing::max_readers(); ++j) {
+            readers.push_back(std::make_unique<TestRing::Reader>(*ring));
+        }
+        REQUIRE(ring->active_readers() == TestRing::max_readers());
+        REQUIRE_THROWS_AS(TestRing::Reader(*ring), std::runtime_error);
+        readers.pop_back();
+        REQUIRE_NOTHROW(readers.push_back(std::make_unique<TestRing::Reader>(*ring)));
+    }
+    
+    SECTION("Concurrent writer and readers") {
+        auto ring = std::make_unique<TestRing>();
+        constexpr int64_t total = 20000;
+        constexpr int num_readers = 3;
+        
+        std::vector<std::unique_ptr<TestRing::Reader>> readers;
+        for (int r = 0; r < num_readers; ++r) {
+            readers.push_back(std::make_unique<TestRing::Reader>(*ring));
+        }
+        
+        std::vector<int64_t> received(num_readers, 0);
+        std::vector<bool> in_order(num_readers, true);
+        std::vector<std::thread> threads;
+        for (int r = 0; r < num_readers; ++r) {
+            threads.emplace_back([&, r]() {
+                while (received[r] < total) {
+                    size_t got = readers[r]->consume_all([&](const MarketData& m) {
+                        if (m.timestamp_ns != received[r]) {
+                            in_order[r] = false;
+                        }
+                        ++received[r];
+                    });
+                    if (got == 0) {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+        
+        for (int64_t j = 0; j < total;) {
+            if (ring->try_publish(MarketData("MT", 1.0, 2.0, j))) {
+                ++j;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        
+        for (int r = 0; r < num_readers; ++r) {
+            REQUIRE(received[r] == total);
+            REQUIRE(in_order[r]);
+            REQUIRE(readers[r]->lost_messages() == 0);
+        }
+    }
+}
+
+TEST_CASE("Property 19: Overwrite-on-full broadcast ring", "[property][broadcast_ring]") {
+    // Feature: hft-market-data-system, Property 19: Overwrite-on-full seqlock ring
+    // In overwrite mode the writer never fails; a lagging reader detects that
+    // it was lapped, reports exactly how many messages it lost, and never
+    // returns a torn message
+    
+    using TestRing = BroadcastRing<MarketData, 64, 4>;
+    
+    SECTION("Writer never blocks and lapped readers count their losses") {
+        auto ring = std::make_unique<TestRing>(OverflowPolicy::Overwrite);
+        REQUIRE(ring->overflow_policy() == OverflowPolicy::Overwrite);
+        TestRing::Reader reader(*ring);
+        
+        // Run property test with 100 iterations of random overrun sizes
+        int64_t published = 0;
+        uint64_t expected_lost = 0;
+        for (int i = 0; i < 100; ++i) {
+            int64_t burst = 1 + (i * 37) % 200;
+            for (int64_t j = 0; j < burst; ++j) {
+                REQUIRE(ring->try_publish(MarketData("OVER", 1.0, 2.0, published++)));
+            }
+            
+            // More than a ring's worth behind: the first read detects the lap
+            // and jumps to the live cursor, otherwise everything is delivered
+            uint64_t lag = reader.lag();
+            int64_t first_expected = static_cast<int64_t>(reader.position());
+            MarketData msg;
+            if (lag > TestRing::capacity()) {
+                REQUIRE_FALSE(reader.try_read(msg));
+                expected_lost += lag;
+            } else {
+                for (uint64_t k = 0; k < lag; ++k) {
+                    REQUIRE(reader.try_read(msg));
+                    REQUIRE(msg.timestamp_ns == first_expected + static_cast<int64_t>(k));
+                }
+                REQUIRE_FALSE(reader.try_read(msg));
+            }
+            REQUIRE(reader.lost_messages() == expected_lost);
+            REQUIRE(reader.lag() == 0);
+        }
+    }
+    
+    SECTION("Concurrent overwrite never yields torn messages") {
+        auto ring = std::make_unique<TestRing>(OverflowPolicy::Overwrite);
+        TestRing::Reader reader(*ring);
+        std::atomic<bool> done{false};
+        constexpr int64_t total = 200000;
+        
+        // Every field is derived from the sequence, so a torn copy (fields
+        // from two different writes) is detectable
+        std::thread writer([&]() {
+            for (int64_t j = 0; j < total; ++j) {
+                MarketData msg("TORN", static_cast<double>(j), static_cast<double>(j) * 2.0, j);
+                REQUIRE(ring->try_publish(msg));
+            }
+            done.store(true, std::memory_order_release);
+        });
+        
+        int64_t delivered = 0;
+        int64_t last = -1;
+        bool consistent = true;
+        bool increasing = true;
+        auto check = [&](const MarketData& m) {
+            if (m.bid != static_cast<double>(m.timestamp_ns) || m.ask != m.bid * 2.0) {
+                consistent = false;
+            }
+            if (m.timestamp_ns <= last) {
+                increasing = false;
+            }
+            last = m.timestamp_ns;
+            ++delivered;
+        };
+        while (!done.load(std::memory_order_acquire)) {
+            if (reader.consume_all(check) == 0) {
+                std::this_thread::yield();
+            }
+        }
+        writer.join();
+        reader.consume_all(check);
+        
+        REQUIRE(consistent);
+        REQUIRE(increasing);
+        REQUIRE(static_cast<uint64_t>(delivered) + reader.lost_messages() == static_cast<uint64_t>(total));
+        REQUIRE(ring->published() == static_cast<uint64_t>(total));
+    }
+}
+
+TEST_CASE("Property 20: Zero-copy claim/commit and peek/release", "[property][ring_buffer][broadcast_ring]") {
+    // Feature: hft-market-data-system, Property 20: In-place message access
+    // Messages built in a claimed slot and read through peek() arrive intact
+    // and in order, and the in-place API respects the same full/empty and
+    // lapping rules as the copying API
+    
+    SECTION("SPSC ring in-place round trip") {
+        using TestRing = SpscRingBuffer<MarketData, 16>;
+        auto ring = std::make_unique<TestRing>();
+        
+        REQUIRE(ring->peek() == nullptr);
+        
+        // Run property test with 100 iterations of fill / drain cycles
+        int64_t next_write = 0;
+        int64_t next_read = 0;
+        for (int i = 0; i < 100; ++i) {
+            size_t burst = 1 + (i * 7) % TestRing::capacity();
+            for (size_t j = 0; j < burst; ++j) {
+                MarketData* slot = ring->claim();
+                REQUIRE(slot != nullptr);
+                new(slot) MarketData("INPLACE", 1.0, 2.0, next_write++);
+                ring->commit();
+            }
+            
+            const MarketData* msg = nullptr;
+            while ((msg = ring->peek()) != nullptr) {
+                REQUIRE(msg->timestamp_ns == next_read++);
+                REQUIRE(std::string(msg->instrument) == "INPLACE");
+                ring->release();
+            }
+            REQUIRE(next_read == next_write);
+        }
+        
+        // claim() fails exactly when try_write() would
+        for (size_t j = 0; j < TestRing::capacity(); ++j) {
+            MarketData* slot = ring->claim();
+            REQUIRE(slot != nullptr);
+            ring->commit();
+        }
+        REQUIRE(ring->claim() == nullptr);
+        REQUIRE(ring->is_full());
+    }
+    
+    SECTION("Broadcast ring: every reader sees messages built in place") {
+        using TestRing = BroadcastRing<MarketData, 64, 4>;
+        auto ring = std::make_unique<TestRing>();
+        TestRing::Reader first(*ring);
+        TestRing::Reader second(*ring);
+        
+        for (int64_t j = 0; j < 50; ++j) {
+            MarketData* slot = ring->claim();
+            REQUIRE(slot != nullptr);
+            new(slot) MarketData("BCAST", static_cast<double>(j), 2.0, j);
+            ring->commit();
+        }
+        REQUIRE(ring->published() == 50);
+        
+        for (TestRing::Reader* reader : {&first, &second}) {
+            for (int64_t j = 0; j < 50; ++j) {
+                const MarketData* msg = reader->peek();
+                REQUIRE(msg != nullptr);
+                REQUIRE(msg->timestamp_ns == j);
+                REQUIRE(msg->bid == static_cast<double>(j));
+                REQUIRE(reader->release());
+            }
+            REQUIRE(reader->peek() == nullptr);
+        }
+        
+        // Gating applies to claim() just like try_publish()
+        for (int64_t j = 0; j < 64; ++j) {
+            REQUIRE(ring->claim() != nullptr);
+            ring->commit();
+        }
+        REQUIRE(ring->claim() == nullptr);
+    }
+    
+    SECTION("Broadcast ring: release() reports a slot overwritten while peeked") {
+        using TestRing = BroadcastRing<MarketData, 64, 4>;
+        auto ring = std::make_unique<TestRing>(OverflowPolicy::Overwrite);
+        TestRing::Reader reader(*ring);
+        
+        REQUIRE(ring->try_publish(MarketData("OLD", 1.0, 2.0, 0)));
+        const MarketData* msg = reader.peek();
+        REQUIRE(msg != nullptr);
+        REQUIRE(msg->timestamp_ns == 0);
+        
+        // Writer laps the reader while it still holds the slot
+        for (int64_t j = 1; j <= 64; ++j) {
+            REQUIRE(ring->try_publish(MarketData("NEW", 1.0, 2.0, j)));
+        }
+        
+        REQUIRE_FALSE(reader.release());
+        REQUIRE(reader.times_lapped() == 1);
+        REQUIRE(reader.lost_messages() == 65);
+        REQUIRE(reader.position() == 65);
+        REQUIRE(reader.peek() == nullptr);
+    }
+}
+
+TEST_CASE("Property 21: Variable-length frame ring", "[property][byte_ring]") {
+    // Feature: hft-market-data-system, Property 21: Framed byte ring
+    // Frames of any size up to max_payload() arrive intact, in order and
+    // cache-line aligned, across any number of wrap-arounds
+    
+    using TestRing = ByteRing<1024>;
+    
+    // Payload of the given length whose bytes encode its sequence number
+    auto fill = [](std::vector<uint8_t>& payload, uint32_t length, uint32_t seq) {
+        payload.resize(length);
+        for (uint32_t k = 0; k < length; ++k) {
+            payload[k] = static_cast<uint8_t>(seq * 31 + k);
+        }
+    };
+    auto matches = [](const Frame& frame, uint32_t seq) {
+        const auto* bytes = reinterpret_cast<const uint8_t*>(frame.data);
+        for (uint32_t k = 0; k < frame.length; ++k) {
+            if (bytes[k] != static_cast<uint8_t>(seq * 31 + k)) {
+                return false;
+            }
+        }
+        return true;
+    };
+    
+    SECTION("Frame sizing and limits") {
+        REQUIRE(TestRing::frame_size(0) == 64);
+        REQUIRE(TestRing::frame_size(56) == 64);
+        REQUIRE(TestRing::frame_size(57) == 128);
+        REQUIRE(TestRing::max_frame_size() == 512);
+        
+        auto ring = std::make_unique<TestRing>();
+        REQUIRE(ring->geometry_matches(read_ring_geometry(ring.get())));
+        REQUIRE(ring->claim(1, static_cast<uint32_t>(TestRing::max_payload()) + 1) == nullptr);
+        REQUIRE(ring->claim(FRAME_TYPE_PADDING, 8) == nullptr);
+        REQUIRE(ring->claim(1, static_cast<uint32_t>(TestRing::max_payload())) != nullptr);
+    }
+    
+    SECTION("Heterogeneous frames round-trip across wrap-around") {
+        auto ring = std::make_unique<TestRing>();
+        std::mt19937 gen(42);
+        std::uniform_int_distribution<uint32_t> length_dist(0, static_cast<uint32_t>(TestRing::max_payload()));
+        std::vector<uint8_t> payload;
+        
+        // Run property test with 100 iterations of random frame bursts
+        uint32_t next_write = 0;
+        uint32_t next_read = 0;
+        std::vector<uint32_t> lengths;
+        for (int i = 0; i < 100; ++i) {
+            // Write until the ring refuses a frame
+            while (true) {
+                uint32_t length = length_dist(gen);
+                fill(payload, length, next_write);
+                uint16_t type = static_cast<uint16_t>(1 + next_write % 3);
+                if (!ring->try_write(type, payload.data(), length)) {
+                    break;
+                }
+                lengths.push_back(length);
+                ++next_write;
+            }
+            REQUIRE(next_write > next_read);
+            
+            // Drain half with peek/release, the rest with consume_all
+            Frame frame{};
+            while (next_read < next_write && next_read % 2 == 0 && ring->peek(frame)) {
+                REQUIRE(frame.type == 1 + next_read % 3);
+                REQUIRE(frame.length == lengths[next_read]);
+                REQUIRE(reinterpret_cast<uintptr_t>(frame.data) % FRAME_ALIGNMENT == sizeof(FrameHeader));
+                REQUIRE(matches(frame, next_read));
+                ring->release();
+                ++next_read;
+            }
+            ring->consume_all([&](const Frame& f) {
+                REQUIRE(f.type == 1 + next_read % 3);
+                REQUIRE(f.length == lengths[next_read]);
+                REQUIRE(matches(f, next_read));
+                ++next_read;
+            });
+            REQUIRE(next_read == next_write);
+            REQUIRE(ring->is_empty());
+        }
+    }
+    
+    SECTION("Small frames take one cache line each") {
+        auto ring = std::make_unique<TestRing>();
+        uint32_t status = 7;
+        size_t written = 0;
+        while (ring->try_write(2, status)) {
+            ++written;
+        }
+        REQUIRE(written == TestRing::capacity() / FRAME_ALIGNMENT);
+        REQUIRE(ring->consume_all([](const Frame& f) { REQUIRE(f.length == sizeof(uint32_t)); }) == written);
+    }
+    
+    SECTION("Concurrent producer and consumer") {
+        auto ring = std::make_unique<TestRing>();
+        constexpr uint32_t total = 50000;
+        
+        std::thread producer([&]() {
+            std::vector<uint8_t> payload;
+            for (uint32_t seq = 0; seq < total; ++seq) {
+                uint32_t length = (seq * 37) % 300;
+                fill(payload, length, seq);
+                while (!ring->try_write(1, payload.data(), length)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+        
+        uint32_t next = 0;
+        bool intact = true;
+        while (next < total) {
+            size_t n = ring->consume_all([&](const Frame& f) {
+                if (f.length != (next * 37) % 300 || !matches(f, next)) {
+                    intact = false;
+                }
+                ++next;
+            });
+            if (n == 0) {
+                std::this_thread::yield();
+            }
+        }
+        producer.join();
+        
+        REQUIRE(intact);
+        REQUIRE(ring->is_empty());
+    }
+}
+
+TEST_CASE("Property 22: Consumer wait strategies", "[property][broadcast_ring][wait_strategy]") {
+    // Feature: hft-market-data-system, Property 22: Pluggable wait strategies
+    // Whatever the idle policy, a polling reader receives every message in
+    // order; strategies can be selected by name at runtime
+    
+    SECTION("Strategy names parse") {
+        REQUIRE(parse_wait_strategy("spin") == WaitStrategyKind::BusySpin);
+        REQUIRE(parse_wait_strategy("yield") == WaitStrategyKind::SpinYield);
+        REQUIRE(parse_wait_strategy("block") == WaitStrategyKind::Blocking);
+        REQUIRE(parse_wait_strategy(BlockingWait::name()) == WaitStrategyKind::Blocking);
+        REQUIRE_FALSE(parse_wait_strategy("sleepy").has_value());
+        
+        std::string selected = with_wait_strategy(WaitStrategyKind::SpinYield,
+                                                  [](auto& wait) { return std::string(wait.name()); });
+        REQUIRE(selected == SpinYieldWait::name());
+    }
+    
+    SECTION("Every strategy delivers the whole stream") {
+        using TestRing = BroadcastRing<MarketData, 64, 4>;
+        constexpr int64_t total = 5000;
+        
+        for (WaitStrategyKind kind : {WaitStrategyKind::BusySpin, WaitStrategyKind::SpinYield,
+                                      WaitStrategyKind::Blocking}) {
+            auto ring = std::make_unique<TestRing>();
+            TestRing::Reader reader(*ring);
+            
+            std::thread writer([&]() {
+                for (int64_t j = 0; j < total; ++j) {
+                    while (!ring->try_publish(MarketData("WAIT", 1.0, 2.0, j))) {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+            
+            int64_t next = 0;
+            bool in_order = true;
+            with_wait_strategy(kind, [&](auto& wait) {
+                while (next < total) {
+                    reader.poll([&](const MarketData& msg) {
+                        in_order = in_order && msg.timestamp_ns == next;
+                        ++next;
+                    }, wait);
+                }
+            });
+            writer.join();
+            
+            REQUIRE(in_order);
+            REQUIRE(next == total);
+        }
+    }
+    
+    SECTION("Doorbell wakes a parked reader on publish") {
+        using TestRing = BroadcastRing<MarketData, 64, 4>;
+        auto ring = std::make_unique<TestRing>(OverflowPolicy::Gate, true);
+        REQUIRE(ring->doorbell_enabled());
+        TestRing::Reader reader(*ring);
+        
+        // Run property test with 20 park / publish round trips
+        for (int64_t i = 0; i < 20; ++i) {
+            std::atomic<bool> woke{false};
+            std::chrono::steady_clock::duration slept{};
+            std::thread sleeper([&]() {
+                auto begin = std::chrono::steady_clock::now();
+                reader.park(std::chrono::microseconds(50));
+                slept = std::chrono::steady_clock::now() - begin;
+                woke.store(true, std::memory_order_release);
+            });
+            
+            while (ring->sleeping_readers() == 0) {
+                std::this_thread::yield();
+            }
+            REQUIRE(ring->try_publish(MarketData("BELL", 1.0, 2.0, i)));
+            sleeper.join();
+            
+            // Woken by the publish, not by the safety-net timeout
+            REQUIRE(woke.load());
+            REQUIRE(slept < BROADCAST_DOORBELL_TIMEOUT / 2);
+            REQUIRE(ring->sleeping_readers() == 0);
+            
+            MarketData msg;
+            REQUIRE(reader.try_read(msg));
+            REQUIRE(msg.timestamp_ns == i);
+        }
+        
+        // Parking with data already published returns without sleeping
+        REQUIRE(ring->try_publish(MarketData("BELL", 1.0, 2.0, 99)));
+        auto begin = std::chrono::steady_clock::now();
+        reader.park(std::chrono::milliseconds(500));
+        REQUIRE(std::chrono::steady_clock::now() - begin < BROADCAST_DOORBELL_TIMEOUT / 2);
+    }
+}
+
+TEST_CASE("Property 23: Monotonic sequence numbers", "[property][sequence][ring_buffer]") {
+    // Feature: hft-market-data-system, Property 23: 64-bit sequence numbers
+    // Every message carries its sequence through JSON and shared memory,
+    // consumers count exact losses from sequence gaps, and ring indices keep
+    // counting instead of wrapping
+    
+    SECTION("Sequence lives in the former padding and survives JSON") {
+        REQUIRE(offsetof(MarketData, sequence) == 40);
+        REQUIRE(sizeof(MarketData) == 64);
+        
+        // Run property test with 100 iterations of random sequences
+        std::mt19937_64 gen(7);
+        for (int i = 0; i < 100; ++i) {
+            uint64_t seq = gen();
+            MarketData original("SEQ", 10.0, 10.5, static_cast<int64_t>(i), seq);
+            MarketData parsed;
+            REQUIRE(MarketData::from_json(original.to_json(), parsed));
+            REQUIRE(parsed.sequence == seq);
+        }
+        
+        // Messages from publishers that predate the field still parse
+        MarketData legacy;
+        REQUIRE(MarketData::from_json(
+            R"({"instrument":"OLD","bid":1.0,"ask":2.0,"timestamp_ns":5})", legacy));
+        REQUIRE(legacy.sequence == 0);
+    }
+    
+    SECTION("SequenceTracker counts exact losses") {
+        SequenceTracker tracker;
+        REQUIRE_FALSE(tracker.has_last());
+        REQUIRE(tracker.on_message(100) == 0); // First message sets the baseline
+        REQUIRE(tracker.on_message(101) == 0);
+        REQUIRE(tracker.on_message(105) == 3);
+        REQUIRE(tracker.on_message(106) == 0);
+        REQUIRE(tracker.on_message(200) == 93);
+        REQUIRE(tracker.gaps() == 2);
+        REQUIRE(tracker.missing() == 96);
+        REQUIRE(tracker.last() == 200);
+        
+        // Publisher restart: sequence goes back, counting resumes from there
+        REQUIRE(tracker.on_message(0) == 0);
+        REQUIRE(tracker.on_message(1) == 0);
+        REQUIRE(tracker.resets() == 1);
+        REQUIRE(tracker.gaps() == 2);
+    }
+    
+    SECTION("SPSC ring indices are monotonic") {
+        using TestRing = SpscRingBuffer<MarketData, 8>;
+        auto ring = std::make_unique<TestRing>();
+        
+        uint64_t written = 0;
+        for (int lap = 0; lap < 50; ++lap) {
+            while (ring->try_write(MarketData("LAP", 1.0, 2.0, 0, written))) {
+                ++written;
+            }
+            REQUIRE(ring->available_for_read() == TestRing::capacity());
+            REQUIRE(ring->get_write_index() == written);
+            
+            MarketData msg;
+            while (ring->try_read(msg)) {
+                REQUIRE(msg.sequence == ring->get_read_index() - 1);
+            }
+            REQUIRE(ring->get_read_index() == written);
+            REQUIRE(ring->is_empty());
+        }
+        REQUIRE(written == 50 * TestRing::capacity());
+    }
+}
+
+TEST_CASE("Property 24: Split reader cursor table", "[property][broadcast_ring][shared_memory]") {
+    // Feature: hft-market-data-system, Property 24: Read-only data, writable cursors
+    // With the cursor table outside the ring, readers only ever load from the
+    // ring, yet gating, eviction, lapping and the doorbell behave as before
+    
+    using TestRing = BroadcastRing<MarketData, 16, 4>;
+    
+    SECTION("Readers register in the external table only") {
+        auto ring = std::make_unique<TestRing>();
+        auto table = std::make_unique<TestRing::CursorTable>();
+        TestRing::Writer writer(*ring, *table);
+        REQUIRE(ring->has_external_cursors());
+        
+        // The embedded table is dead: registering there would not gate the writer
+        REQUIRE_THROWS_AS(TestRing::Reader(*ring), std::runtime_error);
+        
+        const TestRing& read_only = *ring;
+        TestRing::Reader reader(read_only, *table);
+        REQUIRE(writer.active_readers() == 1);
+        REQUIRE(ring->active_readers() == 0);
+        
+        // Gate: the reader in the external table holds the writer back
+        uint64_t published = 0;
+        while (writer.try_publish(MarketData("SPLIT", 1.0, 2.0, 0, published))) {
+            ++published;
+        }
+        REQUIRE(published == TestRing::capacity());
+        REQUIRE(writer.slowest_reader()->lag == TestRing::capacity());
+        
+        MarketData msg;
+        for (uint64_t i = 0; i < published; ++i) {
+            REQUIRE(reader.try_read(msg));
+            REQUIRE(msg.sequence == i);
+        }
+        REQUIRE(writer.try_publish(MarketData("SPLIT", 1.0, 2.0, 0, published)));
+        
+        // Eviction works through the handle too
+        REQUIRE(writer.evict_reader(reader.id()));
+        REQUIRE(writer.active_readers() == 0);
+    }
+    
+    SECTION("Reader maps the data segment read-only") {
+        const std::string data_name = "prop24_data_" + std::to_string(getpid());
+        const std::string cursor_name = "prop24_cursors_" + std::to_string(getpid());
+        constexpr RingGeometry ring_geometry = TestRing::expected_geometry();
+        constexpr RingGeometry table_geometry = TestRing::CursorTable::expected_geometry();
+        const ShmLayout ring_layout{ring_geometry.element_size, ring_geometry.slot_count, ring_geometry.total_bytes};
+        const ShmLayout table_layout{table_geometry.element_size, table_geometry.slot_count,
+                                     table_geometry.total_bytes};
+        
+        // Writer side
+        SharedMemoryManager data_shm = SharedMemoryManager::create_segment(data_name, ring_layout);
+        SharedMemoryManager cursor_shm = SharedMemoryManager::create_segment(cursor_name, table_layout);
+        auto* ring = new(data_shm.payload()) TestRing(OverflowPolicy::Overwrite, true);
+        auto* table = new(cursor_shm.payload()) TestRing::CursorTable();
+        TestRing::Writer writer(*ring, *table);
+        data_shm.mark_ready();
+        cursor_shm.mark_ready();
+        
+        // Reader side: separate mappings, the ring one without PROT_WRITE
+        SharedMemoryManager data_view = SharedMemoryManager::attach_segment(data_name, ring_layout, false);
+        SharedMemoryManager cursor_view = SharedMemoryManager::attach_segment(cursor_name, table_layout, true);
+        const auto* ring_view = static_cast<const TestRing*>(data_view.payload());
+        auto* table_view = static_cast<TestRing::CursorTable*>(cursor_view.payload());
+        TestRing::Reader reader(*ring_view, *table_view);
+        REQUIRE(writer.active_readers() == 1);
+        
+        for (uint64_t i = 0; i < 40; ++i) {
+            MarketData* slot = writer.claim();
+            REQUIRE(slot != nullptr);
+            new(slot) MarketData("RO", 1.0, 2.0, 0, i);
+            writer.commit();
+        }
+        
+        // Lapped through the read-only view: detected and counted, as usual
+        MarketData msg;
+        REQUIRE_FALSE(reader.try_read(msg));
+        REQUIRE(reader.lost_messages() == 40);
+        
+        REQUIRE(writer.try_publish(MarketData("RO", 1.0, 2.0, 0, 40)));
+        const MarketData* peeked = reader.peek();
+        REQUIRE(peeked != nullptr);
+        REQUIRE(peeked->sequence == 40);
+        REQUIRE(reader.release());
+        
+        // The doorbell is in the writable table; parking with data pending returns at once
+        reader.park(std::chrono::milliseconds(50));
+        REQUIRE(writer.sleeping_readers() == 0);
+    }
+}
+
+TEST_CASE("Property 25: Channel registry", "[property][channel_registry][shared_memory]") {
+    // Feature: hft-market-data-system, Property 25: Named channels
+    // Every registered channel can be found by name with the geometry it was
+    // registered with, and each channel's ring carries only its own messages
+    
+    using TestRing = BroadcastRing<MarketData, 16, 4>;
+    const std::string suffix = std::to_string(getpid());
+    
+    SECTION("Directory lists, finds and removes channels") {
+        auto directory = std::make_unique<ChannelDirectory<4>>();
+        
+        for (int i = 0; i < 4; ++i) {
+            const std::string name = "dir." + std::to_string(i);
+            REQUIRE(directory->add(ChannelDescriptor::for_ring<TestRing>(name, MARKET_DATA_SCHEMA,
+                                                                         MARKET_DATA_SCHEMA_VERSION)));
+        }
+        
+        // Full, and names are unique
+        REQUIRE_FALSE(directory->add(ChannelDescriptor::for_ring<TestRing>("dir.4", "MarketData", 2)));
+        REQUIRE(directory->remove("dir.1"));
+        REQUIRE_FALSE(directory->remove("dir.1"));
+        REQUIRE_FALSE(directory->add(ChannelDescriptor::for_ring<TestRing>("dir.0", "MarketData", 2)));
+        REQUIRE(directory->add(ChannelDescriptor::for_ring<TestRing>("dir.4", "MarketData", 2)));
+        
+        std::set<std::string> names;
+        REQUIRE(directory->for_each([&](const ChannelDescriptor& channel) { names.insert(channel.name); }) == 4);
+        REQUIRE(names == std::set<std::string>{"dir.0", "dir.2", "dir.3", "dir.4"});
+        
+        const std::optional<ChannelDescriptor> found = directory->find("dir.2");
+        REQUIRE(found.has_value());
+        REQUIRE(std::string(found->schema) == MARKET_DATA_SCHEMA);
+        REQUIRE(found->owner_pid == static_cast<int32_t>(getpid()));
+        REQUIRE(found->readable_as<TestRing>());
+        REQUIRE_FALSE(found->readable_as<ShmBroadcastRing>());
+        REQUIRE_FALSE(directory->find("dir.1").has_value());
+    }
+    
+    SECTION("Names must fit a descriptor") {
+        REQUIRE_THROWS_AS(ChannelDescriptor::for_ring<TestRing>("", "MarketData", 2), std::runtime_error);
+        REQUIRE_THROWS_AS(ChannelDescriptor::for_ring<TestRing>(std::string(CHANNEL_NAME_LEN, 'x'), "MarketData", 2),
+                          std::runtime_error);
+        REQUIRE_NOTHROW(ChannelDescriptor::for_ring<TestRing>(std::string(CHANNEL_NAME_LEN - 1, 'x'), "MarketData", 2));
+    }
+    
+    SECTION("Readers attach to the channels they name") {
+        ChannelRegistry registry = ChannelRegistry::create("prop25_channels_" + suffix);
+        const std::string first = "p25a." + suffix;
+        const std::string second = "p25b." + suffix;
+        BroadcastChannelWriter<TestRing> first_writer(first, OverflowPolicy::Gate, false);
+        BroadcastChannelWriter<TestRing> second_writer(second, OverflowPolicy::Gate, false);
+        registry.add_channel(ChannelDescriptor::for_ring<TestRing>(first, MARKET_DATA_SCHEMA, MARKET_DATA_SCHEMA_VERSION));
+        registry.add_channel(ChannelDescriptor::for_ring<TestRing>(second, MARKET_DATA_SCHEMA, MARKET_DATA_SCHEMA_VERSION));
+        REQUIRE_THROWS_AS(registry.add_channel(ChannelDescriptor::for_ring<TestRing>(first, "MarketData", 2)),
+                          std::runtime_error);
+        
+        // A consumer's view of the directory
+        const ChannelRegistry view = ChannelRegistry::open("prop25_channels_" + suffix);
+        REQUIRE(view.channels().size() == 2);
+        REQUIRE(view.find(second).has_value());
+        
+        BroadcastChannelReader<TestRing> reader(second);
+        REQUIRE(second_writer.writer().active_readers() == 1);
+        REQUIRE(first_writer.writer().active_readers() == 0);
+        
+        for (uint64_t i = 0; i < 8; ++i) {
+            REQUIRE(first_writer.writer().try_publish(MarketData("FIRST", 1.0, 2.0, 0, i)));
+            REQUIRE(second_writer.writer().try_publish(MarketData("SECOND", 1.0, 2.0, 0, i)));
+        }
+        
+        // Only the subscribed channel's messages, in that channel's sequence
+        MarketData msg;
+        for (uint64_t i = 0; i < 8; ++i) {
+            REQUIRE(reader.reader().try_read(msg));
+            REQUIRE(std::string(msg.instrument) == "SECOND");
+            REQUIRE(msg.sequence == i);
+        }
+        REQUIRE_FALSE(reader.reader().try_read(msg));
+        
+        // A channel that was never created cannot be attached to
+        REQUIRE_THROWS_AS(BroadcastChannelReader<TestRing>("p25c." + suffix), std::runtime_error);
+        
+        REQUIRE(registry.remove_channel(first));
+        REQUIRE(view.channels().size() == 1);
+    }
+}
+
+TEST_CASE("Property 26: Publisher warm restart", "[property][channel_registry][shared_memory]") {
+    // Feature: hft-market-data-system, Property 26: Warm restart continuity
+    // A publisher that takes over the channel its predecessor left behind
+    // continues the sequence; attached readers miss nothing and are told
+    
+    using TestRing = BroadcastRing<MarketData, 16, 4>;
+    const std::string name = "p26." + std::to_string(getpid());
+    ShmOptions persistent;
+    persistent.persist = true;
+    
+    SECTION("Reader carries on across a warm restart") {
+        auto first = std::make_unique<BroadcastChannelWriter<TestRing>>(
+            name, OverflowPolicy::Gate, false, persistent, persistent, true);
+        REQUIRE_FALSE(first->resumed());
+        BroadcastChannelReader<TestRing> reader(name);
+        
+        for (uint64_t i = 0; i < 6; ++i) {
+            REQUIRE(first->writer().try_publish(MarketData("WARM", 1.0, 2.0, 0, i)));
+        }
+        first.reset();
+        
+        // Still readable with the publisher gone
+        MarketData msg;
+        REQUIRE(reader.reader().try_read(msg));
+        REQUIRE(msg.sequence == 0);
+        REQUIRE_FALSE(reader.publisher_restarted());
+        
+        BroadcastChannelWriter<TestRing> second(name, OverflowPolicy::Gate, false, ShmOptions{}, ShmOptions{}, true);
+        REQUIRE(second.resumed());
+        REQUIRE(second.ring().published() == 6);
+        REQUIRE(second.writer().active_readers() == 1);
+        REQUIRE(reader.publisher_restarted());
+        REQUIRE_FALSE(reader.publisher_restarted());
+        REQUIRE_FALSE(reader.replaced());
+        
+        for (uint64_t i = 6; i < 10; ++i) {
+            REQUIRE(second.writer().try_publish(MarketData("WARM", 1.0, 2.0, 0, i)));
+        }
+        SequenceTracker tracker;
+        tracker.on_message(msg.sequence);
+        while (reader.reader().try_read(msg)) {
+            REQUIRE(tracker.on_message(msg.sequence) == 0);
+        }
+        REQUIRE(tracker.last() == 9);
+        REQUIRE(reader.reader().lost_messages() == 0);
+    }
+    
+    SECTION("Cold start replaces the channel") {
+        auto first = std::make_unique<BroadcastChannelWriter<TestRing>>(
+            name, OverflowPolicy::Gate, false, persistent, persistent);
+        BroadcastChannelReader<TestRing> reader(name);
+        first.reset();
+        
+        BroadcastChannelWriter<TestRing> second(name, OverflowPolicy::Gate, false);
+        REQUIRE_FALSE(second.resumed());
+        REQUIRE(second.writer().active_readers() == 0);
+        REQUIRE(reader.replaced());
+        REQUIRE_FALSE(reader.publisher_restarted());
+    }
+    
+    SECTION("Registry entry of an exited publisher is taken over") {
+        ChannelRegistry registry = ChannelRegistry::create("p26_channels_" + std::to_string(getpid()));
+        ChannelDescriptor stale = ChannelDescriptor::for_ring<TestRing>(name, MARKET_DATA_SCHEMA, MARKET_DATA_SCHEMA_VERSION);
+        
+        const pid_t child = fork();
+        if (child == 0) {
+            _exit(0);
+        }
+        REQUIRE(waitpid(child, nullptr, 0) == child);
+        stale.owner_pid = static_cast<int32_t>(child);
+        registry.add_channel(stale);
+        
+        registry.add_channel(ChannelDescriptor::for_ring<TestRing>(name, MARKET_DATA_SCHEMA, MARKET_DATA_SCHEMA_VERSION));
+        REQUIRE(registry.channels().size() == 1);
+        REQUIRE(registry.find(name)->owner_pid == static_cast<int32_t>(getpid()));
+        
+        // A running owner keeps its name
+        REQUIRE_THROWS_AS(registry.add_channel(ChannelDescriptor::for_ring<TestRing>(name, "MarketData", 2)),
+                          std::runtime_error);
+    }
+    
+    SECTION("Recovery evicts readers that died while the writer was down") {
+        auto ring = std::make_unique<TestRing>();
+        auto table = std::make_unique<TestRing::CursorTable>();
+        TestRing::Writer writer(*ring, *table);
+        TestRing::Reader live(*ring, *table);
+        TestRing::Reader dead(*ring, *table);
+        REQUIRE(writer.try_publish(MarketData("WARM", 1.0, 2.0, 0, 0)));
+        
+        // A pid that no longer exists
+        const pid_t child = fork();
+        if (child == 0) {
+            _exit(0);
+        }
+        REQUIRE(waitpid(child, nullptr, 0) == child);
+        table->readers[dead.id()].pid.store(static_cast<int32_t>(child));
+        
+        REQUIRE(writer.recover() == 1);
+        REQUIRE(writer.active_readers() == 1);
+        REQUIRE(writer.reader_status(live.id()).has_value());
+        REQUIRE_FALSE(writer.reader_status(dead.id()).has_value());
+    }
+    
+    remove_channel_segments(name);
+}
+
+TEST_CASE("Property 27: Peer watchdog", "[property][watchdog][broadcast_ring]") {
+    // Feature: hft-market-data-system, Property 27: Stall detection
+    // A peer is reported exactly when it has shown no progress (position or
+    // heartbeat) for the stall threshold, or its process is gone
+    
+    using TestRing = BroadcastRing<MarketData, 16, 4>;
+    constexpr int64_t stall_ns = 1000000;
+    
+    // A pid that no longer exists
+    auto dead_pid = []() {
+        const pid_t child = fork();
+        if (child == 0) {
+            _exit(0);
+        }
+        waitpid(child, nullptr, 0);
+        return static_cast<int32_t>(child);
+    };
+    
+    SECTION("Stuck readers are reported with their lag, busy and idle ones are not") {
+        auto ring = std::make_unique<TestRing>();
+        auto table = std::make_unique<TestRing::CursorTable>();
+        TestRing::Writer writer(*ring, *table);
+        TestRing::Reader busy(*ring, *table);
+        TestRing::Reader idle(*ring, *table);
+        TestRing::Reader stuck(*ring, *table);
+        ReaderWatchdog<TestRing> watchdog(*ring, *table, std::chrono::nanoseconds(stall_ns));
+        
+        std::vector<ReaderWatchdog<TestRing>::ReaderStall> stalls;
+        auto record = [&](const ReaderWatchdog<TestRing>::ReaderStall& stall) { stalls.push_back(stall); };
+        
+        REQUIRE(watchdog.check(record, 0) == 0);
+        for (uint64_t i = 0; i < 5; ++i) {
+            REQUIRE(writer.try_publish(MarketData("DOG", 1.0, 2.0, 0, i)));
+        }
+        
+        // Progress for busy, heartbeats for idle (drained, then polling empty)
+        MarketData msg;
+        REQUIRE(busy.try_read(msg));
+        while (idle.try_read(msg)) {
+        }
+        REQUIRE(watchdog.check(record, stall_ns - 1) == 0);
+        REQUIRE(busy.try_read(msg));
+        REQUIRE(idle.peek() == nullptr);
+        
+        REQUIRE(watchdog.check(record, stall_ns) == 1);
+        REQUIRE(stalls.back().id == stuck.id());
+        REQUIRE(stalls.back().pid == getpid());
+        REQUIRE(stalls.back().alive);
+        REQUIRE(stalls.back().lag == 5);
+        REQUIRE(stalls.back().stalled_ns == stall_ns);
+        REQUIRE(stalls.back().first_report);
+        
+        // Still stuck: reported again, but no longer as new
+        REQUIRE(watchdog.check(record, 2 * stall_ns) == 3);
+        REQUIRE_FALSE(stalls.back().first_report);
+        
+        // An idle reader that stops polling is stuck too, before it has any lag
+        stalls.clear();
+        REQUIRE(stuck.try_read(msg));
+        REQUIRE(watchdog.check(record, 2 * stall_ns + 1) == 2);
+        for (const auto& stall : stalls) {
+            REQUIRE(stall.id != stuck.id());
+        }
+    }
+    
+    SECTION("Dead readers are reported at once") {
+        auto ring = std::make_unique<TestRing>();
+        auto table = std::make_unique<TestRing::CursorTable>();
+        TestRing::Writer writer(*ring, *table);
+        TestRing::Reader reader(*ring, *table);
+        ReaderWatchdog<TestRing> watchdog(*ring, *table, std::chrono::nanoseconds(stall_ns));
+        table->readers[reader.id()].pid.store(dead_pid());
+        
+        bool alive = true;
+        REQUIRE(watchdog.check([&](const auto& stall) { alive = stall.alive; }, 0) == 1);
+        REQUIRE_FALSE(alive);
+    }
+    
+    SECTION("Slots of readers that died while attaching are reclaimed") {
+        // Every slot left RESERVED: live owners keep theirs, dead ones do not
+        auto ring = std::make_unique<TestRing>();
+        auto table = std::make_unique<TestRing::CursorTable>();
+        TestRing::Writer writer(*ring, *table);
+        for (auto& slot : table->readers) {
+            slot.state.store(TestRing::CursorTable::READER_RESERVED);
+            slot.pid.store(static_cast<int32_t>(getpid()));
+        }
+        REQUIRE_THROWS_AS(TestRing::Reader(*ring, *table), std::runtime_error);
+        
+        table->readers[2].pid.store(dead_pid());
+        {
+            TestRing::Reader reader(*ring, *table);
+            REQUIRE(reader.id() == 2);
+            REQUIRE(table->readers[2].pid.load() == static_cast<int32_t>(getpid()));
+            REQUIRE(table->active_readers() == 1);
+            REQUIRE(writer.try_publish(MarketData("RCL", 1.0, 2.0, 0, 0)));
+            MarketData msg;
+            REQUIRE(reader.try_read(msg));
+        }
+        
+        // Detaching frees the slot and gives up its pid
+        REQUIRE(table->readers[2].state.load() == TestRing::CursorTable::READER_FREE);
+        REQUIRE(table->readers[2].pid.load() == 0);
+        TestRing::Reader next(*ring, *table);
+        REQUIRE(next.id() == 2);
+    }
+    
+    SECTION("Publisher heartbeat") {
+        ShmSegmentHeader header{};
+        header.creator_pid = static_cast<int32_t>(getpid());
+        header.heartbeat_ns.store(1000);
+        ProducerWatchdog watchdog{std::chrono::nanoseconds(stall_ns)};
+        
+        REQUIRE_FALSE(watchdog.check(header, 1000 + stall_ns - 1).stalled);
+        const ProducerWatchdog::Status silent = watchdog.check(header, 1000 + stall_ns);
+        REQUIRE(silent.stalled);
+        REQUIRE(silent.first_report);
+        REQUIRE(silent.alive);
+        REQUIRE(silent.silent_ns == stall_ns);
+        REQUIRE_FALSE(watchdog.check(header, 1000 + stall_ns + 1).first_report);
+        
+        // Beats again, then its process goes away
+        header.heartbeat_ns.store(1000 + 2 * stall_ns);
+        REQUIRE_FALSE(watchdog.check(header, 1000 + 2 * stall_ns).stalled);
+        header.creator_pid = dead_pid();
+        const ProducerWatchdog::Status gone = watchdog.check(header, 1000 + 2 * stall_ns);
+        REQUIRE(gone.stalled);
+        REQUIRE(gone.first_report);
+        REQUIRE_FALSE(gone.alive);
+    }
+}
+
+TEST_CASE("Property 28: TSC clock precision", "[property][fast_clock]") {
+    // Tsc timestamps track the wall clock, never go backwards, resolve
+    // sub-microsecond intervals and cost far less than the cached clock's
+    // 200ms granularity would allow to measure
+    FastClock clock(ClockSource::Tsc);
+    REQUIRE(clock.is_running());
+    REQUIRE((clock.source() == ClockSource::Tsc || clock.source() == ClockSource::System));
+    if (clock.source() == ClockSource::Tsc) {
+        REQUIRE(clock.tsc_frequency_hz() > 1e6);
+    }
+    
+    SECTION("Close to the system clock") {
+        for (int i = 0; i < 100; ++i) {
+            const int64_t ours = clock.now();
+            const int64_t system_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+            REQUIRE(std::abs(system_ns - ours) < 1000000LL);  // 1ms
+        }
+    }
+    
+    SECTION("Monotonic and fine grained") {
+        std::vector<int64_t> stamps(100000);
+        for (int64_t& stamp : stamps) {
+            stamp = clock.now();
+        }
+        size_t distinct = 1;
+        for (size_t i = 1; i < stamps.size(); ++i) {
+            REQUIRE(stamps[i] >= stamps[i - 1]);
+            distinct += stamps[i] != stamps[i - 1] ? 1 : 0;
+        }
+        REQUIRE(distinct > stamps.size() / 2);
+    }
+    
+    SECTION("Stays on time across drift corrections") {
+        const int64_t start = clock.now();
+        std::this_thread::sleep_for(std::chrono::milliseconds(FastClock::get_update_frequency_ms() + 50));
+        const int64_t ours = clock.now();
+        const int64_t system_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        REQUIRE(ours > start);
+        REQUIRE(std::abs(system_ns - ours) < 1000000LL);
+    }
+    
+    SECTION("Cheap to read") {
+        auto start = std::chrono::steady_clock::now();
+        for (int j = 0; j < 100000; ++j) {
+            volatile int64_t ts = clock.now();
+            (void)ts;
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        
+        // 100000 calls in under 20ms, i.e. < 200ns each even unoptimised
+        REQUIRE(std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count() < 20);
+    }
+    
+    SECTION("A wall clock step moves the clock once and leaves its rate alone") {
+        // Synthetic counter at 3 ticks/ns; the wall clock is stepped by hand
+        constexpr int64_t interval_ns = 200000000;
+        constexpr int64_t epoch_ns = 1700000000000000000LL;
+        int64_t wall_offset = epoch_ns;
+        auto sample_at = [&](int64_t raw_ns) {
+            return TscSample{12345 + 3 * static_cast<uint64_t>(raw_ns), wall_offset + raw_ns, raw_ns};
+        };
+        
+        ClockTimebase timebase;
+        TscDiscipline discipline;
+        discipline.calibrate(timebase, sample_at(0), sample_at(10000000));
+        REQUIRE(std::abs(timebase.frequency_hz() - 3e9) < 3e3);
+        
+        // Correct every interval; returns the error found before correcting
+        int64_t raw_ns = 10000000;
+        auto run_for = [&](int intervals) {
+            int64_t worst = 0;
+            for (int i = 0; i < intervals; ++i) {
+                raw_ns += interval_ns;
+                const TscSample sample = sample_at(raw_ns);
+                const uint32_t updates = timebase.updates();
+                worst = std::max(worst, std::abs(sample.wall_ns - timebase.to_ns(sample.tsc)));
+                discipline.correct(timebase, sample, interval_ns);
+                REQUIRE(timebase.updates() == updates + 1);
+            }
+            return worst;
+        };
+        REQUIRE(run_for(50) < 1000);
+        
+        // Forward step of 1s after 10s: one step to the new wall time
+        wall_offset += 1000000000;
+        raw_ns += interval_ns;
+        discipline.correct(timebase, sample_at(raw_ns), interval_ns);
+        REQUIRE(timebase.to_ns(sample_at(raw_ns).tsc) == sample_at(raw_ns).wall_ns);
+        REQUIRE(std::abs(timebase.frequency_hz() - 3e9) < 3e3);
+        REQUIRE(run_for(20) < 1000);
+        
+        // Backward step to before the clock was calibrated: stepped once,
+        // and corrections carry on
+        wall_offset -= 30000000000LL;
+        raw_ns += interval_ns;
+        discipline.correct(timebase, sample_at(raw_ns), interval_ns);
+        REQUIRE(timebase.to_ns(sample_at(raw_ns).tsc) == sample_at(raw_ns).wall_ns);
+        REQUIRE(std::abs(timebase.frequency_hz() - 3e9) < 3e3);
+        REQUIRE(run_for(20) < 1000);
+    }
+}
+
+TEST_CASE("Property 29: Shared timebase", "[property][fast_clock][shared_memory]") {
+    // Clocks following another clock's timebase convert with exactly its
+    // parameters, so stamps from both are directly comparable
+    
+    SECTION("Followers track the calibrating clock") {
+        auto timebase = std::make_unique<ClockTimebase>();
+        FastClock owner(ClockSource::Tsc, timebase.get());
+        FastClock follower(*timebase);
+        REQUIRE_FALSE(owner.following());
+        REQUIRE(follower.following());
+        REQUIRE(follower.source() == owner.source());
+        REQUIRE(&follower.timebase() == timebase.get());
+        REQUIRE(follower.tsc_frequency_hz() == owner.tsc_frequency_hz());
+        
+        for (int i = 0; i < 1000; ++i) {
+            const int64_t before = owner.now();
+            const int64_t stamp = follower.now();
+            const int64_t after = owner.now();
+            REQUIRE(stamp >= before);
+            REQUIRE(stamp <= after);
+        }
+    }
+    
+    SECTION("An uncalibrated timebase reads wall time") {
+        auto timebase = std::make_unique<ClockTimebase>();
+        FastClock follower(*timebase);
+        REQUIRE(timebase->frequency_hz() == 0.0);
+        const int64_t system_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        REQUIRE(std::abs(follower.now() - system_ns) < 1000000LL);
+    }
+    
+    SECTION("Shared through shared memory") {
+        const std::string segment = "hft_p29_" + std::to_string(getpid());
+        SharedTimebase published = SharedTimebase::create(segment);
+        auto owner = std::make_unique<FastClock>(ClockSource::Tsc, &published.timebase());
+        REQUIRE(published.timebase().updates() >= 1);
+        
+        SharedTimebase opened = SharedTimebase::open(segment);
+        FastClock follower(opened.timebase());
+        REQUIRE(follower.following());
+        REQUIRE(follower.tsc_frequency_hz() == owner->tsc_frequency_hz());
+        const int64_t before = owner->now();
+        const int64_t stamp = follower.now();
+        REQUIRE(stamp >= before);
+        REQUIRE(stamp <= owner->now());
+        REQUIRE_FALSE(opened.replaced());
+        
+        // A cold started publisher replaces the segment; follow the new one
+        owner.reset();
+        SharedTimebase republished = SharedTimebase::create(segment);
+        FastClock new_owner(ClockSource::Tsc, &republished.timebase());
+        REQUIRE(opened.replaced());
+        SharedTimebase reopened = SharedTimebase::open(segment);
+        follower.follow(reopened.timebase());
+        REQUIRE(&follower.timebase() == &reopened.timebase());
+        REQUIRE(follower.now() >= new_owner.now() - 1000000LL);
+        
+        // The calibrating clock itself never switches
+        new_owner.follow(opened.timebase());
+        REQUIRE_FALSE(new_owner.following());
+        SharedMemoryManager::remove(segment);
+    }
+}
+
+TEST_CASE("Property 30: Pipeline stage stamps", "[property][latency]") {
+    // Stage stamps ride in the message (binary and JSON) and the breakdown
+    // splits the end-to-end latency into what each stage contributed
+    
+    SECTION("Stamps live in the former padding") {
+        REQUIRE(offsetof(MarketData, stage_offset_ns) == 48);
+        REQUIRE(sizeof(MarketData) == 64);
+        
+        MarketData msg("STG", 1.0, 2.0, 1000, 7);
+        REQUIRE(msg.stage_ns(Stage::Generated) == 1000);
+        REQUIRE(msg.stage_ns(Stage::Enqueued) == 0);
+        msg.stamp(Stage::Enqueued, 1250);
+        REQUIRE(msg.stage_ns(Stage::Enqueued) == 1250);
+        
+        // Consumer-side stages are not carried
+        msg.stamp(Stage::Dequeued, 2000);
+        REQUIRE(msg.stage_ns(Stage::Dequeued) == 0);
+        
+        // A stamp at or before generation still counts as stamped
+        msg.stamp(Stage::Serialized, 1000);
+        REQUIRE(msg.stage_ns(Stage::Serialized) == 1001);
+        
+        // Offsets saturate instead of wrapping
+        msg.stamp(Stage::Written, 1000 + 10000000000LL);
+        REQUIRE(msg.stage_ns(Stage::Written) == 1000 + int64_t{UINT32_MAX});
+    }
+    
+    SECTION("Stamps survive JSON, including ones added after serializing") {
+        std::mt19937_64 gen(30);
+        for (int i = 0; i < 100; ++i) {
+            const int64_t generated = 1700000000000000000LL + static_cast<int64_t>(gen() % 1000000);
+            MarketData original("JSN", 10.0, 10.5, generated, i);
+            original.stamp(Stage::Enqueued, generated + 100 + static_cast<int64_t>(gen() % 1000));
+            
+            std::string json = original.to_json();
+            MarketData::stamp_json(json, Stage::Serialized, generated + 5000);
+            MarketData::stamp_json(json, Stage::Written, generated + 6000);
+            
+            MarketData parsed;
+            REQUIRE(MarketData::from_json(json, parsed));
+            REQUIRE(parsed.sequence == static_cast<uint64_t>(i));
+            REQUIRE(parsed.stage_ns(Stage::Enqueued) == original.stage_ns(Stage::Enqueued));
+            REQUIRE(parsed.stage_ns(Stage::Serialized) == generated + 5000);
+            REQUIRE(parsed.stage_ns(Stage::Written) == generated + 6000);
+        }
+        
+        // Unstamped messages serialize as before and parse with no stamps
+        MarketData plain("PLN", 1.0, 2.0, 5, 1);
+        REQUIRE(plain.to_json().find("enqueued_ns") == std::string::npos);
+        REQUIRE(plain.to_json().find("written_ns") == std::string::npos);
+        MarketData parsed;
+        parsed.stamp(Stage::Enqueued, 99);
+        REQUIRE(MarketData::from_json(plain.to_json(), parsed));
+        REQUIRE(parsed.stage_ns(Stage::Enqueued) == 0);
+    }
+    
+    SECTION("Breakdown adds up to the end-to-end latency") {
+        StageBreakdown breakdown;
+        for (int64_t i = 0; i < 10; ++i) {
+            MarketData msg("BRK", 1.0, 2.0, 1000, static_cast<uint64_t>(i));
+            msg.stamp(Stage::Enqueued, 1100 + i);
+            msg.stamp(Stage::Serialized, 1300);
+            msg.stamp(Stage::Written, 1400);
+            breakdown.record(msg, 2400, 2500);
+        }
+        
+        REQUIRE(breakdown.stage(Stage::Enqueued).count == 10);
+        REQUIRE(breakdown.stage(Stage::Enqueued).min_ns == 100);
+        REQUIRE(breakdown.stage(Stage::Enqueued).max_ns == 109);
+        REQUIRE(breakdown.stage(Stage::Written).mean_ns() == 100.0);
+        REQUIRE(breakdown.stage(Stage::Dequeued).mean_ns() == 1000.0);
+        REQUIRE(breakdown.stage(Stage::Parsed).mean_ns() == 100.0);
+        
+        double total = 0.0;
+        size_t stages = 0;
+        breakdown.for_each([&](Stage, const StageBreakdown::StageStats& stats) {
+            total += stats.mean_ns();
+            ++stages;
+        });
+        REQUIRE(stages == 5);
+        REQUIRE(total == 1500.0);
+    }
+    
+    SECTION("Stages a message skipped are left out") {
+        // Shared memory path: no serialize, write or parse
+        StageBreakdown breakdown;
+        MarketData msg("SHM", 1.0, 2.0, 1000, 0);
+        msg.stamp(Stage::Enqueued, 1200);
+        breakdown.record(msg, 1500);
+        REQUIRE(breakdown.stage(Stage::Serialized).count == 0);
+        REQUIRE(breakdown.stage(Stage::Parsed).count == 0);
+        REQUIRE(breakdown.stage(Stage::Dequeued).mean_ns() == 300.0);
+        
+        // Publisher without stage stamps: everything lands on dequeue
+        breakdown.record(MarketData("OLD", 1.0, 2.0, 1000, 1), 1700);
+        REQUIRE(breakdown.stage(Stage::Enqueued).count == 1);
+        REQUIRE(breakdown.stage(Stage::Dequeued).count == 2);
+        REQUIRE(breakdown.stage(Stage::Dequeued).max_ns == 700);
+    }
+    
+    SECTION("Stamps taken out of a message record like the message") {
+        // A consumer reading in place keeps the stamps, then the slot may go
+        MarketData msg("CPY", 1.0, 2.0, 1000, 0);
+        msg.stamp(Stage::Enqueued, 1100);
+        msg.stamp(Stage::Written, 1400);
+        const StageBreakdown::CarriedStamps carried = StageBreakdown::carried(msg);
+        msg = MarketData("NEW", 1.0, 2.0, 5000, 1);
+        
+        StageBreakdown from_stamps;
+        from_stamps.record(carried, 1500);
+        REQUIRE(carried[0] == 1000);
+        REQUIRE(from_stamps.stage(Stage::Enqueued).mean_ns() == 100.0);
+        REQUIRE(from_stamps.stage(Stage::Serialized).count == 0);
+        REQUIRE(from_stamps.stage(Stage::Written).mean_ns() == 300.0);
+        REQUIRE(from_stamps.stage(Stage::Dequeued).mean_ns() == 100.0);
+    }
+}
+
+TEST_CASE("Property 31: Latency histogram", "[property][latency][histogram]") {
+    // Log-linear buckets keep every value to within 1/64 of itself, and
+    // percentiles, merges and resets behave like the raw samples would
+    
+    SECTION("Buckets are exact below 128 and within 1/64 above") {
+        for (uint64_t v = 0; v < LatencyHistogram::sub_bucket_count; ++v) {
+            const size_t index = LatencyHistogram::index_of(v);
+            REQUIRE(LatencyHistogram::lowest_in(index) == v);
+            REQUIRE(LatencyHistogram::highest_in(index) == v);
+        }
+        
+        std::mt19937_64 gen(31);
+        for (int i = 0; i < 100000; ++i) {
+            const uint64_t v = gen() % LatencyHistogram::max_trackable;
+            const size_t index = LatencyHistogram::index_of(v);
+            REQUIRE(index < LatencyHistogram::bucket_count);
+            REQUIRE(LatencyHistogram::lowest_in(index) <= v);
+            REQUIRE(LatencyHistogram::highest_in(index) >= v);
+            REQUIRE(LatencyHistogram::highest_in(index) - LatencyHistogram::lowest_in(index) <= v / 64);
+        }
+        
+        // Buckets tile the range with no gaps
+        for (size_t i = 1; i < LatencyHistogram::bucket_count; ++i) {
+            REQUIRE(LatencyHistogram::lowest_in(i) == LatencyHistogram::highest_in(i - 1) + 1);
+        }
+        REQUIRE(LatencyHistogram::index_of(UINT64_MAX) == LatencyHistogram::bucket_count - 1);
+    }
+    
+    SECTION("Percentiles match the sorted samples") {
+        auto histogram = std::make_unique<LatencyHistogram>();
+        REQUIRE(histogram->value_at_percentile(99.0) == 0);
+        
+        std::mt19937_64 gen(131);
+        std::vector<int64_t> samples;
+        for (int i = 0; i < 100000; ++i) {
+            // Mostly a few microseconds, with a long tail
+            const int64_t v = (i % 100 == 0) ? static_cast<int64_t>(gen() % 10000000)
+                                             : 1000 + static_cast<int64_t>(gen() % 4000);
+            samples.push_back(v);
+            histogram->record(v);
+        }
+        std::sort(samples.begin(), samples.end());
+        
+        for (double p : {50.0, 90.0, 99.0, 99.9, 99.99}) {
+            const size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * static_cast<double>(samples.size()))) - 1;
+            const int64_t exact = samples[rank];
+            const int64_t reported = histogram->value_at_percentile(p);
+            REQUIRE(reported >= exact);
+            REQUIRE(reported - exact <= exact / 64);
+        }
+        REQUIRE(histogram->count() == samples.size());
+        REQUIRE(histogram->min() == samples.front());
+        REQUIRE(histogram->max() == samples.back());
+        REQUIRE(histogram->value_at_percentile(100.0) == samples.back());
+    }
+    
+    SECTION("Merging equals recording everything in one") {
+        auto first = std::make_unique<LatencyHistogram>();
+        auto second = std::make_unique<LatencyHistogram>();
+        auto both = std::make_unique<LatencyHistogram>();
+        for (int64_t v = 0; v < 5000; ++v) {
+            first->record(v * 3);
+            both->record(v * 3);
+            second->record(v * 1000 + 7);
+            both->record(v * 1000 + 7);
+        }
+        first->merge(*second);
+        REQUIRE(first->count() == both->count());
+        REQUIRE(first->min() == both->min());
+        REQUIRE(first->max() == both->max());
+        REQUIRE(first->mean() == both->mean());
+        for (size_t i = 0; i < LatencyHistogram::bucket_count; ++i) {
+            REQUIRE(first->count_at_index(i) == both->count_at_index(i));
+        }
+        
+        // A copy is a snapshot; reset starts a new interval
+        const LatencyHistogram snapshot = *first;
+        first->reset();
+        REQUIRE(first->empty());
+        REQUIRE(first->max() == 0);
+        REQUIRE(snapshot.count() == both->count());
+    }
+    
+    SECTION("Out of range values are clamped, not lost") {
+        LatencyHistogram histogram;
+        histogram.record(-500);
+        histogram.record(int64_t{1} << 50, 3);
+        REQUIRE(histogram.count() == 4);
+        REQUIRE(histogram.min() == 0);
+        REQUIRE(histogram.max() == int64_t{1} << 50);
+        REQUIRE(histogram.count_at_index(0) == 1);
+        REQUIRE(histogram.count_at_index(LatencyHistogram::bucket_count - 1) == 3);
+        
+        const LatencySummary summary = LatencySummary::of(histogram);
+        REQUIRE(summary.p50_ns <= summary.max_ns);
+        REQUIRE(summary.max_ns == int64_t{1} << 50);
+    }
+    
+    SECTION("Recording is cheap and allocation-free") {
+        static_assert(std::is_trivially_copyable_v<LatencyHistogram>);
+        LatencyHistogram histogram;
+        auto start = std::chrono::steady_clock::now();
+        for (int64_t i = 0; i < 1000000; ++i) {
+            histogram.record(i * 7919 % 10000000);
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        REQUIRE(histogram.count() == 1000000);
+        
+        // 1M records in under 50ms, i.e. < 50ns each even unoptimised
+        REQUIRE(std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count() < 50);
+    }
+}
+
+TEST_CASE("Property 32: Shared metrics registry", "[property][metrics][shared_memory]") {
+    // A process's metrics live in its own segment; a monitor attached
+    // read-only sees every update without the process doing anything else
+    const std::string segment = "hft_metrics_p32_" + std::to_string(getpid());
+    
+    SECTION("Metrics are registered once and read by a monitor") {
+        MetricsRegistry metrics = MetricsRegistry::create("p32_writer", segment);
+        Counter messages = metrics.counter("messages");
+        Gauge lag = metrics.gauge("ring_max_lag");
+        SharedLatencyHistogram& latency = metrics.histogram("latency_ns");
+        
+        // Registering a name again returns the same slot
+        metrics.counter("messages").add(5);
+        REQUIRE(messages.value() == 5);
+        REQUIRE(&metrics.histogram("latency_ns") == &latency);
+        
+        MetricsRegistry monitor = MetricsRegistry::open(segment);
+        REQUIRE(monitor.owner_alive());
+        REQUIRE(std::string(monitor.table().process) == "p32_writer");
+        
+        messages.add();
+        messages.add(10);
+        lag.set(-3);
+        lag.set(42);
+        for (int64_t v = 1; v <= 1000; ++v) {
+            latency.record(v * 100);
+        }
+        
+        std::vector<std::pair<std::string, uint64_t>> counters;
+        monitor.table().for_each_counter([&](const char* name, uint64_t value) {
+            counters.emplace_back(name, value);
+        });
+        REQUIRE(counters.size() == 1);
+        REQUIRE(counters[0].first == "messages");
+        REQUIRE(counters[0].second == 16);
+        
+        int64_t gauge_value = 0;
+        monitor.table().for_each_gauge([&](const char* name, int64_t value) {
+            REQUIRE(std::string(name) == "ring_max_lag");
+            gauge_value = value;
+        });
+        REQUIRE(gauge_value == 42);
+        
+        // A snapshot of the shared histogram reads like a local one
+        auto local = std::make_unique<LatencyHistogram>();
+        for (int64_t v = 1; v <= 1000; ++v) {
+            local->record(v * 100);
+        }
+        auto snapshot = std::make_unique<LatencyHistogram>();
+        monitor.table().for_each_histogram([&](const char* name, const SharedLatencyHistogram& shared) {
+            REQUIRE(std::string(name) == "latency_ns");
+            snapshot->merge(shared);
+        });
+        REQUIRE(snapshot->count() == 1000);
+        for (double p : {50.0, 99.0, 99.9, 100.0}) {
+            REQUIRE(snapshot->value_at_percentile(p) == local->value_at_percentile(p));
+        }
+        
+        const std::vector<std::string> segments = MetricsRegistry::list();
+        REQUIRE(std::find(segments.begin(), segments.end(), segment) != segments.end());
+    }
+    
+    SECTION("Invalid names and a full table are setup errors") {
+        MetricsRegistry metrics = MetricsRegistry::create("p32_writer", segment);
+        REQUIRE_THROWS_AS(metrics.counter(""), std::runtime_error);
+        REQUIRE_THROWS_AS(metrics.gauge(std::string(METRIC_NAME_LEN, 'x')), std::runtime_error);
+        for (size_t i = 0; i < MAX_HISTOGRAMS; ++i) {
+            metrics.histogram("h" + std::to_string(i));
+        }
+        REQUIRE_THROWS_AS(metrics.histogram("one_too_many"), std::runtime_error);
+        REQUIRE_NOTHROW(metrics.histogram("h0"));
+    }
+    
+    SECTION("Tables left behind by exited processes are removed") {
+        pid_t child = fork();
+        if (child == 0) {
+            // Skip destructors so the segment outlives its owner
+            MetricsRegistry orphan = MetricsRegistry::create("p32_child", metrics_segment(getpid()));
+            orphan.counter("messages").add();
+            _exit(0);
+        }
+        int status = 0;
+        waitpid(child, &status, 0);
+        REQUIRE(WIFEXITED(status));
+        const std::string orphan = metrics_segment(child);
+        std::vector<std::string> segments = MetricsRegistry::list();
+        REQUIRE(std::find(segments.begin(), segments.end(), orphan) != segments.end());
+        
+        MetricsRegistry monitor = MetricsRegistry::open(orphan);
+        REQUIRE_FALSE(monitor.owner_alive());
+        
+        REQUIRE(MetricsRegistry::remove_stale() >= 1);
+        segments = MetricsRegistry::list();
+        REQUIRE(std::find(segments.begin(), segments.end(), orphan) == segments.end());
+    }
+    
+    SharedMemoryManager::remove(segment);
+}
+
+TEST_CASE("Property 33: Asynchronous logger", "[property][logger]") {
+    // Records are formatted and written by the background thread exactly as
+    // fmt would have printed them, in order per thread, and logging never
+    // blocks the caller
+    auto read_all = [](std::FILE* file) {
+        std::fflush(file);
+        std::rewind(file);
+        std::string contents;
+        char chunk[4096];
+        size_t n;
+        while ((n = std::fread(chunk, 1, sizeof(chunk), file)) > 0) {
+            contents.append(chunk, n);
+        }
+        return contents;
+    };
+    
+    SECTION("Records match fmt and strings are copied at the call") {
+        std::FILE* file = std::tmpfile();
+        REQUIRE(file != nullptr);
+        {
+            AsyncLogger logger(file);
+            REQUIRE(logger.attach());
+            
+            const MarketData data("RELIANCE", 2500.25, 2500.75, 0);
+            char scratch[16] = "first";
+            std::string owned = "owned";
+            REQUIRE(logger.log("MSG #{:4d} | {} | BID: {:8.2f} | ASK: {:8.2f} | {}\n",
+                              7, data.instrument, data.bid, data.ask, true));
+            REQUIRE(logger.log("{} {} {} {}\n", scratch, owned, std::string_view("view"), 'c'));
+            std::strcpy(scratch, "second");
+            owned = "changed";
+            REQUIRE(logger.log("{} {}\n", scratch, uint64_t{18446744073709551615ULL}));
+            logger.flush();
+            REQUIRE(logger.written() == 3);
+            REQUIRE(logger.dropped() == 0);
+        }
+        REQUIRE(read_all(file) ==
+                fmt::format("MSG #{:4d} | {} | BID: {:8.2f} | ASK: {:8.2f} | {}\n", 7, "RELIANCE", 2500.25, 2500.75, true) +
+                "first owned view c\n"
+                "second 18446744073709551615\n");
+        std::fclose(file);
+    }
+    
+    SECTION("Each thread's records stay in order") {
+        std::FILE* file = std::tmpfile();
+        REQUIRE(file != nullptr);
+        constexpr int threads = 4;
+        constexpr int per_thread = 500;
+        {
+            AsyncLogger logger(file);
+            std::vector<std::thread> workers;
+            for (int t = 0; t < threads; ++t) {
+                workers.emplace_back([&logger, t] {
+                    for (int i = 0; i < per_thread; ++i) {
+                        // Retry on a full queue: the test wants every record
+                        while (!logger.log("{} {}\n", t, i)) {
+                            std::this_thread::yield();
+                        }
+                    }
+                });
+            }
+            for (auto& worker : workers) {
+                worker.join();
+            }
+        }
+        
+        std::vector<int> next(threads, 0);
+        std::string contents = read_all(file);
+        size_t start = 0;
+        size_t lines = 0;
+        while (start < contents.size()) {
+            const size_t end = contents.find('\n', start);
+            REQUIRE(end != std::string::npos);
+            const std::string line = contents.substr(start, end - start);
+            start = end + 1;
+            if (line.rfind("[async logger:", 0) == 0) {
+                continue;  // Drop notes for the retried records
+            }
+            int t = -1;
+            int i = -1;
+            REQUIRE(std::sscanf(line.c_str(), "%d %d", &t, &i) == 2);
+            REQUIRE(t >= 0);
+            REQUIRE(t < threads);
+            REQUIRE(i == next[t]);
+            ++next[t];
+            ++lines;
+        }
+        REQUIRE(lines == threads * per_thread);
+        std::fclose(file);
+    }
+    
+    SECTION("Full queues and oversized records drop, never block") {
+        std::FILE* file = std::tmpfile();
+        REQUIRE(file != nullptr);
+        AsyncLogger logger(file);
+        
+        const std::string huge(LOG_QUEUE_BYTES, 'x');
+        REQUIRE_FALSE(logger.log("{}\n", huge));
+        REQUIRE(logger.dropped() == 1);
+        
+        // With the background thread stopped nothing drains: the queue fills
+        // and every further call returns at once
+        logger.stop();
+        size_t accepted = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < 10000; ++i) {
+            accepted += logger.log("{} {}\n", i, 1.5) ? 1 : 0;
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        REQUIRE(accepted == LOG_QUEUE_BYTES / FRAME_ALIGNMENT);
+        REQUIRE(logger.dropped() == 1 + 10000 - accepted);
+        
+        // 10000 calls in under 10ms, i.e. < 1us each even unoptimised
+        REQUIRE(std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count() < 10);
+        std::fclose(file);
+    }
+}
+
+TEST_CASE("Property 34: Hardware performance counters", "[property][performance]") {
+    // Counters either measure or do nothing; they never fail the caller
+    
+    SECTION("Readings subtract and accumulate per region") {
+        PerfReading start;
+        PerfReading end;
+        for (size_t i = 0; i < PERF_EVENT_COUNT; ++i) {
+            start.values[i] = 1000 * (i + 1);
+            end.values[i] = start.values[i] + 10 * (i + 1);
+        }
+        start.running_ns = 500;
+        end.running_ns = 700;
+        
+        PerfStats stats;
+        REQUIRE(stats.per_region(PerfEvent::Cycles) == 0.0);
+        REQUIRE(stats.ipc() == 0.0);
+        REQUIRE(stats.user_cycles_per_ns() == 0.0);
+        stats.add(end - start);
+        stats.add(end - start, 3);
+        REQUIRE(stats.regions() == 4);
+        REQUIRE(stats.total()[PerfEvent::Cycles] == 20);
+        REQUIRE(stats.per_region(PerfEvent::Cycles) == 5.0);
+        REQUIRE(stats.per_region(PerfEvent::BranchMisses) == 25.0);
+        REQUIRE(stats.ipc() == 2.0);
+        REQUIRE(stats.user_cycles_per_ns() == 20.0 / 400.0);
+        stats.reset();
+        REQUIRE(stats.regions() == 0);
+        REQUIRE(std::string(perf_event_name(PerfEvent::LlcMisses)) == "LLC misses");
+    }
+    
+    SECTION("Disabled counters are a no-op") {
+        const PerfCounters counters(false);
+        REQUIRE_FALSE(counters.available());
+        PerfStats stats;
+        {
+            ScopedPerfCounter scope(counters, stats);
+        }
+        REQUIRE(stats.regions() == 0);
+        const PerfReading reading = counters.read();
+        for (size_t i = 0; i < PERF_EVENT_COUNT; ++i) {
+            REQUIRE(reading.values[i] == 0);
+            REQUIRE_FALSE(counters.counting(static_cast<PerfEvent>(i)));
+        }
+    }
+    
+    SECTION("Available counters measure a region") {
+        const PerfCounters counters;
+        if (!counters.available()) {
+            // No PMU (VM, container) or not permitted: nothing to measure
+            REQUIRE_FALSE(counters.status().empty());
+            return;
+        }
+        PerfStats stats;
+        volatile uint64_t sink = 0;
+        for (int region = 0; region < 10; ++region) {
+            ScopedPerfCounter scope(counters, stats);
+            for (uint64_t i = 0; i < 100000; ++i) {
+                sink = sink + i;
+            }
+        }
+        REQUIRE(stats.regions() == 10);
+        if (counters.counting(PerfEvent::Instructions)) {
+            REQUIRE(stats.per_region(PerfEvent::Instructions) > 100000.0);
+        }
+        if (counters.counting(PerfEvent::Cycles)) {
+            REQUIRE(stats.per_region(PerfEvent::Cycles) > 0.0);
+            REQUIRE(stats.total().running_ns > 0);
+        }
+    }
+}
+
+TEST_CASE("Property 35: Hiccup meter", "[property][hiccup]") {
+    // Time the meter thread does not run is recorded as a hiccup, stamped so
+    // it can be matched against a latency spike in flight at the same time
+    
+    SECTION("Spikes are matched against the longest overlapping stall") {
+        const Hiccup hiccup{1000, 500};
+        REQUIRE(hiccup.end_ns() == 1500);
+        REQUIRE(hiccup.overlaps(1400, 2000));
+        REQUIRE(hiccup.overlaps(0, 1000));
+        REQUIRE(hiccup.overlaps(1100, 1200));
+        REQUIRE_FALSE(hiccup.overlaps(1501, 2000));
+        REQUIRE_FALSE(hiccup.overlaps(0, 999));
+        
+        HiccupLog<4> log;
+        REQUIRE_FALSE(log.longest_overlapping(0, INT64_MAX).has_value());
+        log.add(Hiccup{100, 50});
+        log.add(Hiccup{120, 10});
+        log.add(Hiccup{1000, 20});
+        REQUIRE(log.longest_overlapping(110, 130)->gap_ns == 50);
+        REQUIRE(log.longest_overlapping(1010, 1010)->start_ns == 1000);
+        REQUIRE_FALSE(log.longest_overlapping(200, 900).has_value());
+        
+        // Only the last Capacity hiccups are kept
+        log.add(Hiccup{2000, 1});
+        log.add(Hiccup{3000, 1});
+        REQUIRE(log.size() == 4);
+        REQUIRE_FALSE(log.longest_overlapping(100, 110).has_value());
+        REQUIRE(log.longest_overlapping(120, 125)->gap_ns == 10);
+    }
+    
+    SECTION("A busy thread on the meter's core shows up as hiccups") {
+        // Share one core with the meter: the scheduler hands it out in
+        // slices, so the meter sees every slice we take as a stall
+        cpu_set_t saved;
+        REQUIRE(sched_getaffinity(0, sizeof(saved), &saved) == 0);
+        const int cpu = sched_getcpu();
+        REQUIRE(CpuAffinity::set_thread_affinity(cpu));
+        
+        constexpr int64_t threshold_ns = 100000;
+        auto meter = std::make_unique<HiccupMeter>(cpu, threshold_ns);
+        const int64_t busy_start = realtime_ns();
+        while (realtime_ns() - busy_start < 200000000LL) {
+            // Spin for 200ms
+        }
+        const int64_t busy_end = realtime_ns();
+        meter->stop();
+        REQUIRE(sched_setaffinity(0, sizeof(saved), &saved) == 0);
+        
+        REQUIRE(meter->pinned());
+        REQUIRE(meter->cpu() == cpu);
+        REQUIRE(meter->samples() > 0);
+        const uint64_t recorded = meter->histogram().count();
+        REQUIRE(recorded > 0);
+        REQUIRE(meter->histogram().min() > threshold_ns);
+        
+        std::vector<Hiccup> hiccups;
+        REQUIRE(meter->drain([&](const Hiccup& hiccup) { hiccups.push_back(hiccup); }) == recorded);
+        REQUIRE(meter->dropped() == 0);
+        for (size_t i = 0; i < hiccups.size(); ++i) {
+            REQUIRE(hiccups[i].gap_ns > threshold_ns);
+            if (i > 0) {
+                REQUIRE(hiccups[i].start_ns >= hiccups[i - 1].end_ns());
+            }
+        }
+        
+        // Stamps are on the wall clock epoch: the stalls fall in our busy loop
+        // (give or take the calibration error)
+        REQUIRE(std::any_of(hiccups.begin(), hiccups.end(), [&](const Hiccup& hiccup) {
+            return hiccup.overlaps(busy_start - 1000000, busy_end + 1000000);
+        }));
+    }
+    
+    SECTION("Configuration comes from the environment") {
+        unsetenv("HFT_HICCUP_CPU");
+        unsetenv("HFT_HICCUP_US");
+        REQUIRE_FALSE(HiccupMeter::requested_cpu().has_value());
+        REQUIRE(HiccupMeter::requested_threshold_ns() == DEFAULT_HICCUP_THRESHOLD_NS);
+        setenv("HFT_HICCUP_CPU", "3", 1);
+        setenv("HFT_HICCUP_US", "12.5", 1);
+        REQUIRE(HiccupMeter::requested_cpu() == 3);
+        REQUIRE(HiccupMeter::requested_threshold_ns() == 12500);
+        setenv("HFT_HICCUP_CPU", "three", 1);
+        REQUIRE_FALSE(HiccupMeter::requested_cpu().has_value());
+        unsetenv("HFT_HICCUP_CPU");
+        unsetenv("HFT_HICCUP_US");
+    }
+}
+
 // ============================================================================
 // TCP SERVER PROPERTY TESTS
 // ============================================================================
@@ -3,6 +3,7 @@
 #include <sys/wait.h>
 #include <unistd.h>
 #include <cstring>
+#include <optional>
 #include <string>
 #include <random>
 #include <sstream>
@@ -88,6 +89,268 @@ TEST_CASE("SharedMemoryManager creation and basic operations", "[shared_memory][
     }
 }
 
+TEST_CASE("SharedMemoryManager attach uses creator's size", "[shared_memory][unit]") {
+    const std::string test_name = generate_unique_name("test_shm_size");
+    const size_t creator_size = 3 * 4096;
+    
+    SharedMemoryManager creator(test_name, creator_size, true);
+    REQUIRE(creator.is_valid());
+    char* data = static_cast<char*>(creator.get_address());
+    data[creator_size - 1] = 'Q';
+    
+    // Size 0 on attach maps the whole segment as sized by its creator
+    SharedMemoryManager reader(test_name, 0, false);
+    REQUIRE(reader.is_valid());
+    REQUIRE(reader.get_size() == creator_size);
+    REQUIRE(static_cast<const char*>(reader.get_address())[creator_size - 1] == 'Q');
+    
+    // Attaching to a prefix of the segment is still allowed
+    SharedMemoryManager prefix_reader(test_name, 4096, false);
+    REQUIRE(prefix_reader.is_valid());
+    REQUIRE(prefix_reader.get_size() == 4096);
+}
+
+TEST_CASE("SharedMemoryManager writable attach", "[shared_memory][unit]") {
+    const std::string test_name = generate_unique_name("test_shm_writable");
+    const size_t test_size = sizeof(TestData);
+    
+    SharedMemoryManager creator(test_name, test_size, true);
+    REQUIRE(creator.is_valid());
+    TestData* data = static_cast<TestData*>(creator.get_address());
+    data->value = 1;
+    
+    // A writable attacher (e.g. a broadcast ring reader publishing its
+    // cursor) can store into the segment and the creator sees it
+    SharedMemoryManager writer(test_name, 0, false, true);
+    REQUIRE(writer.is_valid());
+    REQUIRE_FALSE(writer.is_creator());
+    TestData* attached = static_cast<TestData*>(writer.get_address());
+    attached->value = 2;
+    REQUIRE(data->value == 2);
+}
+
+TEST_CASE("SharedMemoryManager segment header validation", "[shared_memory][unit]") {
+    const std::string test_name = generate_unique_name("test_shm_header");
+    const ShmLayout layout{sizeof(TestData), 16, 16 * sizeof(TestData)};
+    
+    SharedMemoryManager creator = SharedMemoryManager::create_segment(test_name, layout);
+    REQUIRE(creator.is_valid());
+    REQUIRE(creator.get_size() >= sizeof(ShmSegmentHeader) + layout.payload_bytes);
+    REQUIRE(creator.payload() == static_cast<char*>(creator.get_address()) + sizeof(ShmSegmentHeader));
+    REQUIRE(reinterpret_cast<uintptr_t>(creator.payload()) % 64 == 0);
+    
+    const ShmSegmentHeader* header = creator.header();
+    REQUIRE(header->layout_version == SHM_LAYOUT_VERSION);
+    REQUIRE(header->element_size == layout.element_size);
+    REQUIRE(header->capacity == layout.capacity);
+    REQUIRE(header->creator_pid == getpid());
+    REQUIRE(header->start_time_ns > 0);
+    
+    SECTION("Attach fails until the creator marks the segment ready") {
+        REQUIRE_THROWS_AS(SharedMemoryManager::attach_segment(test_name, layout), std::runtime_error);
+        creator.mark_ready();
+        SharedMemoryManager reader = SharedMemoryManager::attach_segment(test_name, layout);
+        REQUIRE(reader.is_valid());
+        REQUIRE_FALSE(reader.is_creator());
+        REQUIRE(reader.header()->creator_pid == getpid());
+    }
+    
+    SECTION("Payload is shared and heartbeat is visible to readers") {
+        creator.mark_ready();
+        static_cast<TestData*>(creator.payload())->value = 42;
+        creator.heartbeat(header->start_time_ns + 1000);
+        
+        SharedMemoryManager reader = SharedMemoryManager::attach_segment(test_name, layout);
+        REQUIRE(static_cast<const TestData*>(reader.payload())->value == 42);
+        REQUIRE(reader.header()->heartbeat_ns.load() == header->start_time_ns + 1000);
+    }
+    
+    SECTION("Mismatched geometry is rejected") {
+        creator.mark_ready();
+        REQUIRE_THROWS_AS(SharedMemoryManager::attach_segment(
+            test_name, ShmLayout{sizeof(TestData) + 8, 16, 16 * (sizeof(TestData) + 8)}), std::runtime_error);
+        REQUIRE_THROWS_AS(SharedMemoryManager::attach_segment(
+            test_name, ShmLayout{sizeof(TestData), 32, 32 * sizeof(TestData)}), std::runtime_error);
+    }
+    
+    SECTION("Mismatched layout version is rejected") {
+        creator.mark_ready();
+        creator.header()->layout_version = SHM_LAYOUT_VERSION + 1;
+        REQUIRE_THROWS_AS(SharedMemoryManager::attach_segment(test_name, layout), std::runtime_error);
+    }
+    
+    SECTION("Segment without a header is rejected") {
+        const std::string raw_name = generate_unique_name("test_shm_raw");
+        SharedMemoryManager raw(raw_name, 4096, true);
+        std::memset(raw.get_address(), 0, 4096);
+        REQUIRE_THROWS_AS(SharedMemoryManager::attach_segment(raw_name, layout), std::runtime_error);
+    }
+}
+
+TEST_CASE("SharedMemoryManager huge page backing", "[shared_memory][unit]") {
+    const std::string test_name = generate_unique_name("test_shm_huge");
+    const size_t test_size = 3 * 1024 * 1024;
+    
+    SECTION("Normal pages by default") {
+        SharedMemoryManager shm(test_name, test_size, true);
+        REQUIRE(shm.backing() == ShmBacking::NormalPages);
+        REQUIRE(shm.page_size() == static_cast<size_t>(sysconf(_SC_PAGESIZE)));
+    }
+    
+    SECTION("Huge pages when available, normal pages otherwise") {
+        ShmOptions options;
+        options.huge_pages = true;
+        SharedMemoryManager creator(test_name, test_size, true, false, options);
+        REQUIRE(creator.is_valid());
+        REQUIRE(creator.get_size() == test_size);
+        if (creator.backing() == ShmBacking::HugePages) {
+            REQUIRE(creator.page_size() >= 2 * 1024 * 1024);
+        } else {
+            REQUIRE(creator.page_size() == static_cast<size_t>(sysconf(_SC_PAGESIZE)));
+        }
+        
+        // The whole segment is usable whatever the backing
+        char* bytes = static_cast<char*>(creator.get_address());
+        bytes[0] = 'a';
+        bytes[test_size - 1] = 'z';
+        
+        // Attachers find the segment without being told how it is backed
+        SharedMemoryManager reader(test_name, 0, false);
+        REQUIRE(reader.backing() == creator.backing());
+        REQUIRE(reader.get_size() >= test_size);
+        const char* seen = static_cast<const char*>(reader.get_address());
+        REQUIRE(seen[0] == 'a');
+        REQUIRE(seen[test_size - 1] == 'z');
+    }
+    
+    SECTION("Missing hugetlbfs mount falls back cleanly") {
+        ShmOptions options;
+        options.huge_pages = true;
+        options.hugetlbfs_dir = "/nonexistent_hugetlbfs";
+        SharedMemoryManager shm(test_name, test_size, true, false, options);
+        REQUIRE(shm.is_valid());
+        REQUIRE(shm.backing() == ShmBacking::NormalPages);
+    }
+}
+
+TEST_CASE("SharedMemoryManager prefault and lock", "[shared_memory][unit]") {
+    const std::string test_name = generate_unique_name("test_shm_prefault");
+    const size_t test_size = 4 * 1024 * 1024;
+    const size_t pages = test_size / static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    
+    // Touch every page (one write per page) and count the faults it took
+    auto faults_touching = [](SharedMemoryManager& shm) {
+        const long before = minor_page_faults();
+        char* bytes = static_cast<char*>(shm.get_address());
+        for (size_t offset = 0; offset < shm.get_size(); offset += shm.page_size()) {
+            bytes[offset] = 1;
+        }
+        return minor_page_faults() - before;
+    };
+    
+    SECTION("Lazy mapping faults on first touch") {
+        SharedMemoryManager shm(test_name, test_size, true);
+        REQUIRE(shm.prefaulted_pages() == 0);
+        REQUIRE_FALSE(shm.locked());
+        REQUIRE(faults_touching(shm) >= static_cast<long>(pages / 2));
+    }
+    
+    SECTION("Populate-on-map leaves the first pass fault-free") {
+        ShmOptions options;
+        options.populate = true;
+        SharedMemoryManager shm(test_name, test_size, true, false, options);
+        REQUIRE(faults_touching(shm) < static_cast<long>(pages / 10));
+    }
+    
+    SECTION("Pretouch on a writable attach leaves the first pass fault-free") {
+        SharedMemoryManager creator(test_name, test_size, true);
+        static_cast<char*>(creator.get_address())[0] = 'x';
+        
+        ShmOptions options;
+        options.pretouch = true;
+        SharedMemoryManager reader(test_name, 0, false, true, options);
+        REQUIRE(reader.prefaulted_pages() > 0);
+        REQUIRE(static_cast<const char*>(reader.get_address())[0] == 'x');
+        REQUIRE(faults_touching(reader) < static_cast<long>(pages / 10));
+    }
+    
+    SECTION("Lock is best effort") {
+        ShmOptions options;
+        options.lock = true;
+        SharedMemoryManager shm(test_name, test_size, true, false, options);
+        REQUIRE(shm.is_valid());
+        if (shm.locked()) {
+            REQUIRE(shm.prefaulted_pages() > 0);
+        }
+    }
+}
+
+TEST_CASE("SharedMemoryManager warm restart", "[shared_memory][unit]") {
+    const std::string test_name = generate_unique_name("test_shm_restart");
+    const ShmLayout layout{sizeof(TestData), 16, 16 * sizeof(TestData)};
+    ShmOptions persistent;
+    persistent.persist = true;
+    
+    SECTION("Nothing to resume") {
+        REQUIRE_FALSE(SharedMemoryManager::resume_segment(test_name, layout).has_value());
+    }
+    
+    SECTION("Persistent segment is resumed with its payload") {
+        {
+            SharedMemoryManager creator = SharedMemoryManager::create_segment(test_name, layout, persistent);
+            static_cast<TestData*>(creator.payload())->value = 42;
+            creator.mark_ready();
+            REQUIRE(creator.generation() == 1);
+        }
+        
+        // Survived its creator; attached processes see the takeover
+        SharedMemoryManager reader = SharedMemoryManager::attach_segment(test_name, layout);
+        REQUIRE(reader.generation() == 1);
+        
+        std::optional<SharedMemoryManager> resumed = SharedMemoryManager::resume_segment(test_name, layout);
+        REQUIRE(resumed.has_value());
+        REQUIRE(resumed->is_creator());
+        REQUIRE(static_cast<const TestData*>(resumed->payload())->value == 42);
+        REQUIRE(reader.generation() == 2);
+        REQUIRE(reader.header()->creator_pid == getpid());
+        REQUIRE_FALSE(reader.unlinked());
+        
+        // Not persistent this time: unlinked when the resumer goes away
+        resumed.reset();
+        REQUIRE(reader.unlinked());
+        REQUIRE_FALSE(SharedMemoryManager::resume_segment(test_name, layout).has_value());
+    }
+    
+    SECTION("Segment with another layout is not resumed") {
+        SharedMemoryManager creator = SharedMemoryManager::create_segment(test_name, layout);
+        creator.mark_ready();
+        REQUIRE_FALSE(SharedMemoryManager::resume_segment(
+            test_name, ShmLayout{sizeof(TestData), 32, 32 * sizeof(TestData)}).has_value());
+    }
+    
+    SECTION("Segment of a running creator is not taken over") {
+        SharedMemoryManager creator = SharedMemoryManager::create_segment(test_name, layout);
+        creator.mark_ready();
+        creator.header()->creator_pid = static_cast<int32_t>(getppid());
+        REQUIRE_THROWS_AS(SharedMemoryManager::resume_segment(test_name, layout), std::runtime_error);
+    }
+    
+    SECTION("Creating afresh replaces the segment instead of rebuilding it in place") {
+        SharedMemoryManager old_creator = SharedMemoryManager::create_segment(test_name, layout, persistent);
+        static_cast<TestData*>(old_creator.payload())->value = 7;
+        old_creator.mark_ready();
+        SharedMemoryManager reader = SharedMemoryManager::attach_segment(test_name, layout);
+        
+        SharedMemoryManager new_creator = SharedMemoryManager::create_segment(test_name, layout);
+        static_cast<TestData*>(new_creator.payload())->value = 8;
+        REQUIRE(reader.unlinked());
+        REQUIRE(static_cast<const TestData*>(reader.payload())->value == 7);
+        REQUIRE_FALSE(new_creator.unlinked());
+    }
+    
+    SharedMemoryManager::remove(test_name);
+}
+
 TEST_CASE("SharedMemoryManager RAII resource management", "[shared_memory][unit]") {
     const std::string test_name = generate_unique_name("test_shm_raii");
     const size_t test_size = 1024;
@@ -178,6 +441,15 @@ TEST_CASE("SharedMemoryManager error conditions", "[shared_memory][unit]") {
         REQUIRE_THROWS_AS(SharedMemoryManager(nonexistent_name, test_size, false), std::runtime_error);
     }
     
+    SECTION("Attach larger than the existing segment") {
+        // Mapping past the end of the segment would SIGBUS on first touch,
+        // so the attach itself must fail
+        const std::string small_name = generate_unique_name("test_small");
+        SharedMemoryManager creator(small_name, test_size, true);
+        REQUIRE(creator.is_valid());
+        REQUIRE_THROWS_AS(SharedMemoryManager(small_name, test_size * 2, false), std::runtime_error);
+    }
+    
     SECTION("Invalid shared memory name") {
         // Test with empty name
         REQUIRE_THROWS_AS(SharedMemoryManager("", test_size, true), std::runtime_error);